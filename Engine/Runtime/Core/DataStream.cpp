@@ -33,3 +33,109 @@ bool DataStream::ReadLine(std::string& outLine)
     outLine.reserve();
     return ch == '\n' || outLine.length() != 0;
 }
+
+MemoryDataStream::MemoryDataStream(const void* const data,
+                                   const size_t      size) :
+    mData   (reinterpret_cast<const uint8_t*>(data)),
+    mSize   (size),
+    mOffset (0)
+{
+}
+
+MemoryDataStream::MemoryDataStream(ByteArray data) :
+    mData       (data.Get()),
+    mSize       (data.GetSize()),
+    mOffset     (0),
+    mOwnedData  (std::move(data))
+{
+}
+
+MemoryDataStream::~MemoryDataStream()
+{
+}
+
+uint64_t MemoryDataStream::GetSize() const
+{
+    return mSize;
+}
+
+const uint8_t* MemoryDataStream::GetMemory() const
+{
+    return mData;
+}
+
+bool MemoryDataStream::Read(void* const  outBuffer,
+                            const size_t size)
+{
+    if (!Read(outBuffer, size, mOffset))
+    {
+        return false;
+    }
+
+    mOffset += size;
+    return true;
+}
+
+bool MemoryDataStream::Write(const void* const buffer,
+                             const size_t      size)
+{
+    return false;
+}
+
+bool MemoryDataStream::Seek(const SeekMode mode,
+                            const int64_t  offset)
+{
+    int64_t newOffset;
+
+    switch (mode)
+    {
+        case kSeekMode_Set:
+            newOffset = offset;
+            break;
+
+        case kSeekMode_Current:
+            newOffset = static_cast<int64_t>(mOffset) + offset;
+            break;
+
+        case kSeekMode_End:
+            newOffset = static_cast<int64_t>(mSize) + offset;
+            break;
+
+        default:
+            return false;
+
+    }
+
+    if (newOffset < 0)
+    {
+        return false;
+    }
+
+    mOffset = newOffset;
+    return true;
+}
+
+uint64_t MemoryDataStream::GetOffset() const
+{
+    return mOffset;
+}
+
+bool MemoryDataStream::Read(void* const    outBuffer,
+                            const size_t   size,
+                            const uint64_t offset)
+{
+    if (offset > mSize || size > mSize - offset)
+    {
+        return false;
+    }
+
+    memcpy(outBuffer, mData + offset, size);
+    return true;
+}
+
+bool MemoryDataStream::Write(const void* const buffer,
+                             const size_t      size,
+                             const uint64_t    offset)
+{
+    return false;
+}
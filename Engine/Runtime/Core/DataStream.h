@@ -16,7 +16,9 @@
 
 #pragma once
 
+#include "Core/ByteArray.h"
 #include "Core/String.h"
+#include "Core/Utility.h"
 
 enum SeekMode
 {
@@ -36,6 +38,13 @@ public:
 
     virtual uint64_t            GetSize() const = 0;
 
+    /**
+     * Get a pointer to the whole content of the stream if it is directly
+     * available in memory (e.g. a mapped file), otherwise returns null. This
+     * allows the content to be used without copying it.
+     */
+    virtual const uint8_t*      GetMemory() const   { return nullptr; }
+
     /**
      * Stored offset I/O.
      */
@@ -70,3 +79,48 @@ protected:
     DataStream&                 operator =(const DataStream&) { return *this; }
 
 };
+
+/**
+ * Read-only stream over data in memory. This can either refer to existing
+ * memory, or own a ByteArray, e.g. to read a file in its entirety ahead of
+ * time on another thread and then pass it to code that expects a DataStream.
+ */
+class MemoryDataStream : public DataStream, Uncopyable
+{
+public:
+    /**
+     * Create a stream referring to existing memory, which must remain valid
+     * for the lifetime of the stream.
+     */
+                                MemoryDataStream(const void* const data,
+                                                 const size_t      size);
+
+    /** Create a stream which takes ownership of the given data. */
+    explicit                    MemoryDataStream(ByteArray data);
+
+                                ~MemoryDataStream();
+
+    uint64_t                    GetSize() const override;
+    const uint8_t*              GetMemory() const override;
+    bool                        Read(void* const outBuffer, const size_t size) override;
+    bool                        Write(const void* const buffer, const size_t size) override;
+    bool                        Seek(const SeekMode mode, const int64_t offset) override;
+    uint64_t                    GetOffset() const override;
+
+    bool                        Read(void* const    outBuffer,
+                                     const size_t   size,
+                                     const uint64_t offset) override;
+
+    bool                        Write(const void* const buffer,
+                                      const size_t      size,
+                                      const uint64_t    offset) override;
+
+private:
+    const uint8_t*              mData;
+    size_t                      mSize;
+    uint64_t                    mOffset;
+
+    /** Data owned by the stream, if any. */
+    ByteArray                   mOwnedData;
+
+};
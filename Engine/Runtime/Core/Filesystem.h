@@ -61,6 +61,30 @@ protected:
 
 };
 
+/**
+ * Read-only view of a whole file mapped into memory, created by
+ * Filesystem::MapFile(). The content is available directly through
+ * GetMemory(), as well as through the DataStream interface. Pages are read
+ * in on demand by the OS, and no copy of the data is made. GetMemory() is
+ * never null, even for an empty file.
+ */
+class MappedFile : public MemoryDataStream
+{
+protected:
+    /**
+     * Empty files cannot be mapped, so implementations pass a null mapping
+     * for them. This substitutes a valid pointer in that case.
+     */
+                                MappedFile(const void* const data,
+                                           const size_t      size) :
+                                    MemoryDataStream ((data) ? data : kEmptyData, size)
+                                {}
+
+private:
+    static constexpr uint8_t    kEmptyData[1] = {};
+
+};
+
 /** A handle to a directory allowing the directory contents to be iterated. */
 class Directory : Uncopyable
 {
@@ -102,6 +126,12 @@ namespace Filesystem
     extern File*                OpenFile(const Path&    path,
                                          const FileMode mode = kFileMode_Read);
 
+    /**
+     * Map a file into memory for reading. Returns null if the file could not
+     * be opened or mapped.
+     */
+    extern MappedFile*          MapFile(const Path& path);
+
     extern Directory*           OpenDirectory(const Path& path);
 
     extern bool                 Exists(const Path& path);
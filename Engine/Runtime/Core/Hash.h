@@ -31,12 +31,29 @@ inline size_t HashData(const void*    data,
     return Gemini_XXH64(data, size, seed);
 }
 
+/**
+ * Mix the bits of an integer value so that every input bit affects every
+ * output bit. This is the finaliser from MurmurHash3. Integers (and pointers)
+ * often vary only in a few low or high bits, and open addressing hash tables
+ * (see HashTable.h) are sensitive to this since they derive both the slot
+ * index and the stored hash bits from different parts of the hash value.
+ */
+inline size_t HashMix(uint64_t value)
+{
+    value ^= value >> 33;
+    value *= 0xff51afd7ed558ccdull;
+    value ^= value >> 33;
+    value *= 0xc4ceb9fe1a85ec53ull;
+    value ^= value >> 33;
+
+    return static_cast<size_t>(value);
+}
+
 template <typename T>
 inline typename std::enable_if<std::is_integral<T>::value, size_t>::type
 HashValue(const T value)
 {
-    /* This is probably reasonable for many cases. */
-    return static_cast<size_t>(value);
+    return HashMix(static_cast<uint64_t>(value));
 }
 
 template <typename T>
@@ -63,7 +80,7 @@ HashValue(const T value)
 template <typename T>
 inline size_t HashValue(T* const value)
 {
-    return reinterpret_cast<size_t>(value);
+    return HashMix(reinterpret_cast<uintptr_t>(value));
 }
 
 inline size_t HashValue(const std::string& value)
@@ -17,23 +17,696 @@
 #pragma once
 
 #include "Core/Hash.h"
+#include "Core/Utility.h"
 
+#include <algorithm>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <tuple>
 #include <unordered_map>
 #include <unordered_set>
+#include <utility>
 
 /**
- * Helper aliases for STL hash table classes, using our Hash class as the
- * hasher, which will work with any type for which HashValue() is implemented.
+ * Open addressing hash table, which is the implementation of HashMap and
+ * HashSet (see below). This should not be used directly.
+ *
+ * Elements are stored inline in a flat array rather than in individually
+ * allocated nodes, alongside a separate array of 1 byte control values per
+ * slot. A control value either marks the slot as empty or deleted, or holds
+ * 7 bits of the element's hash. Lookups use linear probing, and only compare
+ * keys when the control value matches, so most of the probing touches just
+ * the (small, densely packed) control array. This is similar in spirit to
+ * Abseil's "Swiss tables", but without SIMD group probing.
+ *
+ * Erasing leaves a deleted marker in the slot (unless it can be determined to
+ * not be part of a probe sequence), and does not move any other elements, so
+ * erasing while iterating (via the iterator returned by erase()) is safe.
+ * Deleted markers are cleaned up when the table is rehashed.
+ *
+ * Unlike the STL node-based containers, references/pointers to elements and
+ * iterators are invalidated by any insertion that causes the table to grow.
+ * Do not hold on to them across insertions.
+ *
+ * KeyOf is a policy type providing a static Get() function which returns the
+ * key of an element.
  */
+template <typename Key, typename Element, typename KeyOf, bool IsSet, typename Allocator>
+class HashTable
+{
+public:
+    using key_type              = Key;
+    using value_type            = Element;
+    using size_type             = size_t;
+    using difference_type       = ptrdiff_t;
+    using hasher                = Hash<Key>;
+    using key_equal             = std::equal_to<Key>;
+    using allocator_type        = Allocator;
+    using reference             = Element&;
+    using const_reference       = const Element&;
 
-template <typename Key, typename Value>
-using HashMap = std::unordered_map<Key, Value, Hash<Key>>;
+    template <typename U, typename T>
+    class BaseIterator
+    {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type        = Element;
+        using difference_type   = ptrdiff_t;
+        using pointer           = U*;
+        using reference         = U&;
+
+    public:
+                                BaseIterator() : mTable (nullptr), mIndex (0) {}
+                                BaseIterator(T* const table, const size_t index) : mTable (table), mIndex (index) {}
+
+        /** Allow conversion from iterator to const_iterator. */
+        template <typename U2, typename T2>
+                                BaseIterator(const BaseIterator<U2, T2>& other) : mTable (other.mTable), mIndex (other.mIndex) {}
+
+        template <typename U2, typename T2>
+        bool                    operator==(const BaseIterator<U2, T2>& other) const
+                                    { return mIndex == other.mIndex; }
+        template <typename U2, typename T2>
+        bool                    operator!=(const BaseIterator<U2, T2>& other) const
+                                    { return mIndex != other.mIndex; }
+
+        U&                      operator*() const   { return mTable->mSlots[mIndex]; }
+        U*                      operator->() const  { return &mTable->mSlots[mIndex]; }
+
+        BaseIterator&           operator++()
+                                    { mIndex = mTable->NextFull(mIndex + 1); return *this; }
+        BaseIterator            operator++(int)
+                                    { BaseIterator ret = *this; ++(*this); return ret; }
+
+    private:
+        T*                      mTable;
+        size_t                  mIndex;
+
+        template <typename, typename>
+        friend class BaseIterator;
+
+        friend class HashTable;
+    };
+
+    using const_iterator        = BaseIterator<const Element, const HashTable>;
+    using iterator              = typename std::conditional<IsSet,
+                                                            const_iterator,
+                                                            BaseIterator<Element, HashTable>>::type;
+
+public:
+                                HashTable();
+                                HashTable(const Allocator& allocator);
+                                HashTable(const HashTable& other);
+                                HashTable(HashTable&& other);
+                                ~HashTable();
+
+    HashTable&                  operator=(const HashTable& other);
+    HashTable&                  operator=(HashTable&& other);
+
+    iterator                    begin()             { return iterator(this, NextFull(0)); }
+    const_iterator              begin() const       { return const_iterator(this, NextFull(0)); }
+    const_iterator              cbegin() const      { return begin(); }
+    iterator                    end()               { return iterator(this, mCapacity); }
+    const_iterator              end() const         { return const_iterator(this, mCapacity); }
+    const_iterator              cend() const        { return end(); }
+
+    bool                        empty() const       { return mSize == 0; }
+    size_t                      size() const        { return mSize; }
+
+    /** Current number of slots in the table. */
+    size_t                      capacity() const    { return mCapacity; }
+
+    /** Destroy all elements. Does not free the table storage. */
+    void                        clear();
+
+    /** Ensure that there is space for at least count elements without growing. */
+    void                        reserve(const size_t count);
+
+    iterator                    find(const Key& key);
+    const_iterator              find(const Key& key) const;
+    size_t                      count(const Key& key) const { return (FindIndex(key) != mCapacity) ? 1 : 0; }
+    bool                        contains(const Key& key) const  { return FindIndex(key) != mCapacity; }
+
+    /**
+     * Insert an element if an element with the same key does not already
+     * exist. Returns an iterator to the new or existing element, and whether
+     * insertion took place.
+     */
+    std::pair<iterator, bool>   insert(const Element& element);
+    std::pair<iterator, bool>   insert(Element&& element);
+
+    /**
+     * Construct an element from the given arguments and insert it if an
+     * element with the same key does not already exist. The element is always
+     * constructed, use try_emplace() on a HashMap to avoid that.
+     */
+    template <typename... Args>
+    std::pair<iterator, bool>   emplace(Args&&... args);
+
+    /**
+     * Erase an element. Returns an iterator to the next element. Does not
+     * invalidate other iterators.
+     */
+    iterator                    erase(const_iterator it);
+    size_t                      erase(const Key& key);
+
+    void                        swap(HashTable& other);
+
+protected:
+    using ControlAllocator      = typename std::allocator_traits<Allocator>::template rebind_alloc<uint8_t>;
+    using ElementAllocator      = typename std::allocator_traits<Allocator>::template rebind_alloc<Element>;
+
+    /**
+     * Control values. Full slots have the low 7 bits of the hash, so the top
+     * bit distinguishes full slots from empty/deleted ones.
+     */
+    static constexpr uint8_t    kControlEmpty   = 0x80;
+    static constexpr uint8_t    kControlDeleted = 0xfe;
+
+    /** Minimum (non-zero) capacity, must be a power of 2. */
+    static constexpr size_t     kMinCapacity    = 8;
+
+protected:
+    static size_t               HashKey(const Key& key)             { return hasher()(key); }
+    static uint8_t              ControlHash(const size_t hash)      { return hash & 0x7f; }
+    static bool                 IsFull(const uint8_t control)       { return (control & 0x80) == 0; }
+
+    /** Maximum number of full plus deleted slots, for a load factor of 7/8. */
+    static size_t               MaxLoad(const size_t capacity)      { return capacity - (capacity / 8); }
+
+    size_t                      ProbeStart(const size_t hash) const { return (hash >> 7) & (mCapacity - 1); }
+    size_t                      ProbeNext(const size_t index) const { return (index + 1) & (mCapacity - 1); }
+
+    size_t                      NextFull(size_t index) const;
+    size_t                      FindIndex(const Key& key) const;
+    size_t                      FindIndex(const Key& key,
+                                          const size_t hash) const;
+
+    /**
+     * Find a slot to insert a new element with the given hash into, growing
+     * the table if necessary. The caller must have checked that the key is not
+     * already present, and must construct the element in the returned slot.
+     */
+    size_t                      PrepareInsert(const size_t hash);
+
+    void                        Rehash(const size_t capacity);
+    void                        Allocate(const size_t capacity);
+    void                        Free();
+    void                        Destroy();
+
+    template <typename Value>
+    std::pair<iterator, bool>   InsertUnique(Value&& element);
+
+protected:
+    uint8_t*                    mControl;
+    Element*                    mSlots;
+    size_t                      mCapacity;
+    size_t                      mSize;
+    size_t                      mDeleted;
+    Allocator                   mAllocator;
+
+};
+
+#define HASHTABLE_TEMPLATE \
+    template <typename Key, typename Element, typename KeyOf, bool IsSet, typename Allocator>
+
+#define HASHTABLE_TYPE \
+    HashTable<Key, Element, KeyOf, IsSet, Allocator>
+
+HASHTABLE_TEMPLATE
+inline HASHTABLE_TYPE::HashTable() :
+    HashTable   (Allocator())
+{
+}
+
+HASHTABLE_TEMPLATE
+inline HASHTABLE_TYPE::HashTable(const Allocator& allocator) :
+    mControl    (nullptr),
+    mSlots      (nullptr),
+    mCapacity   (0),
+    mSize       (0),
+    mDeleted    (0),
+    mAllocator  (allocator)
+{
+}
+
+HASHTABLE_TEMPLATE
+inline HASHTABLE_TYPE::HashTable(const HashTable& other) :
+    HashTable   (other.mAllocator)
+{
+    *this = other;
+}
+
+HASHTABLE_TEMPLATE
+inline HASHTABLE_TYPE::HashTable(HashTable&& other) :
+    HashTable   (other.mAllocator)
+{
+    swap(other);
+}
+
+HASHTABLE_TEMPLATE
+inline HASHTABLE_TYPE::~HashTable()
+{
+    Destroy();
+    Free();
+}
+
+HASHTABLE_TEMPLATE
+inline HASHTABLE_TYPE& HASHTABLE_TYPE::operator=(const HashTable& other)
+{
+    if (this != &other)
+    {
+        clear();
+        reserve(other.mSize);
+
+        for (const Element& element : other)
+        {
+            const size_t index = PrepareInsert(HashKey(KeyOf::Get(element)));
+            new (&mSlots[index]) Element(element);
+            mSize++;
+        }
+    }
+
+    return *this;
+}
+
+HASHTABLE_TEMPLATE
+inline HASHTABLE_TYPE& HASHTABLE_TYPE::operator=(HashTable&& other)
+{
+    if (this != &other)
+    {
+        HashTable temp(std::move(other));
+        swap(temp);
+    }
+
+    return *this;
+}
+
+HASHTABLE_TEMPLATE
+inline void HASHTABLE_TYPE::swap(HashTable& other)
+{
+    std::swap(mControl,   other.mControl);
+    std::swap(mSlots,     other.mSlots);
+    std::swap(mCapacity,  other.mCapacity);
+    std::swap(mSize,      other.mSize);
+    std::swap(mDeleted,   other.mDeleted);
+    std::swap(mAllocator, other.mAllocator);
+}
+
+HASHTABLE_TEMPLATE
+inline void HASHTABLE_TYPE::Allocate(const size_t capacity)
+{
+    ControlAllocator controlAllocator(mAllocator);
+    ElementAllocator elementAllocator(mAllocator);
+
+    mControl  = std::allocator_traits<ControlAllocator>::allocate(controlAllocator, capacity);
+    mSlots    = std::allocator_traits<ElementAllocator>::allocate(elementAllocator, capacity);
+    mCapacity = capacity;
+    mDeleted  = 0;
+
+    memset(mControl, kControlEmpty, capacity);
+}
+
+HASHTABLE_TEMPLATE
+inline void HASHTABLE_TYPE::Free()
+{
+    if (mCapacity > 0)
+    {
+        ControlAllocator controlAllocator(mAllocator);
+        ElementAllocator elementAllocator(mAllocator);
+
+        std::allocator_traits<ControlAllocator>::deallocate(controlAllocator, mControl, mCapacity);
+        std::allocator_traits<ElementAllocator>::deallocate(elementAllocator, mSlots, mCapacity);
+
+        mControl  = nullptr;
+        mSlots    = nullptr;
+        mCapacity = 0;
+        mDeleted  = 0;
+    }
+}
+
+HASHTABLE_TEMPLATE
+inline void HASHTABLE_TYPE::Destroy()
+{
+    if (!std::is_trivially_destructible<Element>::value)
+    {
+        for (size_t i = 0; i < mCapacity; i++)
+        {
+            if (IsFull(mControl[i]))
+            {
+                mSlots[i].~Element();
+            }
+        }
+    }
+
+    mSize = 0;
+}
+
+HASHTABLE_TEMPLATE
+inline void HASHTABLE_TYPE::clear()
+{
+    Destroy();
+
+    if (mCapacity > 0)
+    {
+        memset(mControl, kControlEmpty, mCapacity);
+        mDeleted = 0;
+    }
+}
+
+HASHTABLE_TEMPLATE
+inline void HASHTABLE_TYPE::reserve(const size_t count)
+{
+    size_t capacity = std::max(mCapacity, kMinCapacity);
+
+    while (MaxLoad(capacity) < count)
+    {
+        capacity *= 2;
+    }
+
+    if (capacity != mCapacity)
+    {
+        Rehash(capacity);
+    }
+}
+
+HASHTABLE_TEMPLATE
+inline void HASHTABLE_TYPE::Rehash(const size_t capacity)
+{
+    Assert(IsPowerOf2(capacity));
+    Assert(MaxLoad(capacity) > mSize);
+
+    uint8_t* const oldControl  = mControl;
+    Element* const oldSlots    = mSlots;
+    const size_t   oldCapacity = mCapacity;
+
+    Allocate(capacity);
+
+    for (size_t i = 0; i < oldCapacity; i++)
+    {
+        if (IsFull(oldControl[i]))
+        {
+            const size_t hash = HashKey(KeyOf::Get(oldSlots[i]));
+
+            /* We know there are no deleted entries or duplicates, so we just
+             * need to find the first empty slot. */
+            size_t index = ProbeStart(hash);
+            while (mControl[index] != kControlEmpty)
+            {
+                index = ProbeNext(index);
+            }
+
+            mControl[index] = ControlHash(hash);
+            new (&mSlots[index]) Element(std::move(oldSlots[i]));
+            oldSlots[i].~Element();
+        }
+    }
+
+    if (oldCapacity > 0)
+    {
+        ControlAllocator controlAllocator(mAllocator);
+        ElementAllocator elementAllocator(mAllocator);
+
+        std::allocator_traits<ControlAllocator>::deallocate(controlAllocator, oldControl, oldCapacity);
+        std::allocator_traits<ElementAllocator>::deallocate(elementAllocator, oldSlots, oldCapacity);
+    }
+}
+
+HASHTABLE_TEMPLATE
+inline size_t HASHTABLE_TYPE::NextFull(size_t index) const
+{
+    while (index < mCapacity && !IsFull(mControl[index]))
+    {
+        index++;
+    }
+
+    return index;
+}
+
+HASHTABLE_TEMPLATE
+inline size_t HASHTABLE_TYPE::FindIndex(const Key& key) const
+{
+    return (mSize > 0) ? FindIndex(key, HashKey(key)) : mCapacity;
+}
+
+HASHTABLE_TEMPLATE
+inline size_t HASHTABLE_TYPE::FindIndex(const Key&   key,
+                                        const size_t hash) const
+{
+    if (mCapacity == 0)
+    {
+        return mCapacity;
+    }
+
+    const uint8_t control = ControlHash(hash);
+
+    /* The load factor guarantees that there is always at least one empty slot
+     * so this will terminate. */
+    for (size_t index = ProbeStart(hash); ; index = ProbeNext(index))
+    {
+        if (mControl[index] == control && key_equal()(KeyOf::Get(mSlots[index]), key))
+        {
+            return index;
+        }
+        else if (mControl[index] == kControlEmpty)
+        {
+            return mCapacity;
+        }
+    }
+}
+
+HASHTABLE_TEMPLATE
+inline size_t HASHTABLE_TYPE::PrepareInsert(const size_t hash)
+{
+    if (mSize + mDeleted + 1 > MaxLoad(mCapacity))
+    {
+        /* If a significant proportion of the load is deleted entries, just
+         * rehash at the same size to clean them up, otherwise grow. */
+        const size_t capacity = std::max(kMinCapacity,
+                                         (mDeleted > mSize) ? mCapacity : mCapacity * 2);
+
+        Rehash(capacity);
+    }
+
+    size_t index = ProbeStart(hash);
+    while (IsFull(mControl[index]))
+    {
+        index = ProbeNext(index);
+    }
+
+    if (mControl[index] == kControlDeleted)
+    {
+        mDeleted--;
+    }
+
+    mControl[index] = ControlHash(hash);
+    return index;
+}
+
+HASHTABLE_TEMPLATE
+template <typename Value>
+inline std::pair<typename HASHTABLE_TYPE::iterator, bool> HASHTABLE_TYPE::InsertUnique(Value&& element)
+{
+    const Key& key    = KeyOf::Get(element);
+    const size_t hash = HashKey(key);
+
+    size_t index = FindIndex(key, hash);
+    if (index != mCapacity)
+    {
+        return std::make_pair(iterator(this, index), false);
+    }
+
+    index = PrepareInsert(hash);
+    new (&mSlots[index]) Element(std::forward<Value>(element));
+    mSize++;
+
+    return std::make_pair(iterator(this, index), true);
+}
+
+HASHTABLE_TEMPLATE
+inline typename HASHTABLE_TYPE::iterator HASHTABLE_TYPE::find(const Key& key)
+{
+    return iterator(this, FindIndex(key));
+}
+
+HASHTABLE_TEMPLATE
+inline typename HASHTABLE_TYPE::const_iterator HASHTABLE_TYPE::find(const Key& key) const
+{
+    return const_iterator(this, FindIndex(key));
+}
+
+HASHTABLE_TEMPLATE
+inline std::pair<typename HASHTABLE_TYPE::iterator, bool> HASHTABLE_TYPE::insert(const Element& element)
+{
+    return InsertUnique(element);
+}
+
+HASHTABLE_TEMPLATE
+inline std::pair<typename HASHTABLE_TYPE::iterator, bool> HASHTABLE_TYPE::insert(Element&& element)
+{
+    return InsertUnique(std::move(element));
+}
+
+HASHTABLE_TEMPLATE
+template <typename... Args>
+inline std::pair<typename HASHTABLE_TYPE::iterator, bool> HASHTABLE_TYPE::emplace(Args&&... args)
+{
+    return InsertUnique(Element(std::forward<Args>(args)...));
+}
+
+HASHTABLE_TEMPLATE
+inline typename HASHTABLE_TYPE::iterator HASHTABLE_TYPE::erase(const_iterator it)
+{
+    const size_t index = it.mIndex;
+
+    Assert(index < mCapacity && IsFull(mControl[index]));
+
+    mSlots[index].~Element();
+    mSize--;
+
+    /* If the next slot is empty, then no probe sequence can continue past this
+     * slot, so it can be marked empty rather than deleted. */
+    if (mControl[ProbeNext(index)] == kControlEmpty)
+    {
+        mControl[index] = kControlEmpty;
+    }
+    else
+    {
+        mControl[index] = kControlDeleted;
+        mDeleted++;
+    }
+
+    return iterator(this, NextFull(index + 1));
+}
+
+HASHTABLE_TEMPLATE
+inline size_t HASHTABLE_TYPE::erase(const Key& key)
+{
+    const size_t index = FindIndex(key);
+    if (index == mCapacity)
+    {
+        return 0;
+    }
+
+    erase(const_iterator(this, index));
+    return 1;
+}
+
+#undef HASHTABLE_TEMPLATE
+#undef HASHTABLE_TYPE
+
+struct HashMapKeyOf
+{
+    template <typename Key, typename Value>
+    static const Key&           Get(const std::pair<const Key, Value>& element) { return element.first; }
+};
+
+struct HashSetKeyOf
+{
+    template <typename Key>
+    static const Key&           Get(const Key& element) { return element; }
+};
+
+/**
+ * Hash map class, using our Hash class as the hasher, which will work with any
+ * type for which HashValue() is implemented. This has the same interface as
+ * std::unordered_map (minus the bucket interface), but is implemented with an
+ * open addressing hash table. See HashTable for details, particularly that
+ * references to elements are not stable across insertions.
+ */
+template <typename Key, typename Value, typename Allocator = std::allocator<std::pair<const Key, Value>>>
+class HashMap : public HashTable<Key, std::pair<const Key, Value>, HashMapKeyOf, false, Allocator>
+{
+private:
+    using Base                  = HashTable<Key, std::pair<const Key, Value>, HashMapKeyOf, false, Allocator>;
+
+public:
+    using mapped_type           = Value;
+    using typename Base::iterator;
+    using typename Base::const_iterator;
+
+public:
+    using Base::Base;
+
+    /**
+     * Insert a new element constructed from the given arguments if the key
+     * does not already exist. Unlike emplace(), does nothing if it does.
+     */
+    template <typename... Args>
+    std::pair<iterator, bool>   try_emplace(const Key& key, Args&&... args)
+                                    { return TryEmplace(key, std::forward<Args>(args)...); }
+    template <typename... Args>
+    std::pair<iterator, bool>   try_emplace(Key&& key, Args&&... args)
+                                    { return TryEmplace(std::move(key), std::forward<Args>(args)...); }
+
+    Value&                      operator[](const Key& key)  { return try_emplace(key).first->second; }
+    Value&                      operator[](Key&& key)       { return try_emplace(std::move(key)).first->second; }
+
+    Value&                      at(const Key& key);
+    const Value&                at(const Key& key) const;
+
+private:
+    template <typename K, typename... Args>
+    std::pair<iterator, bool>   TryEmplace(K&& key, Args&&... args);
+
+};
+
+template <typename Key, typename Value, typename Allocator>
+template <typename K, typename... Args>
+inline std::pair<typename HashMap<Key, Value, Allocator>::iterator, bool>
+HashMap<Key, Value, Allocator>::TryEmplace(K&& key, Args&&... args)
+{
+    const size_t hash = Base::HashKey(key);
+
+    size_t index = Base::FindIndex(key, hash);
+    if (index != this->mCapacity)
+    {
+        return std::make_pair(iterator(this, index), false);
+    }
+
+    index = Base::PrepareInsert(hash);
+
+    new (&this->mSlots[index]) std::pair<const Key, Value>(std::piecewise_construct,
+                                                           std::forward_as_tuple(std::forward<K>(key)),
+                                                           std::forward_as_tuple(std::forward<Args>(args)...));
+    this->mSize++;
+
+    return std::make_pair(iterator(this, index), true);
+}
+
+template <typename Key, typename Value, typename Allocator>
+inline Value& HashMap<Key, Value, Allocator>::at(const Key& key)
+{
+    auto it = this->find(key);
+    Assert(it != this->end());
+    return it->second;
+}
+
+template <typename Key, typename Value, typename Allocator>
+inline const Value& HashMap<Key, Value, Allocator>::at(const Key& key) const
+{
+    auto it = this->find(key);
+    Assert(it != this->end());
+    return it->second;
+}
+
+/**
+ * Hash set class, using our Hash class as the hasher. This has the same
+ * interface as std::unordered_set (minus the bucket interface), but is
+ * implemented with an open addressing hash table. See HashTable for details.
+ */
+template <typename Key, typename Allocator = std::allocator<Key>>
+using HashSet = HashTable<Key, Key, HashSetKeyOf, true, Allocator>;
+
+/**
+ * There is no open addressing implementation of the multi-key containers, so
+ * these are aliases for the STL classes using our Hash class as the hasher.
+ */
 
 template <typename Key, typename Value>
 using MultiHashMap = std::unordered_multimap<Key, Value, Hash<Key>>;
 
-template <typename Key>
-using HashSet = std::unordered_set<Key, Hash<Key>>;
-
 template <typename Key>
 using MultiHashSet = std::unordered_multiset<Key, Hash<Key>>;
@@ -0,0 +1,285 @@
+/*
+ * Copyright (C) 2018-2020 Alex Smith
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#include "Core/JobSystem.h"
+
+#include "Core/Thread.h"
+
+SINGLETON_IMPL(JobSystem);
+
+thread_local uint32_t JobSystem::sCurrentThreadIndex = JobSystem::kInvalidThreadIndex;
+
+JobSystem::JobSystem(const uint32_t threadCount) :
+    mThreadCount        (threadCount),
+    mQueuedJobs         (0),
+    mSerial             (false),
+    mSleepingWorkers    (0),
+    mShutdown           (false)
+{
+    Assert(Thread::IsMain());
+
+    if (mThreadCount == 0)
+    {
+        mThreadCount = std::max(std::thread::hardware_concurrency(), 1u);
+    }
+
+    mQueues.reset(new Queue[mThreadCount]);
+
+    sCurrentThreadIndex = 0;
+
+    mWorkers.reserve(mThreadCount - 1);
+    for (uint32_t i = 1; i < mThreadCount; i++)
+    {
+        mWorkers.emplace_back(&JobSystem::WorkerThread, this, i);
+    }
+
+    LogInfo("Job system using %u threads", mThreadCount);
+}
+
+JobSystem::~JobSystem()
+{
+    {
+        std::unique_lock lock(mSleepLock);
+        mShutdown = true;
+    }
+
+    mSleepCondition.notify_all();
+
+    for (std::thread& worker : mWorkers)
+    {
+        worker.join();
+    }
+
+    Assert(mQueuedJobs.load(std::memory_order_relaxed) == 0);
+}
+
+void JobSystem::SetSerial(const bool serial)
+{
+    Assert(Thread::IsMain());
+    Assert(mQueuedJobs.load(std::memory_order_relaxed) == 0);
+
+    mSerial.store(serial, std::memory_order_relaxed);
+}
+
+void JobSystem::WorkerThread(const uint32_t index)
+{
+    sCurrentThreadIndex = index;
+
+    while (true)
+    {
+        Job job;
+        if (Pop(job))
+        {
+            Execute(job);
+            continue;
+        }
+
+        std::unique_lock lock(mSleepLock);
+
+        /* See Push() for how this avoids missed wake ups. */
+        mSleepingWorkers.fetch_add(1);
+
+        mSleepCondition.wait(
+            lock,
+            [this] ()
+            {
+                return mShutdown || mQueuedJobs.load() > 0;
+            });
+
+        mSleepingWorkers.fetch_sub(1);
+
+        if (mShutdown)
+        {
+            break;
+        }
+    }
+}
+
+void JobSystem::Push(Job job)
+{
+    /* Threads other than our own push to the main thread's queue, workers
+     * will steal from there. */
+    const uint32_t index = (sCurrentThreadIndex != kInvalidThreadIndex) ? sCurrentThreadIndex : 0;
+    Queue& queue = mQueues[index];
+
+    /*
+     * The queued count is incremented before the job is visible in the queue,
+     * so that a Pop() taking it can never decrement the count below the real
+     * number of queued jobs.
+     *
+     * Both this and the sleeping worker count are sequentially consistent.
+     * Either we see a non-zero sleeping count below and wake a worker (taking
+     * the lock ensures that it is either waiting or has not yet checked the
+     * queued count), or the worker's increment of the sleeping count comes
+     * after our read, and so it will see our increment of the queued count
+     * before it waits.
+     */
+    {
+        std::unique_lock lock(queue.lock);
+        mQueuedJobs.fetch_add(1);
+        queue.jobs.emplace_back(std::move(job));
+    }
+
+    if (mSleepingWorkers.load() > 0)
+    {
+        std::unique_lock lock(mSleepLock);
+        mSleepCondition.notify_one();
+    }
+}
+
+bool JobSystem::Pop(Job& outJob)
+{
+    if (mQueuedJobs.load(std::memory_order_relaxed) == 0)
+    {
+        return false;
+    }
+
+    const uint32_t ownIndex = (sCurrentThreadIndex != kInvalidThreadIndex) ? sCurrentThreadIndex : 0;
+
+    /* Try our own queue first, taking the most recently pushed job. */
+    {
+        Queue& queue = mQueues[ownIndex];
+        std::unique_lock lock(queue.lock);
+
+        if (!queue.jobs.empty())
+        {
+            outJob = std::move(queue.jobs.back());
+            queue.jobs.pop_back();
+
+            mQueuedJobs.fetch_sub(1);
+            return true;
+        }
+    }
+
+    /* Steal the oldest job from another thread's queue. */
+    for (uint32_t i = 1; i < mThreadCount; i++)
+    {
+        Queue& queue = mQueues[(ownIndex + i) % mThreadCount];
+        std::unique_lock lock(queue.lock);
+
+        if (!queue.jobs.empty())
+        {
+            outJob = std::move(queue.jobs.front());
+            queue.jobs.pop_front();
+
+            mQueuedJobs.fetch_sub(1);
+            return true;
+        }
+    }
+
+    return false;
+}
+
+void JobSystem::Execute(Job& job)
+{
+    job.function();
+
+    /* Release anything captured by the function before signalling completion,
+     * the waiter may destroy state that the captures refer to. */
+    job.function = nullptr;
+
+    if (job.counter)
+    {
+        job.counter->Decrement();
+    }
+}
+
+void JobSystem::Run(JobFunction       function,
+                    JobCounter* const counter,
+                    JobCounter* const dependency)
+{
+    Assert(function);
+
+    if (IsSerial())
+    {
+        /* Everything previously submitted has already completed, so the
+         * dependency can only be incomplete if it is misused. */
+        Assert(!dependency || dependency->IsComplete());
+
+        function();
+        return;
+    }
+
+    if (counter)
+    {
+        counter->Increment();
+    }
+
+    Job job;
+    job.function = std::move(function);
+    job.counter  = counter;
+
+    if (dependency)
+    {
+        std::unique_lock lock(dependency->mLock);
+
+        if (!dependency->IsComplete())
+        {
+            /* Will be pushed when the dependency completes. */
+            dependency->mWaitingJobs.emplace_back(std::move(job));
+            return;
+        }
+    }
+
+    Push(std::move(job));
+}
+
+void JobSystem::Wait(const JobCounter& counter)
+{
+    while (!counter.IsComplete())
+    {
+        Job job;
+        if (Pop(job))
+        {
+            Execute(job);
+        }
+        else
+        {
+            std::this_thread::yield();
+        }
+    }
+
+    /*
+     * The counter is decremented with its lock held, which is then used to
+     * push any waiting jobs. Synchronise with that by taking the lock here, so
+     * that once we return, the completing thread is guaranteed to no longer
+     * be touching the counter and the caller is free to destroy it.
+     */
+    std::unique_lock lock(counter.mLock);
+}
+
+void JobCounter::Decrement()
+{
+    std::vector<JobSystem::Job> waitingJobs;
+
+    {
+        std::unique_lock lock(mLock);
+
+        const uint32_t previous = mValue.fetch_sub(1, std::memory_order_acq_rel);
+        Assert(previous > 0);
+
+        if (previous == 1)
+        {
+            waitingJobs.swap(mWaitingJobs);
+        }
+    }
+
+    /* Must not touch the counter from here on, it may have been destroyed. */
+    for (JobSystem::Job& job : waitingJobs)
+    {
+        JobSystem::Get().Push(std::move(job));
+    }
+}
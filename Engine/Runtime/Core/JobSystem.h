@@ -0,0 +1,224 @@
+/*
+ * Copyright (C) 2018-2020 Alex Smith
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#pragma once
+
+#include "Core/Singleton.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <limits>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class JobCounter;
+
+using JobFunction = std::function<void ()>;
+
+/**
+ * Job scheduler for spreading work across all CPU cores. A fixed pool of
+ * worker threads is created at startup, sized to the hardware concurrency
+ * (minus 1 for the main thread, which also takes part in job execution).
+ *
+ * Each thread that takes part in job execution (the main thread plus the
+ * workers) has its own job queue. Jobs submitted by a thread are pushed to
+ * its own queue, and it takes jobs from the back of that queue (LIFO, for
+ * cache locality). When a thread runs out of work in its own queue, it will
+ * steal jobs from the front of other threads' queues.
+ *
+ * Completion of jobs is tracked with JobCounter. A counter is incremented for
+ * each job submitted against it, and decremented when each job completes. A
+ * job can also be given a counter to depend on, in which case it will not be
+ * started until that counter reaches zero. This allows chains of dependent
+ * work to be expressed without blocking any threads.
+ *
+ * Waiting for a counter with Wait() does not block the calling thread: it will
+ * execute other queued jobs until the counter reaches zero. This means that it
+ * is safe to wait from within a job.
+ *
+ * Jobs must not outlive the frame they were submitted in if they refer to
+ * per-frame state (e.g. FrameAllocator allocations). The engine does not
+ * enforce this - callers must wait for the jobs that they submit.
+ *
+ * For debugging, the job system can be switched into serial mode. In this mode
+ * jobs are executed immediately on the submitting thread, in submission order,
+ * which makes execution deterministic and single-threaded. See also
+ * Core/Parallel.h and Core/TaskGraph.h for higher level helpers built on top
+ * of this.
+ */
+class JobSystem : public Singleton<JobSystem>
+{
+public:
+    /** Value returned by GetCurrentThreadIndex() for non-job threads. */
+    static constexpr uint32_t   kInvalidThreadIndex = std::numeric_limits<uint32_t>::max();
+
+public:
+    /**
+     * Create the job system. Must be called from the main thread. If the
+     * thread count is 0, it will be derived from the hardware concurrency.
+     * Thread count includes the main thread, so a count of 1 will create no
+     * workers and all jobs will execute on the main thread when it waits.
+     */
+                                JobSystem(const uint32_t threadCount = 0);
+                                ~JobSystem();
+
+    /**
+     * Get the number of threads executing jobs (including the main thread).
+     * Per-thread state used from jobs can be sized based on this and indexed
+     * with GetCurrentThreadIndex().
+     */
+    uint32_t                    GetThreadCount() const  { return mThreadCount; }
+
+    /**
+     * Get the index of the calling thread, in the range [0, GetThreadCount()).
+     * The main thread is always index 0. Returns kInvalidThreadIndex if the
+     * calling thread is not one of the job system's threads.
+     */
+    static uint32_t             GetCurrentThreadIndex() { return sCurrentThreadIndex; }
+
+    /**
+     * Whether serial mode is enabled. This must only be changed from the main
+     * thread while there are no jobs outstanding (e.g. between frames).
+     */
+    bool                        IsSerial() const
+                                    { return mSerial.load(std::memory_order_relaxed); }
+    void                        SetSerial(const bool serial);
+
+    /**
+     * Submit a job for execution. If counter is non-null, it will be
+     * incremented, and decremented again once the job has completed. If
+     * dependency is non-null, the job will not be started until the
+     * dependency counter reaches zero (the dependency counter must outlive
+     * the point where this happens).
+     *
+     * This can be called from any thread, including from within a job.
+     */
+    void                        Run(JobFunction       function,
+                                    JobCounter* const counter    = nullptr,
+                                    JobCounter* const dependency = nullptr);
+
+    /**
+     * Wait for a counter to reach zero. The calling thread will execute other
+     * jobs while waiting rather than blocking.
+     */
+    void                        Wait(const JobCounter& counter);
+
+private:
+    struct Job
+    {
+        JobFunction             function;
+        JobCounter*             counter;
+    };
+
+    /**
+     * Per-thread job queue. The owning thread pushes and pops at the back,
+     * other threads steal from the front. Queues are protected by a lock: jobs
+     * are expected to be coarse enough that contention on this is negligible
+     * compared to the work done.
+     */
+    struct Queue
+    {
+        std::mutex              lock;
+        std::deque<Job>         jobs;
+    };
+
+private:
+    void                        WorkerThread(const uint32_t index);
+
+    void                        Push(Job job);
+    bool                        Pop(Job& outJob);
+    void                        Execute(Job& job);
+
+private:
+    uint32_t                    mThreadCount;
+
+    std::vector<std::thread>    mWorkers;
+    UPtr<Queue[]>               mQueues;
+
+    /**
+     * Number of jobs currently queued. Used to decide whether idle workers
+     * should go to sleep.
+     */
+    std::atomic<uint32_t>       mQueuedJobs;
+
+    std::atomic<bool>           mSerial;
+
+    /**
+     * Number of workers that are sleeping (or about to sleep) on the sleep
+     * condition. Push() only needs to wake a worker if this is non-zero.
+     */
+    std::atomic<uint32_t>       mSleepingWorkers;
+
+    std::mutex                  mSleepLock;
+    std::condition_variable     mSleepCondition;
+    bool                        mShutdown;
+
+    static thread_local uint32_t sCurrentThreadIndex;
+
+    friend class JobCounter;
+};
+
+/**
+ * Counter used to track completion of a group of jobs. Counters must not be
+ * destroyed while jobs are still pending against them (i.e. Wait() for them
+ * before destroying them).
+ */
+class JobCounter : Uncopyable
+{
+public:
+                                JobCounter();
+                                ~JobCounter();
+
+    /** Return whether all jobs submitted against this counter have completed. */
+    bool                        IsComplete() const
+                                    { return mValue.load(std::memory_order_acquire) == 0; }
+
+private:
+    void                        Increment();
+    void                        Decrement();
+
+private:
+    std::atomic<uint32_t>       mValue;
+
+    /**
+     * Jobs waiting on this counter to reach zero. The lock serialises adding
+     * to this against the counter reaching zero. The counter is only ever
+     * decremented with the lock held, see JobSystem::Wait() for why.
+     */
+    mutable std::mutex          mLock;
+    std::vector<JobSystem::Job> mWaitingJobs;
+
+    friend class JobSystem;
+};
+
+inline JobCounter::JobCounter() :
+    mValue  (0)
+{
+}
+
+inline JobCounter::~JobCounter()
+{
+    Assert(IsComplete());
+    Assert(mWaitingJobs.empty());
+}
+
+inline void JobCounter::Increment()
+{
+    mValue.fetch_add(1, std::memory_order_relaxed);
+}
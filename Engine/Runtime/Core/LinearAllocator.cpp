@@ -18,76 +18,180 @@
 
 #include "Core/Utility.h"
 
+#include <algorithm>
 #include <cstdlib>
 
 static const size_t kMinAlignment = 16;
 static const size_t kMaxAlignment = 4096;
 
-LinearAllocator::LinearAllocator(const size_t maxSize) :
-    mCurrentOffset  (0),
-    mMaxSize        (maxSize)
+LinearAllocator::LinearAllocator(const size_t blockSize) :
+    mBlockSize      (RoundUp(blockSize, kMaxAlignment)),
+    mCurrentBlock   (nullptr),
+    mUsedBlocks     (nullptr),
+    mFreeBlocks     (nullptr)
 {
+    #if GEMINI_BUILD_DEBUG
+        mOutstandingDeletions.store(0, std::memory_order_relaxed);
+    #endif
+}
+
+LinearAllocator::~LinearAllocator()
+{
+    for (Block* list : { mUsedBlocks, mFreeBlocks })
+    {
+        while (list)
+        {
+            Block* const block = list;
+            list = block->next;
+            DestroyBlock(block);
+        }
+    }
+}
+
+LinearAllocator::Block* LinearAllocator::CreateBlock(const size_t size)
+{
+    Assert(size % kMaxAlignment == 0);
+
+    Block* const block = new Block;
+    block->next = nullptr;
+    block->size = size;
+
     #if GEMINI_PLATFORM_WIN32
-        mAllocation = _aligned_malloc(maxSize, kMaxAlignment);
+        block->data = reinterpret_cast<uint8_t*>(_aligned_malloc(size, kMaxAlignment));
     #else
-        mAllocation = std::aligned_alloc(kMaxAlignment, maxSize);
+        block->data = reinterpret_cast<uint8_t*>(std::aligned_alloc(kMaxAlignment, size));
     #endif
+
+    if (!block->data)
+    {
+        Fatal("LinearAllocator failed to allocate %zu byte block", size);
+    }
+
+    block->offset.store(0, std::memory_order_relaxed);
+
+    return block;
 }
 
-LinearAllocator::~LinearAllocator()
+void LinearAllocator::DestroyBlock(Block* const block)
 {
     #if GEMINI_PLATFORM_WIN32
-        _aligned_free(mAllocation);
+        _aligned_free(block->data);
     #else
-        std::free(mAllocation);
+        std::free(block->data);
     #endif
+
+    delete block;
 }
 
-void* LinearAllocator::Allocate(const size_t size,
-                                const size_t alignment)
+void* LinearAllocator::AllocateLarge(const size_t size)
 {
-    Assert(IsPowerOf2(alignment));
-    Assert(alignment <= kMaxAlignment);
+    /* Block data is aligned to kMaxAlignment so this satisfies any alignment.
+     * Large blocks are never made current, so the whole block is used by this
+     * allocation. */
+    Block* const block = CreateBlock(RoundUp(size, kMaxAlignment));
+    block->offset.store(block->size, std::memory_order_relaxed);
 
-    /* Ensure that mCurrentOffset is always aligned to kMinAlignment. */
-    const size_t alignedSize = RoundUp(size, kMinAlignment);
+    std::unique_lock lock(mLock);
+
+    block->next = mUsedBlocks;
+    mUsedBlocks = block;
+
+    return block->data;
+}
 
-    size_t offset;
+void LinearAllocator::NextBlock(Block* const exhausted)
+{
+    std::unique_lock lock(mLock);
 
-    if (alignment > kMinAlignment)
+    /* Another thread may have already replaced the block while we were
+     * waiting for the lock. */
+    if (mCurrentBlock.load(std::memory_order_relaxed) != exhausted)
     {
-        /* When we have an alignment greater than the minimum, use a CAS loop
-         * to get and update the current offset, because we need to make sure
-         * that the offset is aligned and advanced by enough to cover the
-         * alignment and the allocation size. */
-        size_t currentOffset = mCurrentOffset.load(std::memory_order_relaxed);
-        size_t newOffset;
-
-        do
-        {
-            offset    = RoundUp(currentOffset, alignment);
-            newOffset = offset + alignedSize;
-        }
-        while (!mCurrentOffset.compare_exchange_strong(currentOffset,
-                                                       newOffset,
-                                                       std::memory_order_release,
-                                                       std::memory_order_relaxed));
+        return;
+    }
+
+    Block* block = mFreeBlocks;
+
+    if (block)
+    {
+        mFreeBlocks = block->next;
+        block->offset.store(0, std::memory_order_relaxed);
     }
     else
     {
-        /* Otherwise we can just use a simple atomic add. */
-        offset = mCurrentOffset.fetch_add(alignedSize, std::memory_order_relaxed);
+        block = CreateBlock(mBlockSize);
     }
 
-    if (offset + alignedSize > mMaxSize)
+    block->next = mUsedBlocks;
+    mUsedBlocks = block;
+
+    mCurrentBlock.store(block, std::memory_order_release);
+}
+
+void* LinearAllocator::Allocate(const size_t size,
+                                const size_t alignment)
+{
+    Assert(alignment == 0 || IsPowerOf2(alignment));
+    Assert(alignment <= kMaxAlignment);
+
+    /* Ensure that block offsets are always aligned to kMinAlignment. */
+    const size_t alignedSize = RoundUp(size, kMinAlignment);
+
+    /* If this would not fit in a block even after alignment padding, it gets a
+     * block of its own. */
+    if (alignedSize + std::max(alignment, kMinAlignment) > mBlockSize)
     {
-        /* TODO: Make this automatically expand. */
-        Fatal("LinearAllocator allocation of %zu bytes exceeded maximum size %zu",
-              size,
-              mMaxSize);
+        return AllocateLarge(alignedSize);
     }
 
-    return reinterpret_cast<uint8_t*>(mAllocation) + offset;
+    while (true)
+    {
+        Block* const block = mCurrentBlock.load(std::memory_order_acquire);
+
+        if (block)
+        {
+            size_t offset;
+
+            if (alignment > kMinAlignment)
+            {
+                /* When we have an alignment greater than the minimum, use a
+                 * CAS loop to get and update the current offset, because we
+                 * need to make sure that the offset is aligned and advanced by
+                 * enough to cover the alignment and the allocation size. */
+                size_t currentOffset = block->offset.load(std::memory_order_relaxed);
+                size_t newOffset;
+
+                do
+                {
+                    offset    = RoundUp(currentOffset, alignment);
+                    newOffset = offset + alignedSize;
+
+                    if (newOffset > block->size)
+                    {
+                        break;
+                    }
+                }
+                while (!block->offset.compare_exchange_weak(currentOffset,
+                                                            newOffset,
+                                                            std::memory_order_relaxed,
+                                                            std::memory_order_relaxed));
+            }
+            else
+            {
+                /* Otherwise we can just use a simple atomic add. If this takes
+                 * us past the end of the block, that is fine: the block is full
+                 * and every other allocation from it will fail as well. */
+                offset = block->offset.fetch_add(alignedSize, std::memory_order_relaxed);
+            }
+
+            if (offset + alignedSize <= block->size)
+            {
+                return block->data + offset;
+            }
+        }
+
+        NextBlock(block);
+    }
 }
 
 void LinearAllocator::Reset()
@@ -99,5 +203,22 @@ void LinearAllocator::Reset()
         }
     #endif
 
-    mCurrentOffset.store(0, std::memory_order_relaxed);
+    /* Keep hold of standard size blocks for reuse, free dedicated ones. */
+    while (mUsedBlocks)
+    {
+        Block* const block = mUsedBlocks;
+        mUsedBlocks = block->next;
+
+        if (block->size == mBlockSize)
+        {
+            block->next = mFreeBlocks;
+            mFreeBlocks = block;
+        }
+        else
+        {
+            DestroyBlock(block);
+        }
+    }
+
+    mCurrentBlock.store(nullptr, std::memory_order_relaxed);
 }
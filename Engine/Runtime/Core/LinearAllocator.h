@@ -19,6 +19,7 @@
 #include "Core/CoreDefs.h"
 
 #include <atomic>
+#include <mutex>
 #include <new>
 #include <utility>
 
@@ -27,6 +28,14 @@
  * from it cannot be freed - only all allocations can be freed at once by
  * resetting the allocator.
  *
+ * Memory is allocated in a chain of fixed size blocks. When the current block
+ * is exhausted, a new block is added to the chain, so there is no upper limit
+ * on the total amount that can be allocated between resets. Allocations larger
+ * than the block size get a dedicated block. Resetting the allocator keeps
+ * hold of the blocks that were used (except dedicated ones) to be reused, so
+ * once the allocator has reached its high water mark, no further memory
+ * allocation is done.
+ *
  * Allocations of plain memory or trivially destructible types can be done with
  * the Allocate() methods.
  *
@@ -39,7 +48,7 @@
 class LinearAllocator
 {
 public:
-                                LinearAllocator(const size_t maxSize);
+                                LinearAllocator(const size_t blockSize);
                                 ~LinearAllocator();
 
     void*                       Allocate(const size_t size,
@@ -57,12 +66,47 @@ public:
     template <typename T>
     void                        Delete(T* const object);
 
+    /**
+     * Free all allocations. This must not be called concurrently with any
+     * other method.
+     */
     void                        Reset();
 
 private:
-    void*                       mAllocation;
-    std::atomic<size_t>         mCurrentOffset;
-    size_t                      mMaxSize;
+    struct Block
+    {
+        Block*                  next;
+        size_t                  size;
+        uint8_t*                data;
+
+        /** Offset of the next allocation, always aligned to kMinAlignment. */
+        std::atomic<size_t>     offset;
+    };
+
+private:
+    Block*                      CreateBlock(const size_t size);
+    void                        DestroyBlock(Block* const block);
+
+    void*                       AllocateLarge(const size_t size);
+    void                        NextBlock(Block* const exhausted);
+
+private:
+    const size_t                mBlockSize;
+
+    /**
+     * Block that allocations are currently being made from. This is the only
+     * state read without the lock being held.
+     */
+    std::atomic<Block*>         mCurrentBlock;
+
+    /**
+     * List of blocks that are in use since the last reset, including the
+     * current block, and list of blocks available for reuse. Protected by
+     * mLock.
+     */
+    std::mutex                  mLock;
+    Block*                      mUsedBlocks;
+    Block*                      mFreeBlocks;
 
     #if GEMINI_BUILD_DEBUG
     std::atomic<uint32_t>       mOutstandingDeletions;
@@ -0,0 +1,270 @@
+/*
+ * Copyright (C) 2018-2020 Alex Smith
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#include "Core/LooseOctree.h"
+
+LooseOctreeBase::LooseOctreeBase(const float    size,
+                                 const uint32_t maxDepth) :
+    mMaxDepth   (maxDepth)
+{
+    mRoot = new LooseOctreeNode;
+    mRoot->parent       = nullptr;
+    mRoot->childIndex   = 0;
+    mRoot->depth        = 0;
+    mRoot->centre       = glm::vec3(0.0f);
+    mRoot->halfSize     = size / 2;
+    mRoot->looseBounds  = BoundingBox(glm::vec3(-size), glm::vec3(size));
+    mRoot->subtreeCount = 0;
+
+    std::fill(std::begin(mRoot->children), std::end(mRoot->children), nullptr);
+}
+
+LooseOctreeBase::~LooseOctreeBase()
+{
+    Assert(IsEmpty());
+
+    DestroyNode(mRoot);
+}
+
+LooseOctreeNode* LooseOctreeBase::CreateNode(LooseOctreeNode* const parent,
+                                             const uint32_t         childIndex)
+{
+    Assert(!parent->children[childIndex]);
+
+    const float halfSize = parent->halfSize / 2;
+
+    glm::vec3 centre = parent->centre;
+    for (uint32_t axis = 0; axis < 3; axis++)
+    {
+        centre[axis] += (childIndex & (1 << axis)) ? halfSize : -halfSize;
+    }
+
+    LooseOctreeNode* const node = new LooseOctreeNode;
+    node->parent       = parent;
+    node->childIndex   = childIndex;
+    node->depth        = parent->depth + 1;
+    node->centre       = centre;
+    node->halfSize     = halfSize;
+    node->looseBounds  = BoundingBox(centre - (halfSize * 2), centre + (halfSize * 2));
+    node->subtreeCount = 0;
+
+    std::fill(std::begin(node->children), std::end(node->children), nullptr);
+
+    parent->children[childIndex] = node;
+    return node;
+}
+
+void LooseOctreeBase::DestroyNode(LooseOctreeNode* const node)
+{
+    for (LooseOctreeNode* child : node->children)
+    {
+        if (child)
+        {
+            DestroyNode(child);
+        }
+    }
+
+    delete node;
+}
+
+LooseOctreeNode* LooseOctreeBase::FindNode(const BoundingBox& box)
+{
+    const glm::vec3 centre = (box.GetMinimum() + box.GetMaximum()) * 0.5f;
+    const glm::vec3 extent = (box.GetMaximum() - box.GetMinimum()) * 0.5f;
+    const float size       = std::max(extent.x, std::max(extent.y, extent.z));
+
+    LooseOctreeNode* node = mRoot;
+
+    for (uint32_t axis = 0; axis < 3; axis++)
+    {
+        if (std::abs(centre[axis] - mRoot->centre[axis]) > mRoot->halfSize)
+        {
+            return mRoot;
+        }
+    }
+
+    /* Descend to the deepest node that the object fits in: an object is
+     * within the loose bounds of the cell containing its centre as long as
+     * its extent is no more than the cell's half size. */
+    while (node->depth < mMaxDepth && size <= node->halfSize / 2)
+    {
+        uint32_t childIndex = 0;
+        for (uint32_t axis = 0; axis < 3; axis++)
+        {
+            if (centre[axis] >= node->centre[axis])
+            {
+                childIndex |= 1 << axis;
+            }
+        }
+
+        node = (node->children[childIndex])
+                   ? node->children[childIndex]
+                   : CreateNode(node, childIndex);
+    }
+
+    return node;
+}
+
+void LooseOctreeBase::InsertIntoNode(LooseOctreeNode* const node,
+                                     void* const            object,
+                                     LooseOctreeLocation&   location,
+                                     const BoundingBox&     box)
+{
+    location.node  = node;
+    location.index = node->objects.size();
+
+    node->objects.emplace_back(object);
+    node->locations.emplace_back(&location);
+    node->bounds.Add(box);
+
+    for (LooseOctreeNode* current = node; current; current = current->parent)
+    {
+        current->subtreeCount++;
+    }
+}
+
+void LooseOctreeBase::RemoveFromNode(LooseOctreeNode* node,
+                                     const uint32_t   index)
+{
+    const uint32_t last = node->objects.size() - 1;
+
+    /* Move the last object into the removed slot, matching what
+     * BoundingBoxArray::Remove() does. */
+    if (index != last)
+    {
+        node->objects[index]          = node->objects[last];
+        node->locations[index]        = node->locations[last];
+        node->locations[index]->index = index;
+    }
+
+    node->objects.pop_back();
+    node->locations.pop_back();
+    node->bounds.Remove(index);
+
+    for (LooseOctreeNode* current = node; current; current = current->parent)
+    {
+        current->subtreeCount--;
+    }
+
+    /* Free nodes which no longer contain anything. */
+    while (node != mRoot && node->subtreeCount == 0)
+    {
+        LooseOctreeNode* const parent = node->parent;
+
+        parent->children[node->childIndex] = nullptr;
+        DestroyNode(node);
+
+        node = parent;
+    }
+}
+
+void LooseOctreeBase::Insert(void* const          object,
+                             LooseOctreeLocation& location,
+                             const BoundingBox&   box)
+{
+    Assert(!location.IsInserted());
+
+    InsertIntoNode(FindNode(box), object, location, box);
+}
+
+void LooseOctreeBase::Remove(LooseOctreeLocation& location)
+{
+    Assert(location.IsInserted());
+
+    RemoveFromNode(location.node, location.index);
+
+    location.node = nullptr;
+}
+
+void LooseOctreeBase::Update(LooseOctreeLocation& location,
+                             const BoundingBox&   box)
+{
+    Assert(location.IsInserted());
+
+    LooseOctreeNode* const node = FindNode(box);
+
+    if (node == location.node)
+    {
+        node->bounds.Set(location.index, box);
+    }
+    else
+    {
+        /* Insert before removing, so that removal can't free the new node if
+         * it was just created below the old one. */
+        const LooseOctreeLocation oldLocation = location;
+        void* const object = oldLocation.node->objects[oldLocation.index];
+
+        InsertIntoNode(node, object, location, box);
+        RemoveFromNode(oldLocation.node, oldLocation.index);
+    }
+}
+
+void LooseOctreeBase::CollectQueryChunks(const LooseOctreeNode* const node,
+                                         const Frustum* const         frustums,
+                                         uint32_t                     insideMask,
+                                         uint32_t                     intersectMask,
+                                         std::vector<QueryChunk>&     outChunks) const
+{
+    /* As with the single frustum query, the root can't be culled, and once
+     * a node is entirely inside a frustum nothing below needs testing. */
+    if (node != mRoot)
+    {
+        uint32_t bits = intersectMask;
+        while (bits != 0)
+        {
+            const uint32_t frustumIndex = CountTrailingZeros(bits);
+            const uint32_t frustumBit   = 1u << frustumIndex;
+            bits &= bits - 1;
+
+            const IntersectResult result = Math::Classify(frustums[frustumIndex], node->looseBounds);
+
+            if (result != kIntersectResult_Intersecting)
+            {
+                intersectMask &= ~frustumBit;
+
+                if (result == kIntersectResult_Inside)
+                {
+                    insideMask |= frustumBit;
+                }
+            }
+        }
+
+        if (!(insideMask | intersectMask))
+        {
+            return;
+        }
+    }
+
+    const uint32_t count = node->objects.size();
+
+    for (uint32_t start = 0; start < count; start += kQueryChunkSize)
+    {
+        QueryChunk& chunk = outChunks.emplace_back();
+        chunk.node          = node;
+        chunk.start         = start;
+        chunk.count         = std::min(count - start, kQueryChunkSize);
+        chunk.insideMask    = insideMask;
+        chunk.intersectMask = intersectMask;
+    }
+
+    for (const LooseOctreeNode* child : node->children)
+    {
+        if (child)
+        {
+            CollectQueryChunks(child, frustums, insideMask, intersectMask, outChunks);
+        }
+    }
+}
@@ -0,0 +1,463 @@
+/*
+ * Copyright (C) 2018-2020 Alex Smith
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#pragma once
+
+#include "Core/Parallel.h"
+#include "Core/Utility.h"
+
+#include "Core/Math/BoundingBoxArray.h"
+#include "Core/Math/Intersect.h"
+
+#include <vector>
+
+struct LooseOctreeNode;
+
+/**
+ * Location of an object within a LooseOctree. This should be embedded in the
+ * object being stored, and is maintained by the octree.
+ */
+struct LooseOctreeLocation
+{
+public:
+                                LooseOctreeLocation();
+
+    bool                        IsInserted() const  { return node != nullptr; }
+
+private:
+    LooseOctreeNode*            node;
+    uint32_t                    index;
+
+    friend class LooseOctreeBase;
+};
+
+inline LooseOctreeLocation::LooseOctreeLocation() :
+    node    (nullptr),
+    index   (0)
+{
+}
+
+/** Node within a LooseOctree. Internal implementation detail. */
+struct LooseOctreeNode
+{
+    LooseOctreeNode*            parent;
+    LooseOctreeNode*            children[8];
+    uint32_t                    childIndex;
+    uint32_t                    depth;
+
+    glm::vec3                   centre;
+    float                       halfSize;
+
+    /**
+     * Loose bounds of the node, which are twice the size of its cell. All
+     * objects in the node are entirely contained within these.
+     */
+    BoundingBox                 looseBounds;
+
+    /** Number of objects in this node and all of its descendants. */
+    uint32_t                    subtreeCount;
+
+    /**
+     * Objects in the node. Bounds are stored in a BoundingBoxArray so that
+     * they can be culled in batches, and the object's locations are kept in
+     * parallel to update them when objects are moved around.
+     */
+    std::vector<void*>          objects;
+    std::vector<LooseOctreeLocation*> locations;
+    BoundingBoxArray            bounds;
+};
+
+/**
+ * Non-template implementation of LooseOctree, handling all of the tree
+ * structure maintenance. Use LooseOctree instead of this directly.
+ */
+class LooseOctreeBase : Uncopyable
+{
+public:
+    /** Maximum number of frusta that can be given to a single ParallelQuery(). */
+    static constexpr uint32_t   kMaxQueryFrustums = 32;
+
+public:
+    uint32_t                    GetCount() const    { return mRoot->subtreeCount; }
+    bool                        IsEmpty() const     { return GetCount() == 0; }
+
+    /** Remove an object from the tree. */
+    void                        Remove(LooseOctreeLocation& location);
+
+    /**
+     * Update the bounds of an object in the tree. This only moves the object
+     * to a different node if it no longer fits in its current one.
+     */
+    void                        Update(LooseOctreeLocation& location,
+                                       const BoundingBox&   box);
+
+protected:
+                                LooseOctreeBase(const float    size,
+                                                const uint32_t maxDepth);
+                                ~LooseOctreeBase();
+
+    void                        Insert(void* const          object,
+                                       LooseOctreeLocation& location,
+                                       const BoundingBox&   box);
+
+    template <typename Function>
+    void                        QueryNode(const LooseOctreeNode* const node,
+                                          const Frustum&               frustum,
+                                          bool                         inside,
+                                          Function&                    function) const;
+
+    template <typename Shape, typename Function>
+    void                        QueryNode(const LooseOctreeNode* const node,
+                                          const Shape&                 shape,
+                                          Function&                    function) const;
+
+    template <typename Function>
+    void                        ParallelQueryImpl(const Frustum* const frustums,
+                                                  const uint32_t       frustumCount,
+                                                  Function&            function) const;
+
+private:
+    /**
+     * Maximum number of objects in a chunk of work for ParallelQuery(). Must
+     * be a multiple of 32 so that chunk masks are whole words.
+     */
+    static constexpr uint32_t   kQueryChunkSize = 256;
+
+    /** Number of chunks to execute per job in ParallelQuery(). */
+    static constexpr uint32_t   kQueryGrainSize = 4;
+
+    /**
+     * Range of objects within a node to be tested by ParallelQuery(), along
+     * with masks of frusta that the node is entirely inside (all objects
+     * visible) or intersects (objects need testing).
+     */
+    struct QueryChunk
+    {
+        const LooseOctreeNode*  node;
+        uint32_t                start;
+        uint32_t                count;
+        uint32_t                insideMask;
+        uint32_t                intersectMask;
+    };
+
+private:
+    void                        CollectQueryChunks(const LooseOctreeNode* const node,
+                                                   const Frustum* const         frustums,
+                                                   uint32_t                     insideMask,
+                                                   uint32_t                     intersectMask,
+                                                   std::vector<QueryChunk>&     outChunks) const;
+
+    LooseOctreeNode*            FindNode(const BoundingBox& box);
+
+    LooseOctreeNode*            CreateNode(LooseOctreeNode* const parent,
+                                           const uint32_t         childIndex);
+    void                        DestroyNode(LooseOctreeNode* const node);
+
+    void                        InsertIntoNode(LooseOctreeNode* const node,
+                                               void* const            object,
+                                               LooseOctreeLocation&   location,
+                                               const BoundingBox&     box);
+    void                        RemoveFromNode(LooseOctreeNode*       node,
+                                               const uint32_t         index);
+
+protected:
+    LooseOctreeNode*            mRoot;
+
+private:
+    const uint32_t              mMaxDepth;
+
+};
+
+/**
+ * Loose octree for spatial queries on objects with bounding boxes, used to
+ * accelerate culling. Each node has a cubic cell, but stores objects whose
+ * bounds are contained in a box twice the size of the cell (the "loose"
+ * bounds). Therefore an object can be placed just based on its centre and
+ * size, and goes into the deepest node where its size is no more than half of
+ * the cell size. This makes updates cheap, as an object moving within a cell
+ * does not need to move node.
+ *
+ * The tree covers a fixed size cube around the origin. Objects with their
+ * centre outside of that, or too large to fit in any child of the root, are
+ * stored in the root node, which is never culled itself. Nodes are created on
+ * demand and freed when they become empty.
+ *
+ * The tree does not own objects. Each object must embed a LooseOctreeLocation
+ * which is passed to the tree when inserting, updating and removing it.
+ *
+ * Queries only read the tree so can be performed concurrently from multiple
+ * threads, but not while the tree is being modified.
+ */
+template <typename T>
+class LooseOctree : public LooseOctreeBase
+{
+public:
+    /**
+     * Create the tree. size is the size of the cube covered by the tree, and
+     * maxDepth is the depth of the deepest nodes below the root.
+     */
+                                LooseOctree(const float    size,
+                                            const uint32_t maxDepth);
+
+    void                        Insert(T* const             object,
+                                       LooseOctreeLocation& location,
+                                       const BoundingBox&   box);
+
+    /**
+     * Call a function (void (T*)) for every object whose bounds intersect a
+     * frustum. Whole subtrees are accepted or rejected at once where possible,
+     * and the remaining objects are tested in batches.
+     */
+    template <typename Function>
+    void                        Query(const Frustum& frustum,
+                                      Function&&     function) const;
+
+    /**
+     * Query multiple frusta at once, calling a function
+     * (void (uint32_t frustumIndex, T*)) for every object that intersects
+     * each frustum. The tree is traversed once for all frusta, and the
+     * object tests are then split into chunks that are executed in parallel
+     * using the JobSystem, so the function will be called concurrently from
+     * multiple threads. There is no guarantee about the order of calls.
+     * At most kMaxQueryFrustums can be given.
+     */
+    template <typename Function>
+    void                        ParallelQuery(const Frustum* const frustums,
+                                              const uint32_t       frustumCount,
+                                              Function&&           function) const;
+
+    /** Call a function for every object whose bounds intersect a box. */
+    template <typename Function>
+    void                        Query(const BoundingBox& box,
+                                      Function&&         function) const;
+
+    /** Call a function for every object whose bounds intersect a sphere. */
+    template <typename Function>
+    void                        Query(const Sphere& sphere,
+                                      Function&&    function) const;
+
+};
+
+template <typename Function>
+inline void LooseOctreeBase::QueryNode(const LooseOctreeNode* const node,
+                                       const Frustum&               frustum,
+                                       bool                         inside,
+                                       Function&                    function) const
+{
+    /* The root holds objects which don't fit within the tree's bounds, so
+     * can't be culled. Once a node is entirely inside, so is everything below
+     * it. */
+    if (!inside && node != mRoot)
+    {
+        const IntersectResult result = Math::Classify(frustum, node->looseBounds);
+
+        if (result == kIntersectResult_Outside)
+        {
+            return;
+        }
+
+        inside = result == kIntersectResult_Inside;
+    }
+
+    const uint32_t count = node->objects.size();
+
+    if (inside)
+    {
+        for (uint32_t i = 0; i < count; i++)
+        {
+            function(node->objects[i]);
+        }
+    }
+    else if (count > 0)
+    {
+        const uint32_t maskSize = node->bounds.GetMaskSize();
+        uint32_t* const mask    = AllocateStackArray(uint32_t, maskSize);
+
+        Math::Intersect(frustum, node->bounds, mask);
+
+        for (uint32_t i = 0; i < maskSize; i++)
+        {
+            uint32_t bits = mask[i];
+
+            while (bits != 0)
+            {
+                const uint32_t index = (i * 32) + CountTrailingZeros(bits);
+                bits &= bits - 1;
+
+                function(node->objects[index]);
+            }
+        }
+    }
+
+    for (const LooseOctreeNode* child : node->children)
+    {
+        if (child)
+        {
+            QueryNode(child, frustum, inside, function);
+        }
+    }
+}
+
+template <typename Shape, typename Function>
+inline void LooseOctreeBase::QueryNode(const LooseOctreeNode* const node,
+                                       const Shape&                 shape,
+                                       Function&                    function) const
+{
+    if (node != mRoot && !Math::Intersect(shape, node->looseBounds))
+    {
+        return;
+    }
+
+    const uint32_t count = node->objects.size();
+
+    for (uint32_t i = 0; i < count; i++)
+    {
+        if (Math::Intersect(shape, node->bounds.Get(i)))
+        {
+            function(node->objects[i]);
+        }
+    }
+
+    for (const LooseOctreeNode* child : node->children)
+    {
+        if (child)
+        {
+            QueryNode(child, shape, function);
+        }
+    }
+}
+
+template <typename Function>
+inline void LooseOctreeBase::ParallelQueryImpl(const Frustum* const frustums,
+                                               const uint32_t       frustumCount,
+                                               Function&            function) const
+{
+    static_assert(kQueryChunkSize % 32 == 0, "Chunk size must be a multiple of 32");
+
+    Assert(frustumCount <= kMaxQueryFrustums);
+
+    if (frustumCount == 0)
+    {
+        return;
+    }
+
+    const uint32_t allMask = (frustumCount == 32) ? ~0u : (1u << frustumCount) - 1;
+
+    std::vector<QueryChunk> chunks;
+    CollectQueryChunks(mRoot, frustums, 0, allMask, chunks);
+
+    ParallelFor(
+        chunks.size(),
+        kQueryGrainSize,
+        [&] (const size_t index)
+        {
+            const QueryChunk& chunk     = chunks[index];
+            const LooseOctreeNode* node = chunk.node;
+
+            uint32_t bits = chunk.insideMask;
+            while (bits != 0)
+            {
+                const uint32_t frustumIndex = CountTrailingZeros(bits);
+                bits &= bits - 1;
+
+                for (uint32_t i = 0; i < chunk.count; i++)
+                {
+                    function(frustumIndex, node->objects[chunk.start + i]);
+                }
+            }
+
+            uint32_t mask[kQueryChunkSize / 32];
+            const uint32_t maskSize = BoundingBoxArray::GetMaskSize(chunk.count);
+
+            bits = chunk.intersectMask;
+            while (bits != 0)
+            {
+                const uint32_t frustumIndex = CountTrailingZeros(bits);
+                bits &= bits - 1;
+
+                Math::Intersect(frustums[frustumIndex], node->bounds, chunk.start, chunk.count, mask);
+
+                for (uint32_t i = 0; i < maskSize; i++)
+                {
+                    uint32_t objectBits = mask[i];
+
+                    while (objectBits != 0)
+                    {
+                        const uint32_t objectIndex = (i * 32) + CountTrailingZeros(objectBits);
+                        objectBits &= objectBits - 1;
+
+                        function(frustumIndex, node->objects[chunk.start + objectIndex]);
+                    }
+                }
+            }
+        });
+}
+
+template <typename T>
+inline LooseOctree<T>::LooseOctree(const float    size,
+                                   const uint32_t maxDepth) :
+    LooseOctreeBase (size, maxDepth)
+{
+}
+
+template <typename T>
+inline void LooseOctree<T>::Insert(T* const             object,
+                                   LooseOctreeLocation& location,
+                                   const BoundingBox&   box)
+{
+    LooseOctreeBase::Insert(object, location, box);
+}
+
+template <typename T>
+template <typename Function>
+inline void LooseOctree<T>::Query(const Frustum& frustum,
+                                  Function&&     function) const
+{
+    auto visit = [&] (void* const object) { function(static_cast<T*>(object)); };
+    QueryNode(mRoot, frustum, false, visit);
+}
+
+template <typename T>
+template <typename Function>
+inline void LooseOctree<T>::ParallelQuery(const Frustum* const frustums,
+                                          const uint32_t       frustumCount,
+                                          Function&&           function) const
+{
+    auto visit = [&] (const uint32_t frustumIndex, void* const object)
+    {
+        function(frustumIndex, static_cast<T*>(object));
+    };
+
+    ParallelQueryImpl(frustums, frustumCount, visit);
+}
+
+template <typename T>
+template <typename Function>
+inline void LooseOctree<T>::Query(const BoundingBox& box,
+                                  Function&&         function) const
+{
+    auto visit = [&] (void* const object) { function(static_cast<T*>(object)); };
+    QueryNode(mRoot, box, visit);
+}
+
+template <typename T>
+template <typename Function>
+inline void LooseOctree<T>::Query(const Sphere& sphere,
+                                  Function&&    function) const
+{
+    auto visit = [&] (void* const object) { function(static_cast<T*>(object)); };
+    QueryNode(mRoot, sphere, visit);
+}
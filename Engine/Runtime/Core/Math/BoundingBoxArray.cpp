@@ -0,0 +1,63 @@
+/*
+ * Copyright (C) 2018-2020 Alex Smith
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#include "Core/Math/BoundingBoxArray.h"
+
+uint32_t BoundingBoxArray::Add(const BoundingBox& box)
+{
+    const uint32_t index = mSize++;
+
+    if (index == mMinimum[0].size())
+    {
+        /* Grow by a whole batch, new entries are zeroed. */
+        for (uint32_t axis = 0; axis < 3; axis++)
+        {
+            mMinimum[axis].resize(index + kBatchSize, 0.0f);
+            mMaximum[axis].resize(index + kBatchSize, 0.0f);
+        }
+    }
+
+    Set(index, box);
+    return index;
+}
+
+void BoundingBoxArray::Remove(const uint32_t index)
+{
+    Assert(index < mSize);
+
+    const uint32_t last = --mSize;
+
+    for (uint32_t axis = 0; axis < 3; axis++)
+    {
+        mMinimum[axis][index] = mMinimum[axis][last];
+        mMaximum[axis][index] = mMaximum[axis][last];
+
+        /* Keep padding zeroed. */
+        mMinimum[axis][last] = 0.0f;
+        mMaximum[axis][last] = 0.0f;
+    }
+}
+
+void BoundingBoxArray::Clear()
+{
+    for (uint32_t axis = 0; axis < 3; axis++)
+    {
+        mMinimum[axis].clear();
+        mMaximum[axis].clear();
+    }
+
+    mSize = 0;
+}
@@ -0,0 +1,112 @@
+/*
+ * Copyright (C) 2018-2020 Alex Smith
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#pragma once
+
+#include "Core/Math/BoundingBox.h"
+
+#include <vector>
+
+/**
+ * Array of bounding boxes stored as a structure-of-arrays, i.e. each component
+ * of the minimum/maximum is stored in a separate contiguous array. This is the
+ * layout wanted by the batched intersection tests (see Math::Intersect()),
+ * which test multiple boxes at a time using SIMD instructions.
+ *
+ * Storage is padded to a multiple of kBatchSize so that tests can always read
+ * whole batches. Padding entries are zeroed, and results for them are masked
+ * off by the tests.
+ *
+ * Boxes are identified by their index within the array. Removal moves the last
+ * box into the removed slot, so users maintaining data in parallel to the
+ * array must do the same.
+ */
+class BoundingBoxArray
+{
+public:
+    /** Number of boxes handled per iteration of the batched tests. */
+    static constexpr uint32_t   kBatchSize = 8;
+
+public:
+                                BoundingBoxArray();
+
+    uint32_t                    GetSize() const     { return mSize; }
+    bool                        IsEmpty() const     { return mSize == 0; }
+
+    /** Add a box to the end of the array, returns its index. */
+    uint32_t                    Add(const BoundingBox& box);
+
+    /**
+     * Remove a box. The last box in the array (if not the one being removed)
+     * is moved into its index.
+     */
+    void                        Remove(const uint32_t index);
+
+    void                        Clear();
+
+    void                        Set(const uint32_t     index,
+                                    const BoundingBox& box);
+    BoundingBox                 Get(const uint32_t index) const;
+
+    /**
+     * Get the array of minimum/maximum values for an axis (0 = X, 1 = Y,
+     * 2 = Z). Contains a multiple of kBatchSize entries.
+     */
+    const float*                GetMinimum(const uint32_t axis) const   { return mMinimum[axis].data(); }
+    const float*                GetMaximum(const uint32_t axis) const   { return mMaximum[axis].data(); }
+
+    /**
+     * Get the number of 32-bit words needed for a bitmask with an entry per
+     * box in the array.
+     */
+    uint32_t                    GetMaskSize() const { return GetMaskSize(mSize); }
+    static uint32_t             GetMaskSize(const uint32_t count)
+                                    { return (count + 31) / 32; }
+
+private:
+    std::vector<float>          mMinimum[3];
+    std::vector<float>          mMaximum[3];
+    uint32_t                    mSize;
+
+};
+
+inline BoundingBoxArray::BoundingBoxArray() :
+    mSize   (0)
+{
+}
+
+inline void BoundingBoxArray::Set(const uint32_t     index,
+                                  const BoundingBox& box)
+{
+    Assert(index < mSize);
+
+    const glm::vec3& minimum = box.GetMinimum();
+    const glm::vec3& maximum = box.GetMaximum();
+
+    for (uint32_t axis = 0; axis < 3; axis++)
+    {
+        mMinimum[axis][index] = minimum[axis];
+        mMaximum[axis][index] = maximum[axis];
+    }
+}
+
+inline BoundingBox BoundingBoxArray::Get(const uint32_t index) const
+{
+    Assert(index < mSize);
+
+    return BoundingBox(glm::vec3(mMinimum[0][index], mMinimum[1][index], mMinimum[2][index]),
+                       glm::vec3(mMaximum[0][index], mMaximum[1][index], mMaximum[2][index]));
+}
@@ -17,6 +17,7 @@
 #pragma once
 
 #include "Core/Math/Sphere.h"
+#include "Core/Math/Transform.h"
 
 class Cone
 {
@@ -34,11 +35,13 @@ public:
 
     /**
      * Generate geometry (triangle list) representing the cone. baseVertices
-     * specifies the number of divisions around the base.
+     * specifies the number of divisions around the base. The output vectors
+     * can use any allocator.
      */
-    void                        CreateGeometry(const uint32_t          baseVertices,
-                                               std::vector<glm::vec3>& outVertices,
-                                               std::vector<uint16_t>&  outIndices) const;
+    template <typename VertexAllocator, typename IndexAllocator>
+    void                        CreateGeometry(const uint32_t                          baseVertices,
+                                               std::vector<glm::vec3, VertexAllocator>& outVertices,
+                                               std::vector<uint16_t, IndexAllocator>&   outIndices) const;
 
     /**
      * Calculate a bounding sphere that fits the cone as tightly as possible.
@@ -74,3 +77,50 @@ inline Cone::Cone(const glm::vec3& origin,
 {
     Assert(glm::isNormalized(direction, 0.0001f));
 }
+
+template <typename VertexAllocator, typename IndexAllocator>
+inline void Cone::CreateGeometry(const uint32_t                          baseVertices,
+                                 std::vector<glm::vec3, VertexAllocator>& outVertices,
+                                 std::vector<uint16_t, IndexAllocator>&   outIndices) const
+{
+    outVertices.clear();
+    outVertices.reserve(baseVertices + 2);
+
+    outIndices.clear();
+    outIndices.reserve(6 * baseVertices);
+
+    /* Calculate a transformation between a unit cone in the negative Z
+     * direction and a cone with the properties we want. */
+    constexpr glm::vec3 kBaseDirection(0.0f, 0.0f, -1.0f);
+    const float radius = std::tan(mHalfAngle) * mHeight;
+    const Transform transform(mOrigin,
+                              glm::rotation(kBaseDirection, mDirection),
+                              glm::vec3(radius, radius, mHeight));
+
+    /* Add the vertices. Head, then the base. */
+    outVertices.emplace_back(mOrigin);
+    outVertices.emplace_back(mOrigin + (mDirection * mHeight));
+    const float delta = (2 * glm::pi<float>()) / baseVertices;
+    for (uint32_t i = 0; i < baseVertices; i++)
+    {
+        const float angle = i * delta;
+        const float x = cosf(angle);
+        const float y = sinf(angle);
+        const float z = -1;
+        outVertices.emplace_back(glm::vec3(transform.GetMatrix() * glm::vec4(x, y, z, 1.0f)));
+    }
+
+    /* Add indices. Cone head to base, then the base. */
+    for (uint32_t i = 0; i < baseVertices; i++)
+    {
+        outIndices.emplace_back(0);
+        outIndices.emplace_back(i + 2);
+        outIndices.emplace_back(((i + 1) % baseVertices) + 2);
+    }
+    for (uint32_t i = 0; i < baseVertices; i++)
+    {
+        outIndices.emplace_back(1);
+        outIndices.emplace_back(((i + 1) % baseVertices) + 2);
+        outIndices.emplace_back(i + 2);
+    }
+}
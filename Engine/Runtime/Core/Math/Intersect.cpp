@@ -16,6 +16,47 @@
 
 #include "Core/Math/Intersect.h"
 
+#include <cstring>
+
+/*
+ * Select the instruction set used for batched tests. We use AVX only if the
+ * compiler is targeting it, SSE2 is always available on x86-64. Other
+ * architectures use the scalar fallback.
+ */
+#if defined(__AVX__)
+    #define INTERSECT_USE_AVX 1
+    #include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+    #define INTERSECT_USE_SSE 1
+    #include <emmintrin.h>
+#endif
+
+static_assert(32 % BoundingBoxArray::kBatchSize == 0,
+              "Batch size must evenly divide mask words");
+
+/**
+ * Per-plane data for the batched box test. Which of the box's minimum/maximum
+ * is used for each axis of the P-vertex depends only on the plane normal, so
+ * rather than selecting per-box, we select which array to read from up front.
+ */
+struct BatchPlane
+{
+    const float*                p[3];
+    float                       normal[3];
+    float                       distance;
+};
+
+bool Math::Intersect(const Sphere&      sphere,
+                     const BoundingBox& box)
+{
+    /* Find the closest point in the box to the sphere centre. */
+    const glm::vec3& centre = sphere.GetCentre();
+    const glm::vec3 closest = glm::clamp(centre, box.GetMinimum(), box.GetMaximum());
+    const glm::vec3 offset  = closest - centre;
+
+    return glm::dot(offset, offset) <= sphere.GetRadius() * sphere.GetRadius();
+}
+
 bool Math::Intersect(const Frustum& frustum,
                      const Sphere&  sphere)
 {
@@ -56,3 +97,175 @@ bool Math::Intersect(const Frustum&     frustum,
 
     return true;
 }
+
+IntersectResult Math::Classify(const Frustum&     frustum,
+                               const BoundingBox& box)
+{
+    IntersectResult result = kIntersectResult_Inside;
+
+    for (unsigned i = 0; i < Frustum::kNumPlanes; i++)
+    {
+        const Plane& plane     = frustum.GetPlane(i);
+        const glm::vec3 normal = plane.GetNormal();
+
+        /* If the P-vertex is behind the plane the box is outside. If the
+         * N-vertex is behind the plane the box straddles it. */
+        if (plane.DistanceTo(box.CalculatePVertex(normal)) < 0.0f)
+        {
+            return kIntersectResult_Outside;
+        }
+        else if (plane.DistanceTo(box.CalculateNVertex(normal)) < 0.0f)
+        {
+            result = kIntersectResult_Intersecting;
+        }
+    }
+
+    return result;
+}
+
+/**
+ * Test a batch of kBatchSize boxes starting at the given index, returns a mask
+ * of the boxes which intersect. Distance calculation is done in the same order
+ * as Plane::DistanceTo() so that results match the single box test exactly.
+ */
+static inline uint32_t IntersectBatch(const BatchPlane* const planes,
+                                      const uint32_t          index)
+{
+    #if INTERSECT_USE_AVX
+
+        static_assert(BoundingBoxArray::kBatchSize == 8, "AVX path assumes batch size of 8");
+
+        __m256 result = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+
+        for (uint32_t i = 0; i < Frustum::kNumPlanes; i++)
+        {
+            const BatchPlane& plane = planes[i];
+
+            __m256 distance =            _mm256_mul_ps(_mm256_set1_ps(plane.normal[0]), _mm256_loadu_ps(&plane.p[0][index]));
+            distance = _mm256_add_ps(distance, _mm256_mul_ps(_mm256_set1_ps(plane.normal[1]), _mm256_loadu_ps(&plane.p[1][index])));
+            distance = _mm256_add_ps(distance, _mm256_mul_ps(_mm256_set1_ps(plane.normal[2]), _mm256_loadu_ps(&plane.p[2][index])));
+            distance = _mm256_sub_ps(distance, _mm256_set1_ps(plane.distance));
+
+            /* Not-less-than rather than greater-or-equal to match the scalar
+             * test's handling of NaN. */
+            result = _mm256_and_ps(result, _mm256_cmp_ps(distance, _mm256_setzero_ps(), _CMP_NLT_UQ));
+
+            if (_mm256_testz_ps(result, result))
+            {
+                return 0;
+            }
+        }
+
+        return static_cast<uint32_t>(_mm256_movemask_ps(result));
+
+    #elif INTERSECT_USE_SSE
+
+        uint32_t mask = 0;
+
+        for (uint32_t offset = 0; offset < BoundingBoxArray::kBatchSize; offset += 4)
+        {
+            __m128 result = _mm_castsi128_ps(_mm_set1_epi32(-1));
+
+            for (uint32_t i = 0; i < Frustum::kNumPlanes; i++)
+            {
+                const BatchPlane& plane = planes[i];
+                const uint32_t    start = index + offset;
+
+                __m128 distance =         _mm_mul_ps(_mm_set1_ps(plane.normal[0]), _mm_loadu_ps(&plane.p[0][start]));
+                distance = _mm_add_ps(distance, _mm_mul_ps(_mm_set1_ps(plane.normal[1]), _mm_loadu_ps(&plane.p[1][start])));
+                distance = _mm_add_ps(distance, _mm_mul_ps(_mm_set1_ps(plane.normal[2]), _mm_loadu_ps(&plane.p[2][start])));
+                distance = _mm_sub_ps(distance, _mm_set1_ps(plane.distance));
+
+                result = _mm_and_ps(result, _mm_cmpnlt_ps(distance, _mm_setzero_ps()));
+
+                if (_mm_movemask_ps(result) == 0)
+                {
+                    break;
+                }
+            }
+
+            mask |= static_cast<uint32_t>(_mm_movemask_ps(result)) << offset;
+        }
+
+        return mask;
+
+    #else
+
+        uint32_t mask = 0;
+
+        for (uint32_t offset = 0; offset < BoundingBoxArray::kBatchSize; offset++)
+        {
+            const uint32_t box = index + offset;
+            bool visible       = true;
+
+            for (uint32_t i = 0; i < Frustum::kNumPlanes && visible; i++)
+            {
+                const BatchPlane& plane = planes[i];
+
+                const float distance =
+                    plane.normal[0] * plane.p[0][box] +
+                    plane.normal[1] * plane.p[1][box] +
+                    plane.normal[2] * plane.p[2][box] -
+                    plane.distance;
+
+                visible = !(distance < 0.0f);
+            }
+
+            mask |= static_cast<uint32_t>(visible) << offset;
+        }
+
+        return mask;
+
+    #endif
+}
+
+void Math::Intersect(const Frustum&          frustum,
+                     const BoundingBoxArray& boxes,
+                     uint32_t* const         outMask)
+{
+    Intersect(frustum, boxes, 0, boxes.GetSize(), outMask);
+}
+
+void Math::Intersect(const Frustum&          frustum,
+                     const BoundingBoxArray& boxes,
+                     const uint32_t          start,
+                     const uint32_t          count,
+                     uint32_t* const         outMask)
+{
+    Assert(start % BoundingBoxArray::kBatchSize == 0);
+    Assert(start + count <= boxes.GetSize());
+
+    BatchPlane planes[Frustum::kNumPlanes];
+
+    for (uint32_t i = 0; i < Frustum::kNumPlanes; i++)
+    {
+        const Plane& plane     = frustum.GetPlane(i);
+        const glm::vec3 normal = plane.GetNormal();
+
+        /* Same selection as BoundingBox::CalculatePVertex(). */
+        for (uint32_t axis = 0; axis < 3; axis++)
+        {
+            planes[i].p[axis] = (normal[axis] >= 0.0f)
+                                    ? boxes.GetMaximum(axis)
+                                    : boxes.GetMinimum(axis);
+
+            planes[i].normal[axis] = normal[axis];
+        }
+
+        planes[i].distance = plane.GetDistance();
+    }
+
+    memset(outMask, 0, BoundingBoxArray::GetMaskSize(count) * sizeof(uint32_t));
+
+    for (uint32_t offset = 0; offset < count; offset += BoundingBoxArray::kBatchSize)
+    {
+        outMask[offset / 32] |= IntersectBatch(planes, start + offset) << (offset % 32);
+    }
+
+    /* Clear results for boxes past the end of the range in the last batch. */
+    const uint32_t remainder = count % 32;
+    if (remainder != 0)
+    {
+        outMask[count / 32] &= (1u << remainder) - 1;
+    }
+}
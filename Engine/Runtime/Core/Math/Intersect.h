@@ -17,11 +17,34 @@
 #pragma once
 
 #include "Core/Math/BoundingBox.h"
+#include "Core/Math/BoundingBoxArray.h"
 #include "Core/Math/Frustum.h"
 #include "Core/Math/Sphere.h"
 
+/** Result of Math::Classify(). */
+enum IntersectResult
+{
+    /** Object is entirely outside the other. */
+    kIntersectResult_Outside,
+
+    /** Object intersects with the other (or we can't tell if it's inside). */
+    kIntersectResult_Intersecting,
+
+    /** Object is entirely inside the other. */
+    kIntersectResult_Inside,
+};
+
 namespace Math
 {
+    bool                    Intersect(const BoundingBox& a,
+                                      const BoundingBox& b);
+
+    bool                    Intersect(const Sphere&      sphere,
+                                      const BoundingBox& box);
+
+    bool                    Intersect(const BoundingBox& box,
+                                      const Sphere&      sphere);
+
     bool                    Intersect(const Frustum&     frustum,
                                       const Sphere&      sphere);
 
@@ -33,6 +56,57 @@ namespace Math
 
     bool                    Intersect(const BoundingBox& box,
                                       const Frustum&     frustum);
+
+    /**
+     * Determine whether a box is outside, intersecting or entirely inside a
+     * frustum. This is more expensive than Intersect(), it is intended for
+     * hierarchical culling where knowing that a node is entirely inside
+     * means that nothing below it needs to be tested.
+     */
+    IntersectResult         Classify(const Frustum&     frustum,
+                                     const BoundingBox& box);
+
+    /**
+     * Batched version of the frustum/box test. Tests every box in the array,
+     * and sets bit (i % 32) of word (i / 32) in outMask if box i intersects
+     * the frustum, giving the same result as the single box version. The
+     * mask must have space for BoundingBoxArray::GetMaskSize() words. Bits
+     * beyond the number of boxes are cleared.
+     */
+    void                    Intersect(const Frustum&          frustum,
+                                      const BoundingBoxArray& boxes,
+                                      uint32_t* const         outMask);
+
+    /**
+     * Batched frustum/box test on a range of boxes within the array. Bit i of
+     * the mask is set if box (start + i) intersects. start must be a multiple
+     * of BoundingBoxArray::kBatchSize, and the mask must have space for
+     * BoundingBoxArray::GetMaskSize(count) words.
+     */
+    void                    Intersect(const Frustum&          frustum,
+                                      const BoundingBoxArray& boxes,
+                                      const uint32_t          start,
+                                      const uint32_t          count,
+                                      uint32_t* const         outMask);
+}
+
+inline bool Math::Intersect(const BoundingBox& a,
+                            const BoundingBox& b)
+{
+    const glm::vec3& aMin = a.GetMinimum();
+    const glm::vec3& aMax = a.GetMaximum();
+    const glm::vec3& bMin = b.GetMinimum();
+    const glm::vec3& bMax = b.GetMaximum();
+
+    return aMin.x <= bMax.x && aMax.x >= bMin.x &&
+           aMin.y <= bMax.y && aMax.y >= bMin.y &&
+           aMin.z <= bMax.z && aMax.z >= bMin.z;
+}
+
+inline bool Math::Intersect(const BoundingBox& box,
+                            const Sphere&      sphere)
+{
+    return Intersect(sphere, box);
 }
 
 inline bool Math::Intersect(const Sphere&  sphere,
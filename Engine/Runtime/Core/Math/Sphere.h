@@ -34,12 +34,13 @@ public:
      * Generate geometry (triangle list) representing the sphere. rings
      * specifies the number of rings along the Y axis (like lines of latitude),
      * sectors specifies the number of rings around the Y axis (like lines of
-     * longitude).
+     * longitude). The output vectors can use any allocator.
      */
-    void                        CreateGeometry(const uint32_t          rings,
-                                               const uint32_t          sectors,
-                                               std::vector<glm::vec3>& outVertices,
-                                               std::vector<uint16_t>&  outIndices) const;
+    template <typename VertexAllocator, typename IndexAllocator>
+    void                        CreateGeometry(const uint32_t                          rings,
+                                               const uint32_t                          sectors,
+                                               std::vector<glm::vec3, VertexAllocator>& outVertices,
+                                               std::vector<uint16_t, IndexAllocator>&   outIndices) const;
 
 private:
     glm::vec3                   mCentre;
@@ -60,3 +61,44 @@ inline Sphere::Sphere(const glm::vec3& centre,
 {
     Assert(radius >= 0.0f);
 }
+
+template <typename VertexAllocator, typename IndexAllocator>
+inline void Sphere::CreateGeometry(const uint32_t                          rings,
+                                   const uint32_t                          sectors,
+                                   std::vector<glm::vec3, VertexAllocator>& outVertices,
+                                   std::vector<uint16_t, IndexAllocator>&   outIndices) const
+{
+    outVertices.clear();
+    outVertices.reserve(rings * sectors);
+
+    outIndices.clear();
+    outIndices.reserve(rings * sectors * 6);
+
+    const float R = 1.0f / static_cast<float>(rings - 1);
+    const float S = 1.0f / static_cast<float>(sectors - 1);
+
+    for (uint32_t r = 0; r < rings; r++)
+    {
+        for (uint32_t s = 0; s < sectors; s++)
+        {
+            const float x = cos(2 * glm::pi<float>() * s * S) * sin(glm::pi<float>() * r * R);
+            const float y = sin(-glm::half_pi<float>() + glm::pi<float>() * r * R);
+            const float z = sin(2 * glm::pi<float>() * s * S) * sin(glm::pi<float>() * r * R);
+
+            outVertices.emplace_back(GetCentre() + (glm::vec3(x, y, z) * GetRadius()));
+        }
+    }
+
+    for (uint32_t r = 0; r < rings - 1; r++)
+    {
+        for (uint32_t s = 0; s < sectors - 1; s++)
+        {
+            outIndices.emplace_back(r * sectors + s);
+            outIndices.emplace_back((r + 1) * sectors + s);
+            outIndices.emplace_back((r + 1) * sectors + (s + 1));
+            outIndices.emplace_back((r + 1) * sectors + (s + 1));
+            outIndices.emplace_back(r * sectors + (s + 1));
+            outIndices.emplace_back(r * sectors + s);
+        }
+    }
+}
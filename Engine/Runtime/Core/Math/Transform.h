@@ -30,6 +30,15 @@ public:
                                       const glm::quat& orientation,
                                       const glm::vec3& scale);
 
+    /**
+     * Construct with an already calculated matrix, which must match the
+     * other parameters.
+     */
+                            Transform(const glm::vec3& position,
+                                      const glm::quat& orientation,
+                                      const glm::vec3& scale,
+                                      const glm::mat4& matrix);
+
     /**
      * Update the whole transformation. This should be preferred when changing
      * multiple parts of the transformation, since it allows the matrix update
@@ -83,6 +92,17 @@ inline Transform::Transform(const glm::vec3& position,
     UpdateMatrix();
 }
 
+inline Transform::Transform(const glm::vec3& position,
+                            const glm::quat& orientation,
+                            const glm::vec3& scale,
+                            const glm::mat4& matrix) :
+    mPosition       (position),
+    mOrientation    (orientation),
+    mScale          (scale),
+    mMatrix         (matrix)
+{
+}
+
 inline void Transform::Set(const glm::vec3& position,
                            const glm::quat& orientation,
                            const glm::vec3& scale)
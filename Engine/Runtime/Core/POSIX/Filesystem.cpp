@@ -16,6 +16,7 @@
 
 #include "Core/Filesystem.h"
 
+#include <sys/mman.h>
 #include <sys/stat.h>
 
 #include <dirent.h>
@@ -48,6 +49,18 @@ private:
 
 };
 
+class POSIXMappedFile final : public MappedFile
+{
+public:
+                                POSIXMappedFile(void* const  mapping,
+                                                const size_t size);
+                                ~POSIXMappedFile();
+
+private:
+    void*                       mMapping;
+
+};
+
 class POSIXDirectory final : public Directory
 {
 public:
@@ -140,6 +153,21 @@ bool POSIXFile::Write(const void* const buffer,
     return pwrite(mFD, buffer, size, offset) == static_cast<ssize_t>(size);
 }
 
+POSIXMappedFile::POSIXMappedFile(void* const  mapping,
+                                 const size_t size) :
+    MappedFile  (mapping, size),
+    mMapping    (mapping)
+{
+}
+
+POSIXMappedFile::~POSIXMappedFile()
+{
+    if (mMapping)
+    {
+        munmap(mMapping, GetSize());
+    }
+}
+
 POSIXDirectory::POSIXDirectory(DIR* const directory) :
     mDirectory (directory)
 {
@@ -230,6 +258,38 @@ File* Filesystem::OpenFile(const Path&    path,
     return new POSIXFile(fd);
 }
 
+MappedFile* Filesystem::MapFile(const Path& path)
+{
+    const int fd = open(path.GetCString(), O_RDONLY);
+    if (fd < 0)
+    {
+        return nullptr;
+    }
+
+    auto guard = MakeScopeGuard([fd] { close(fd); });
+
+    struct stat st;
+    if (fstat(fd, &st) != 0)
+    {
+        return nullptr;
+    }
+
+    /* Mapping an empty file is not allowed. */
+    if (st.st_size == 0)
+    {
+        return new POSIXMappedFile(nullptr, 0);
+    }
+
+    /* The mapping remains valid after the file is closed. */
+    void* const mapping = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (mapping == MAP_FAILED)
+    {
+        return nullptr;
+    }
+
+    return new POSIXMappedFile(mapping, st.st_size);
+}
+
 Directory* Filesystem::OpenDirectory(const Path& path)
 {
     DIR* directory = opendir(path.GetCString());
@@ -0,0 +1,117 @@
+/*
+ * Copyright (C) 2018-2020 Alex Smith
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#pragma once
+
+#include "Core/JobSystem.h"
+
+#include <algorithm>
+#include <iterator>
+
+/**
+ * Helpers for data-parallel loops on top of the JobSystem. All of these split
+ * the range into chunks of at most grainSize elements, execute the chunks as
+ * jobs, and return once all chunks have completed (fork/join). The calling
+ * thread takes part in executing the chunks.
+ *
+ * The supplied function will be called concurrently from multiple threads,
+ * so must be safe to do so. The grain size should be chosen such that each
+ * chunk does enough work to outweigh the overhead of a job (in the order of a
+ * few microseconds at least).
+ *
+ * In serial mode (see JobSystem), chunks are executed in order on the calling
+ * thread, with the same chunk boundaries as in parallel mode.
+ */
+
+/**
+ * Call function(begin, end) for each chunk of the range [0, count). This is
+ * the most efficient form, since it allows the function to process the whole
+ * chunk in a tight loop.
+ */
+template <typename Function>
+inline void ParallelForRange(const size_t count,
+                             const size_t grainSize,
+                             Function&&   function)
+{
+    Assert(grainSize > 0);
+
+    JobSystem& jobSystem = JobSystem::Get();
+
+    if (count <= grainSize || jobSystem.IsSerial())
+    {
+        for (size_t begin = 0; begin < count; begin += grainSize)
+        {
+            function(begin, std::min(begin + grainSize, count));
+        }
+
+        return;
+    }
+
+    JobCounter counter;
+
+    /* Submit all but the first chunk, which we execute ourself. */
+    for (size_t begin = grainSize; begin < count; begin += grainSize)
+    {
+        const size_t end = std::min(begin + grainSize, count);
+
+        jobSystem.Run([&function, begin, end] () { function(begin, end); }, &counter);
+    }
+
+    function(0, grainSize);
+
+    jobSystem.Wait(counter);
+}
+
+/** Call function(index) for each index in the range [0, count). */
+template <typename Function>
+inline void ParallelFor(const size_t count,
+                        const size_t grainSize,
+                        Function&&   function)
+{
+    ParallelForRange(
+        count,
+        grainSize,
+        [&function] (const size_t begin, const size_t end)
+        {
+            for (size_t i = begin; i < end; i++)
+            {
+                function(i);
+            }
+        });
+}
+
+/**
+ * Call function(element) for each element in a container. The container must
+ * support random access iteration (e.g. std::vector).
+ */
+template <typename Container, typename Function>
+inline void ParallelForEach(Container&   container,
+                            const size_t grainSize,
+                            Function&&   function)
+{
+    auto first = std::begin(container);
+
+    ParallelForRange(
+        std::size(container),
+        grainSize,
+        [&function, first] (const size_t begin, const size_t end)
+        {
+            for (auto it = first + begin; it != first + end; ++it)
+            {
+                function(*it);
+            }
+        });
+}
@@ -0,0 +1,116 @@
+/*
+ * Copyright (C) 2018-2020 Alex Smith
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#include "Core/TaskGraph.h"
+
+TaskGraph::Task::Task(JobFunction inFunction) :
+    function        (std::move(inFunction)),
+    dependencyCount (0),
+    remaining       (0)
+{
+}
+
+TaskGraph::Task::Task(Task&& other) :
+    function        (std::move(other.function)),
+    successors      (std::move(other.successors)),
+    dependencyCount (other.dependencyCount),
+    remaining       (other.remaining.load(std::memory_order_relaxed))
+{
+}
+
+TaskGraph::TaskGraph()
+{
+}
+
+TaskGraph::~TaskGraph()
+{
+}
+
+TaskHandle TaskGraph::AddTask(JobFunction function)
+{
+    Assert(function);
+
+    TaskHandle handle;
+    handle.index = mTasks.size();
+
+    mTasks.emplace_back(std::move(function));
+
+    return handle;
+}
+
+void TaskGraph::AddEdge(const TaskHandle from,
+                        const TaskHandle to)
+{
+    Assert(from && from.index < mTasks.size());
+    Assert(to && to.index < mTasks.size());
+    Assert(from.index != to.index);
+
+    mTasks[from.index].successors.emplace_back(to.index);
+    mTasks[to.index].dependencyCount++;
+}
+
+void TaskGraph::Start(const uint32_t index,
+                      JobCounter&    counter)
+{
+    JobSystem::Get().Run(
+        [this, index, &counter] ()
+        {
+            Task& task = mTasks[index];
+
+            task.function();
+
+            /* Start any successors that this was the last dependency of. This
+             * is done before our job completes so that the counter does not
+             * reach zero while there is still work to do. */
+            for (const uint32_t successor : task.successors)
+            {
+                if (mTasks[successor].remaining.fetch_sub(1, std::memory_order_acq_rel) == 1)
+                {
+                    Start(successor, counter);
+                }
+            }
+        },
+        &counter);
+}
+
+void TaskGraph::Execute()
+{
+    for (Task& task : mTasks)
+    {
+        task.remaining.store(task.dependencyCount, std::memory_order_relaxed);
+    }
+
+    JobCounter counter;
+
+    for (uint32_t i = 0; i < mTasks.size(); i++)
+    {
+        if (mTasks[i].dependencyCount == 0)
+        {
+            Start(i, counter);
+        }
+    }
+
+    JobSystem::Get().Wait(counter);
+
+    #if GEMINI_BUILD_DEBUG
+        /* Any tasks that did not get executed must be part of a cycle. */
+        for (const Task& task : mTasks)
+        {
+            AssertMsg(task.remaining.load(std::memory_order_relaxed) == 0,
+                      "TaskGraph contains a cycle");
+        }
+    #endif
+}
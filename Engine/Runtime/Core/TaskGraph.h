@@ -0,0 +1,115 @@
+/*
+ * Copyright (C) 2018-2020 Alex Smith
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#pragma once
+
+#include "Core/JobSystem.h"
+
+/**
+ * Handle to a task within a TaskGraph. This is a small opaque type intended to
+ * be passed by value.
+ */
+struct TaskHandle
+{
+public:
+                                TaskHandle();
+
+                                operator bool() const;
+
+private:
+    uint32_t                    index;
+
+    friend class TaskGraph;
+};
+
+inline TaskHandle::TaskHandle() :
+    index   (std::numeric_limits<uint32_t>::max())
+{
+}
+
+inline TaskHandle::operator bool() const
+{
+    return index != std::numeric_limits<uint32_t>::max();
+}
+
+/**
+ * Declarative graph of tasks to be executed on the JobSystem. The graph is
+ * built up front by adding tasks and then explicit edges between them, which
+ * state that one task must complete before another starts. Executing the
+ * graph starts all tasks with no dependencies, and each task starts any of
+ * its successors which have no remaining dependencies when it completes.
+ * Execute() returns once all tasks have completed (fork/join), and the
+ * calling thread takes part in executing tasks while waiting.
+ *
+ * Example:
+ *
+ *   TaskGraph graph;
+ *
+ *   TaskHandle cullMain    = graph.AddTask([&] { ... });
+ *   TaskHandle cullShadow  = graph.AddTask([&] { ... });
+ *   TaskHandle buildLists  = graph.AddTask([&] { ... });
+ *
+ *   graph.AddEdge(cullMain, buildLists);
+ *   graph.AddEdge(cullShadow, buildLists);
+ *
+ *   graph.Execute();
+ *
+ * In serial mode (see JobSystem), tasks are executed on the calling thread in
+ * a deterministic order: each task without dependencies is started in the
+ * order they were added, and each task immediately starts the successors that
+ * it unblocks, in the order the edges were added.
+ *
+ * A graph can be executed multiple times, but must not be modified while it
+ * is executing.
+ */
+class TaskGraph : Uncopyable
+{
+public:
+                                TaskGraph();
+                                ~TaskGraph();
+
+    /** Add a new task to the graph. */
+    TaskHandle                  AddTask(JobFunction function);
+
+    /** Add an edge stating that the task "to" depends on the task "from". */
+    void                        AddEdge(const TaskHandle from,
+                                        const TaskHandle to);
+
+    void                        Execute();
+
+private:
+    struct Task
+    {
+        JobFunction             function;
+        std::vector<uint32_t>   successors;
+        uint32_t                dependencyCount;
+
+        /** Execution state, count of dependencies yet to complete. */
+        std::atomic<uint32_t>   remaining;
+
+    public:
+                                Task(JobFunction inFunction);
+                                Task(Task&& other);
+    };
+
+private:
+    void                        Start(const uint32_t index,
+                                      JobCounter&    counter);
+
+private:
+    std::vector<Task>           mTasks;
+
+};
@@ -21,6 +21,10 @@
 #include <cstring>
 #include <type_traits>
 
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
 /**
  * Helper macros.
  */
@@ -72,6 +76,31 @@ constexpr bool IsOnlyOneBitSet(const T& value)
     return value && !(value & (value - 1));
 }
 
+/** Count the number of set bits in a value. */
+inline uint32_t PopCount(const uint32_t value)
+{
+    #ifdef _MSC_VER
+        /* __popcnt() requires hardware support, do it manually. */
+        uint32_t count = value - ((value >> 1) & 0x55555555);
+        count = (count & 0x33333333) + ((count >> 2) & 0x33333333);
+        return (((count + (count >> 4)) & 0x0f0f0f0f) * 0x01010101) >> 24;
+    #else
+        return __builtin_popcount(value);
+    #endif
+}
+
+/** Count the number of trailing zero bits in a value. Value must be non-zero. */
+inline uint32_t CountTrailingZeros(const uint32_t value)
+{
+    #ifdef _MSC_VER
+        unsigned long ret;
+        _BitScanForward(&ret, value);
+        return static_cast<uint32_t>(ret);
+    #else
+        return __builtin_ctz(value);
+    #endif
+}
+
 /** Test that a value is a power of 2. */
 template <typename T>
 constexpr bool IsPowerOf2(const T& value)
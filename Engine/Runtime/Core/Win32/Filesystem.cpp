@@ -44,6 +44,18 @@ private:
 
 };
 
+class Win32MappedFile final : public MappedFile
+{
+public:
+                            Win32MappedFile(const void* const mapping,
+                                            const size_t      size);
+                            ~Win32MappedFile();
+
+private:
+    const void*             mMapping;
+
+};
+
 class Win32Directory final : public Directory
 {
 public:
@@ -164,6 +176,21 @@ bool Win32File::Write(const void* const buffer,
     return ret && bytesWritten == size;
 }
 
+Win32MappedFile::Win32MappedFile(const void* const mapping,
+                                 const size_t      size) :
+    MappedFile  (mapping, size),
+    mMapping    (mapping)
+{
+}
+
+Win32MappedFile::~Win32MappedFile()
+{
+    if (mMapping)
+    {
+        UnmapViewOfFile(mMapping);
+    }
+}
+
 Win32Directory::Win32Directory(const Path& path) :
     mFind (INVALID_HANDLE_VALUE)
 {
@@ -282,6 +309,56 @@ File* Filesystem::OpenFile(const Path&    path,
     return new Win32File(handle);
 }
 
+MappedFile* Filesystem::MapFile(const Path& path)
+{
+    std::string winPath = path.ToPlatform();
+
+    HANDLE handle = CreateFile(UTF8ToWide(winPath).c_str(),
+                               GENERIC_READ,
+                               FILE_SHARE_READ,
+                               nullptr,
+                               OPEN_EXISTING,
+                               0,
+                               nullptr);
+
+    if (handle == INVALID_HANDLE_VALUE)
+    {
+        return nullptr;
+    }
+
+    auto guard = MakeScopeGuard([handle] { CloseHandle(handle); });
+
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(handle, &size))
+    {
+        return nullptr;
+    }
+
+    /* Mapping an empty file is not allowed. */
+    if (size.QuadPart == 0)
+    {
+        return new Win32MappedFile(nullptr, 0);
+    }
+
+    /* The view remains valid after the handles are closed. */
+    HANDLE mappingHandle = CreateFileMapping(handle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (!mappingHandle)
+    {
+        return nullptr;
+    }
+
+    const void* const mapping = MapViewOfFile(mappingHandle, FILE_MAP_READ, 0, 0, 0);
+
+    CloseHandle(mappingHandle);
+
+    if (!mapping)
+    {
+        return nullptr;
+    }
+
+    return new Win32MappedFile(mapping, size.QuadPart);
+}
+
 Directory* Filesystem::OpenDirectory(const Path& path)
 {
     if (!IsType(path, kFileType_Directory))
@@ -19,8 +19,9 @@
 #include <map>
 
 AssetLoader::AssetLoader() :
-    mData   (nullptr),
-    mPath   (nullptr)
+    mData       (nullptr),
+    mPath       (nullptr),
+    mPrepared   (false)
 {
 }
 
@@ -28,15 +29,53 @@ AssetLoader::~AssetLoader()
 {
 }
 
+bool AssetLoader::Prepare(DataStream* const data,
+                          const char* const path)
+{
+    Assert(!mPrepared);
+
+    mData = data;
+    mPath = path;
+
+    mPrepared = Prepare();
+    return mPrepared;
+}
+
+bool AssetLoader::Prepare()
+{
+    return true;
+}
+
 AssetPtr AssetLoader::Load(DataStream* const data,
                            const char* const path)
 {
+    if (!mPrepared && !Prepare(data, path))
+    {
+        return nullptr;
+    }
+
     mData = data;
     mPath = path;
 
     return Load();
 }
 
+bool AssetLoader::Cook(DataStream* const    data,
+                       const char* const    path,
+                       ObjPtr<AssetLoader>& outLoader)
+{
+    mData = data;
+    mPath = path;
+
+    outLoader.Reset();
+    return Cook(outLoader);
+}
+
+bool AssetLoader::Cook(ObjPtr<AssetLoader>& outLoader)
+{
+    return true;
+}
+
 ObjPtr<AssetLoader> AssetLoader::Create(const std::string& extension)
 {
     /* Map of file types to loader class. */
@@ -53,9 +92,12 @@ ObjPtr<AssetLoader> AssetLoader::Create(const std::string& extension)
                         ObjPtr<Object> object      = metaClass.Construct();
                         ObjPtr<AssetLoader> loader = object.StaticCast<AssetLoader>();
 
+                        /* Loaders with no extension aren't for a file type. */
                         const char* const extension = loader->GetExtension();
-                        
-                        map.insert(std::make_pair(extension, &metaClass));
+                        if (extension)
+                        {
+                            map.insert(std::make_pair(extension, &metaClass));
+                        }
                     }
                 });
 
@@ -34,9 +34,31 @@ public:
     /** Return whether the loader requires a data stream. */
     bool                            RequiresData() const { return GetExtension() != nullptr; }
 
+    /**
+     * Prepare to load the asset. This does any work which does not need to be
+     * done on the main thread, such as decoding source data, and can be
+     * called from any thread. Load() must then be called on the main thread
+     * with the same data stream and path. If this is not called, Load() will
+     * do it itself. Returns false if an error occurred.
+     */
+    bool                            Prepare(DataStream* const data,
+                                            const char* const path);
+
+    /** Load the asset. Must be called on the main thread. */
     AssetPtr                        Load(DataStream* const data,
                                          const char* const path);
 
+    /**
+     * Cook the asset for shipping (see the AssetCooker tool). If possible,
+     * creates a new loader which produces the same asset without needing the
+     * source data, and with minimal work at runtime. If the loader does not
+     * support this, outLoader is set to null and the source data and loader
+     * should be used as is. Returns false if an error occurred.
+     */
+    bool                            Cook(DataStream* const    data,
+                                         const char* const    path,
+                                         ObjPtr<AssetLoader>& outLoader);
+
     DataStream*                     GetData()       { return mData; }
     const DataStream*               GetData() const { return mData; }
 
@@ -46,10 +68,19 @@ protected:
                                     AssetLoader();
                                     ~AssetLoader();
 
+    /** Implementation of Prepare(). The default does nothing. */
+    virtual bool                    Prepare();
+
     virtual AssetPtr                Load() = 0;
 
+    /** Implementation of Cook(). The default does not support cooking. */
+    virtual bool                    Cook(ObjPtr<AssetLoader>& outLoader);
+
 protected:
     DataStream*                     mData;
     const char*                     mPath;
 
+private:
+    bool                            mPrepared;
+
 };
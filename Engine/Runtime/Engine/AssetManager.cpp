@@ -18,11 +18,14 @@
 
 #include "Core/Filesystem.h"
 #include "Core/Platform.h"
+#include "Core/Thread.h"
 
 #include "Engine/AssetLoader.h"
 #include "Engine/DebugWindow.h"
 #include "Engine/JSONSerialiser.h"
+#include "Engine/Profiler.h"
 
+#include <algorithm>
 #include <memory>
 
 static constexpr char kObjectFileExtension[] = "object";
@@ -30,12 +33,51 @@ static constexpr char kLoaderFileExtension[] = "loader";
 
 SINGLETON_IMPL(AssetManager);
 
-AssetManager::AssetManager()
+AssetLoadRequest::AssetLoadRequest(const Path& path) :
+    mPath   (path),
+    mStage  (kStage_Open)
 {
-    mSearchPaths.emplace("Engine", "Engine/Assets");
+}
+
+AssetLoadRequest::~AssetLoadRequest()
+{
+}
+
+void AssetLoadRequest::FreeState()
+{
+    /* Free everything but the result. This is done on the main thread since
+     * the loader can hold references to other assets. */
+    mData.reset();
+    mLoaderData.reset();
+    mLoader.Reset();
+}
+
+AssetManager::AssetManager() :
+    mAsyncLoadBudget    (0)
+{
+    /* Use cooked assets in place of the source assets if they exist. */
+    auto AddSearchPath = [&] (const char* const name, const std::string& path)
+    {
+        const Path cookedPath = Path(kCookedDirectory) / path;
+
+        if (Filesystem::IsType(cookedPath, kFileType_Directory))
+        {
+            mSearchPaths.emplace(name, cookedPath.GetString());
+        }
+        else
+        {
+            #if GEMINI_BUILD_RELEASE
+                LogWarning("Using uncooked assets for '%s', run AssetCooker to cook them", name);
+            #endif
+
+            mSearchPaths.emplace(name, path);
+        }
+    };
+
+    AddSearchPath("Engine", "Engine/Assets");
 
     const std::string gamePath = StringUtils::Format("Games/%s/Assets", Platform::GetProgramName().c_str());
-    mSearchPaths.emplace("Game", gamePath);
+    AddSearchPath("Game", gamePath);
 
     LogDebug("Asset search paths:");
     for (const auto& it : mSearchPaths)
@@ -46,6 +88,16 @@ AssetManager::AssetManager()
 
 AssetManager::~AssetManager()
 {
+    /* Finish outstanding asynchronous loads so that their jobs aren't left
+     * referring to us. */
+    for (AssetLoadRequest* request : mAsyncQueue)
+    {
+        JobSystem::Get().Wait(request->mJobs);
+    }
+
+    mAsyncQueue.clear();
+    mAsyncLoads.clear();
+
     /* Assets should have been destroyed by now. */
     Assert(mAssets.empty());
 }
@@ -58,107 +110,253 @@ AssetPtr AssetManager::Load(const Path& path)
         return exist;
     }
 
+    /* If the asset is being loaded asynchronously, complete that now rather
+     * than loading it twice. */
+    AssetLoadRequestPtr request;
+    auto it = mAsyncLoads.find(path.GetString());
+    if (it != mAsyncLoads.end())
+    {
+        request = it->second;
+    }
+    else
+    {
+        request = new AssetLoadRequest(path);
+    }
+
+    while (true)
+    {
+        JobSystem::Get().Wait(request->mJobs);
+
+        if (request->mStage == AssetLoadRequest::kStage_Complete)
+        {
+            break;
+        }
+
+        ExecuteStage(*request);
+    }
+
+    request->FreeState();
+    return request->mAsset;
+}
+
+AssetLoadRequestPtr AssetManager::LoadAsync(const Path& path)
+{
+    Assert(Thread::IsMain());
+
+    AssetLoadRequestPtr request;
+
+    auto it = mAsyncLoads.find(path.GetString());
+    if (it != mAsyncLoads.end())
+    {
+        request = it->second;
+    }
+    else
+    {
+        request = new AssetLoadRequest(path);
+
+        Asset* const exist = LookupAsset(path);
+        if (exist)
+        {
+            request->mAsset = exist;
+            request->mStage = AssetLoadRequest::kStage_Complete;
+        }
+        else
+        {
+            mAsyncLoads.emplace(path.GetString(), request);
+            mAsyncQueue.emplace_back(request);
+
+            StartStage(*request);
+        }
+    }
+
+    return request;
+}
+
+void AssetManager::Update(OnlyCalledBy<Engine>)
+{
+    PROFILER_FUNC_SCOPE("AssetManager", 0xffff00);
+
+    const uint64_t startTime = Platform::GetPerformanceCounter();
+
+    /* Process requests in the order they were made. Indexed since main thread
+     * stages can add new requests. */
+    for (size_t i = 0; i < mAsyncQueue.size(); i++)
+    {
+        if (mAsyncLoadBudget != 0 &&
+            Platform::GetPerformanceCounter() - startTime >= mAsyncLoadBudget)
+        {
+            break;
+        }
+
+        AssetLoadRequest& request = *mAsyncQueue[i];
+
+        if (request.mJobs.IsComplete() && request.mStage != AssetLoadRequest::kStage_Complete)
+        {
+            ExecuteStage(request);
+            StartStage(request);
+        }
+    }
+
+    /* Remove completed requests. They may also have been completed by a
+     * synchronous Load(). */
+    auto newEnd = std::remove_if(mAsyncQueue.begin(),
+                                 mAsyncQueue.end(),
+                                 [&] (const AssetLoadRequestPtr& request)
+                                 {
+                                     if (request->mJobs.IsComplete() &&
+                                         request->mStage == AssetLoadRequest::kStage_Complete)
+                                     {
+                                         request->FreeState();
+                                         mAsyncLoads.erase(request->mPath.GetString());
+                                         return true;
+                                     }
+
+                                     return false;
+                                 });
+
+    mAsyncQueue.erase(newEnd, mAsyncQueue.end());
+}
+
+void AssetManager::StartStage(AssetLoadRequest& request)
+{
+    /* Run stages that can be done off the main thread as jobs. The rest are
+     * done by Update(). */
+    switch (request.mStage)
+    {
+        case AssetLoadRequest::kStage_Open:
+        case AssetLoadRequest::kStage_Prepare:
+            JobSystem::Get().Run([this, &request] () { ExecuteStage(request); },
+                                 &request.mJobs);
+            break;
+
+        default:
+            break;
+
+    }
+}
+
+void AssetManager::ExecuteStage(AssetLoadRequest& request)
+{
+    bool success;
+
+    switch (request.mStage)
+    {
+        case AssetLoadRequest::kStage_Open:
+            success = OpenAsset(request);
+            request.mStage = AssetLoadRequest::kStage_Deserialise;
+            break;
+
+        case AssetLoadRequest::kStage_Deserialise:
+            success = DeserialiseAsset(request);
+            request.mStage = (request.mAsset)
+                                 ? AssetLoadRequest::kStage_Complete
+                                 : AssetLoadRequest::kStage_Prepare;
+            break;
+
+        case AssetLoadRequest::kStage_Prepare:
+            success = request.mLoader->Prepare(request.mData.get(), request.mPath.GetCString());
+            request.mStage = AssetLoadRequest::kStage_Load;
+            break;
+
+        case AssetLoadRequest::kStage_Load:
+            success = LoadAsset(request);
+            request.mStage = AssetLoadRequest::kStage_Complete;
+            break;
+
+        default:
+            Unreachable();
+
+    }
+
+    if (!success)
+    {
+        request.mStage = AssetLoadRequest::kStage_Complete;
+    }
+}
+
+bool AssetManager::OpenAsset(AssetLoadRequest& request)
+{
+    const Path& path = request.mPath;
+
     Path fsPath;
     if (!GetFilesystemPath(path, fsPath))
     {
         LogError("Could not find asset '%s' (unknown search path)", path.GetCString());
-        return nullptr;
+        return false;
     }
 
-    const Path directoryPath    = fsPath.GetDirectoryName();
-    const std::string assetName = fsPath.GetBaseFileName();
-
-    UPtr<Directory> directory(Filesystem::OpenDirectory(directoryPath));
-    if (!directory)
+    AssetFiles files;
+    if (!FindAssetFiles(fsPath, files))
     {
         LogError("Could not find asset '%s'", path.GetCString());
-        return nullptr;
+        return false;
+    }
+    else if (files.multipleData)
+    {
+        LogError("Asset '%s' has multiple data streams", path.GetCString());
+        return false;
     }
 
-    /* Iterate over directory entries to try to find the asset data and a
-     * corresponding loader. */
-    UPtr<DataStream> data;
-    UPtr<DataStream> loaderData;
-    std::string type;
-    Directory::Entry entry;
-    while (directory->Next(entry))
+    /* Map the whole of a file. Serialisers and loaders read directly from the
+     * mapping rather than from a copy of the file contents. This is done up
+     * front so that any failure to open the asset happens at this stage. */
+    auto ReadFile = [&] (const std::string& extension, UPtr<DataStream>& outStream)
     {
-        if (entry.type != kFileType_File)
+        const Path filePath = fsPath + "." + extension;
+
+        outStream.reset(Filesystem::MapFile(filePath));
+        if (!outStream)
         {
-            continue;
+            LogError("Failed to map '%s'", filePath.GetCString());
+            return false;
         }
 
-        if (entry.name.GetBaseFileName() == assetName)
-        {
-            const std::string entryExt = entry.name.GetExtension();
-            const Path filePath        = directoryPath / entry.name;
+        return true;
+    };
 
-            if (entryExt == kLoaderFileExtension)
-            {
-                loaderData.reset(Filesystem::OpenFile(filePath));
-                if (!loaderData)
-                {
-                    LogError("Failed to open '%s'", filePath.GetCString());
-                    return nullptr;
-                }
-            }
-            else if (!entryExt.empty())
-            {
-                if (data)
-                {
-                    LogError("Asset '%s' has multiple data streams", path.GetCString());
-                    return nullptr;
-                }
-
-                data.reset(Filesystem::OpenFile(filePath));
-                if (!data)
-                {
-                    LogError("Failed to open '%s'", filePath.GetCString());
-                    return nullptr;
-                }
-
-                type = entryExt;
-            }
+    if (files.hasLoader && !ReadFile(kLoaderFileExtension, request.mLoaderData))
+    {
+        return false;
+    }
+
+    if (!files.dataExtension.empty())
+    {
+        if (!ReadFile(files.dataExtension, request.mData))
+        {
+            return false;
         }
+
+        request.mType = files.dataExtension;
     }
 
-    if (!data && !loaderData)
+    if (!request.mData && !request.mLoaderData)
     {
         LogError("Could not find asset '%s'", path.GetCString());
-        return nullptr;
+        return false;
     }
 
-    AssetPtr asset;
+    return true;
+}
 
-    /* Helper function used on both paths below to mark the asset as managed
-     * and cache it. */
-    auto AddAsset = [&] (Object* const object)
-    {
-        auto newAsset = static_cast<Asset*>(object);
-        newAsset->SetPath(path.GetString(), {});
-        mAssets.insert(std::make_pair(path.GetString(), newAsset));
-    };
+bool AssetManager::DeserialiseAsset(AssetLoadRequest& request)
+{
+    const Path& path = request.mPath;
 
-    if (type == kObjectFileExtension)
+    if (request.mType == kObjectFileExtension)
     {
         /* This is a serialised object. */
-        type.clear();
-        if (loaderData)
+        if (request.mLoaderData)
         {
             LogError("%s: Serialised object cannot have a loader", path.GetCString());
-            return nullptr;
+            return false;
         }
 
-        Assert(data);
+        Assert(request.mData);
 
-        ByteArray serialisedData(data->GetSize());
-        if (!data->Read(serialisedData.Get(), data->GetSize()))
-        {
-            LogError("%s: Failed to read asset data", path.GetCString());
-            return nullptr;
-        }
+        const uint8_t* const serialisedData = request.mData->GetMemory();
+        const size_t serialisedSize         = request.mData->GetSize();
 
-        JSONSerialiser serialiser;
+        UPtr<Serialiser> serialiser = Serialiser::Create(serialisedData, serialisedSize);
 
         /* We make the asset managed prior to calling its Deserialise() method.
          * This is done for 2 reasons. Firstly, it makes the path available to
@@ -166,89 +364,186 @@ AssetPtr AssetManager::Load(const Path& path)
          * back to the asset by itself or child objects will correctly be
          * resolved to it, rather than causing a recursive attempt to load the
          * asset. */
-        serialiser.postConstructFunction = AddAsset;
+        serialiser->postConstructFunction = [&] (Object* const object)
+        {
+            AddAsset(static_cast<Asset*>(object), path);
+        };
 
-        asset = serialiser.Deserialise<Asset>(serialisedData);
-        if (!asset)
+        request.mAsset = serialiser->Deserialise<Asset>(serialisedData, serialisedSize);
+        if (!request.mAsset)
         {
             LogError("%s: Error during object deserialisation", path.GetCString());
-            return nullptr;
+            return false;
         }
+
+        LogDebug("Loaded asset '%s'", path.GetCString());
+        return true;
     }
-    else
+
+    /* Get a loader for the asset. Use a serialised one if it exists, else get
+     * a default one based on the file type. This is done on the main thread
+     * since a loader can refer to other assets. */
+    if (request.mLoaderData)
     {
-        /* Get a loader for the asset. Use a serialised one if it exists, else
-         * get a default one based on the file type. */
-        ObjPtr<AssetLoader> loader;
-        if (loaderData)
-        {
-            ByteArray serialisedData(loaderData->GetSize());
-            if (!loaderData->Read(serialisedData.Get(), loaderData->GetSize()))
-            {
-                LogError("%s: Failed to read loader data", path.GetCString());
-                return nullptr;
-            }
+        const uint8_t* const serialisedData = request.mLoaderData->GetMemory();
+        const size_t serialisedSize         = request.mLoaderData->GetSize();
 
-            JSONSerialiser serialiser;
-            loader = serialiser.Deserialise<AssetLoader>(serialisedData);
-            if (!loader)
-            {
-                LogError("%s: Error during loader deserialisation", path.GetCString());
-                return nullptr;
-            }
+        UPtr<Serialiser> serialiser = Serialiser::Create(serialisedData, serialisedSize);
+        request.mLoader = serialiser->Deserialise<AssetLoader>(serialisedData, serialisedSize);
+        if (!request.mLoader)
+        {
+            LogError("%s: Error during loader deserialisation", path.GetCString());
+            return false;
+        }
 
-            if (data)
+        if (request.mData)
+        {
+            if (!request.mLoader->RequiresData())
             {
-                if (!loader->RequiresData())
-                {
-                    LogError("%s: Asset '%s' has data but the loader does not use it", path.GetCString());
-                    return nullptr;
-                }
-                else if (type != loader->GetExtension())
-                {
-                    LogError("%s: Asset '%s' has loader but is for a different file type", path.GetCString());
-                    return nullptr;
-                }
+                LogError("%s: Asset '%s' has data but the loader does not use it", path.GetCString());
+                return false;
             }
-            else
+            else if (request.mType != request.mLoader->GetExtension())
             {
-                if (loader->RequiresData())
-                {
-                    LogError("%s: Asset '%s' has no data but the loader requires it", path.GetCString());
-                    return nullptr;
-                }
+                LogError("%s: Asset '%s' has loader but is for a different file type", path.GetCString());
+                return false;
             }
         }
         else
         {
-            loader = AssetLoader::Create(type);
-            if (!loader)
+            if (request.mLoader->RequiresData())
             {
-                LogError("%s: Unknown file type '%s'", path.GetCString(), type.c_str());
-                return nullptr;
+                LogError("%s: Asset '%s' has no data but the loader requires it", path.GetCString());
+                return false;
             }
         }
-
-        /* Create the asset. The loader should log an error if it fails. */
-        asset = loader->Load(data.get(), path.GetCString());
-        if (!asset)
+    }
+    else
+    {
+        request.mLoader = AssetLoader::Create(request.mType);
+        if (!request.mLoader)
         {
-            return nullptr;
+            LogError("%s: Unknown file type '%s'", path.GetCString(), request.mType.c_str());
+            return false;
         }
+    }
+
+    return true;
+}
+
+bool AssetManager::LoadAsset(AssetLoadRequest& request)
+{
+    const Path& path = request.mPath;
 
-        AddAsset(asset);
+    /* Create the asset. The loader should log an error if it fails. */
+    request.mAsset = request.mLoader->Load(request.mData.get(), path.GetCString());
+    if (!request.mAsset)
+    {
+        return false;
     }
 
-    if (!type.empty())
+    AddAsset(request.mAsset, path);
+
+    if (!request.mType.empty())
     {
-        LogDebug("Loaded asset '%s' from source file type '%s'", path.GetCString(), type.c_str());
+        LogDebug("Loaded asset '%s' from source file type '%s'", path.GetCString(), request.mType.c_str());
     }
     else
     {
         LogDebug("Loaded asset '%s'", path.GetCString());
     }
 
-    return asset;
+    return true;
+}
+
+bool AssetManager::FindAssetFiles(const Path& fsPath,
+                                  AssetFiles& outFiles)
+{
+    std::unique_lock<std::mutex> lock(mIndexLock);
+
+    const Path directoryPath = fsPath.GetDirectoryName();
+
+    if (!mIndexedDirectories.contains(directoryPath.GetString()))
+    {
+        IndexDirectory(directoryPath);
+    }
+
+    auto it = mAssetIndex.find(fsPath.GetString());
+    if (it == mAssetIndex.end())
+    {
+        return false;
+    }
+
+    outFiles = it->second;
+    return true;
+}
+
+void AssetManager::IndexDirectory(const Path& directoryPath)
+{
+    /* Mark as indexed even if it doesn't exist so we don't try again. */
+    mIndexedDirectories.emplace(directoryPath.GetString());
+
+    UPtr<Directory> directory(Filesystem::OpenDirectory(directoryPath));
+    if (!directory)
+    {
+        return;
+    }
+
+    Directory::Entry entry;
+    while (directory->Next(entry))
+    {
+        if (entry.type != kFileType_File)
+        {
+            continue;
+        }
+
+        IndexFile(directoryPath, entry.name);
+    }
+}
+
+void AssetManager::IndexFile(const Path& directoryPath,
+                             const Path& name)
+{
+    const std::string extension = name.GetExtension();
+    if (extension.empty())
+    {
+        return;
+    }
+
+    AssetFiles& files = mAssetIndex[(directoryPath / name.GetBaseFileName()).GetString()];
+
+    if (extension == kLoaderFileExtension)
+    {
+        files.hasLoader = true;
+    }
+    else if (files.dataExtension.empty() || files.dataExtension == extension)
+    {
+        files.dataExtension = extension;
+    }
+    else
+    {
+        files.multipleData = true;
+    }
+}
+
+void AssetManager::AddIndexedFile(const Path& fsPath)
+{
+    std::unique_lock<std::mutex> lock(mIndexLock);
+
+    /* Nothing to do if the directory hasn't been indexed yet, the file will
+     * be picked up when it is. */
+    const Path directoryPath = fsPath.GetDirectoryName();
+    if (mIndexedDirectories.contains(directoryPath.GetString()))
+    {
+        IndexFile(directoryPath, fsPath.GetFileName());
+    }
+}
+
+void AssetManager::AddAsset(Asset* const asset,
+                            const Path&  path)
+{
+    asset->SetPath(path.GetString(), {});
+    mAssets.insert(std::make_pair(path.GetString(), asset));
 }
 
 void AssetManager::UnregisterAsset(Asset* const asset,
@@ -307,6 +602,8 @@ bool AssetManager::SaveAsset(Asset* const asset,
 
     LogDebug("Saved asset '%s' ('%s')", path.GetCString(), fsPath.GetCString());
 
+    AddIndexedFile(fsPath);
+
     if (asset->IsManaged())
     {
         /* Re-insert under new path. */
@@ -17,12 +17,78 @@
 #pragma once
 
 #include "Core/HashTable.h"
+#include "Core/JobSystem.h"
 #include "Core/Path.h"
 #include "Core/Singleton.h"
 
 #include "Engine/Asset.h"
 
-#include <map>
+#include <mutex>
+#include <vector>
+
+class AssetLoader;
+class DataStream;
+class Engine;
+
+/**
+ * Handle to an asynchronous asset load started by AssetManager::LoadAsync().
+ * Once IsComplete() returns true, GetAsset() returns the loaded asset, or null
+ * if it failed to load. Requests only complete during AssetManager::Update()
+ * (or a synchronous Load() of the same asset), so this only needs to be polled
+ * once per frame.
+ */
+class AssetLoadRequest : public RefCounted
+{
+public:
+    const Path&             GetPath() const { return mPath; }
+
+    bool                    IsComplete() const;
+
+    const AssetPtr&         GetAsset() const;
+
+    /** Get the loaded asset, or null if it failed or is not of type T. */
+    template <typename T>
+    ObjPtr<T>               GetAsset() const;
+
+private:
+    /**
+     * Loading stages, in order. Open and Prepare are done by jobs, the rest
+     * on the main thread.
+     */
+    enum Stage
+    {
+        kStage_Open,            /**< Find and read the asset files. */
+        kStage_Deserialise,     /**< Deserialise the asset or get a loader. */
+        kStage_Prepare,         /**< Prepare the loader (AssetLoader::Prepare()). */
+        kStage_Load,            /**< Create the asset (AssetLoader::Load()). */
+        kStage_Complete,
+    };
+
+private:
+                            AssetLoadRequest(const Path& path);
+                            ~AssetLoadRequest();
+
+    void                    FreeState();
+
+private:
+    const Path              mPath;
+    Stage                   mStage;
+
+    /** Tracks the job for the current stage, if any. */
+    JobCounter              mJobs;
+
+    UPtr<DataStream>        mData;
+    UPtr<DataStream>        mLoaderData;
+    std::string             mType;
+    ObjPtr<AssetLoader>     mLoader;
+
+    AssetPtr                mAsset;
+
+    friend class AssetManager;
+
+};
+
+using AssetLoadRequestPtr = RefPtr<AssetLoadRequest>;
 
 /**
  * Manager for game assets. Assets are loaded from disk using this class. It
@@ -31,14 +97,22 @@
  * while strings starting with "Game/" map to game-specific assets. Asset paths
  * do not have extensions: the type is known internally.
  * 
- * The way this works at the moment is somewhat temporary. At the moment we
- * always import asset data from source file types at runtime. In future, a
- * compiled game's assets would be binary serialised objects which include the
- * asset data. Loaders would become importers that initially create the assets
- * (e.g. in an editor), and wouldn't be included in a final game build.
+ * By default, asset data is imported from source file types at runtime. The
+ * AssetCooker tool can be used to generate cooked assets (see
+ * kCookedDirectory), which are binary serialised and have their loaders baked
+ * where possible, so that no parsing or decoding of source data is required.
  */
 class AssetManager : public Singleton<AssetManager>
 {
+public:
+    /**
+     * Directory containing cooked assets, generated by the AssetCooker tool.
+     * This mirrors the source directory structure, e.g. cooked assets for
+     * Engine/Assets are in Cooked/Engine/Assets. If cooked assets exist for a
+     * search path they are used instead of the source assets.
+     */
+    static constexpr char   kCookedDirectory[] = "Cooked";
+
 public:
                             AssetManager();
                             ~AssetManager();
@@ -56,6 +130,36 @@ public:
     template <typename T>
     ObjPtr<T>               Load(const Path& path);
 
+    /**
+     * Begin loading an asset asynchronously. File I/O and work which loaders
+     * can do off the main thread (see AssetLoader::Prepare()) is done by jobs.
+     * Deserialisation and GPU resource creation must be done on the main
+     * thread, and is done from Update() at the start of each frame, subject
+     * to the budget set by SetAsyncLoadBudget().
+     *
+     * If the asset is already being loaded, the existing request is returned.
+     * If it is already loaded, the returned request is already complete. A
+     * synchronous Load() of the asset while a request is in progress will
+     * complete the request immediately.
+     *
+     * Note that assets referred to by a serialised object are currently
+     * still loaded synchronously when it is deserialised.
+     */
+    AssetLoadRequestPtr     LoadAsync(const Path& path);
+
+    /**
+     * Set a time budget (in nanoseconds) for the main thread work done by
+     * Update() for asynchronous loads each frame. Once exceeded, remaining
+     * work is deferred to the next frame. This is checked between loading
+     * stages, so can be overrun by the time taken for a single stage. The
+     * default of 0 means no limit.
+     */
+    void                    SetAsyncLoadBudget(const uint64_t budget)
+                                { mAsyncLoadBudget = budget; }
+
+    /** Process asynchronous loads. Called once at the start of each frame. */
+    void                    Update(OnlyCalledBy<Engine>);
+
     void                    UnregisterAsset(Asset* const asset,
                                             OnlyCalledBy<Asset>);
 
@@ -76,6 +180,15 @@ public:
     bool                    SaveAsset(Asset* const asset,
                                       const Path&  path);
 
+    /**
+     * Add a file (filesystem path, with extension) that has been written
+     * outside of SaveAsset() to the asset index, so that it can be found by
+     * subsequent loads. Must be called for any asset files created directly,
+     * e.g. by importers, since the index is otherwise only built once for
+     * each directory.
+     */
+    void                    AddIndexedFile(const Path& fsPath);
+
     /**
      * To be used within a DebugWindow, implements an asset selection dialog
      * which can change the asset referred to by a given asset pointer. This
@@ -89,26 +202,94 @@ public:
                                                  const bool       activate);
 
 private:
-    using AssetMap        = std::map<std::string, Asset*>;
+    /** Files found for an asset in the index. */
+    struct AssetFiles
+    {
+        /** Extension of the data file, or empty if there is none. */
+        std::string         dataExtension;
+
+        bool                hasLoader    = false;
+        bool                multipleData = false;
+    };
+
+    using AssetMap        = HashMap<std::string, Asset*>;
     using SearchPathMap   = HashMap<std::string, std::string>;
+    using AsyncLoadMap    = HashMap<std::string, AssetLoadRequestPtr>;
+    using AssetIndex      = HashMap<std::string, AssetFiles>;
 
 private:
     Asset*                  LookupAsset(const Path& path) const;
 
+    void                    AddAsset(Asset* const asset,
+                                     const Path&  path);
+
+    /** Start a job for the current stage of a request, if needed. */
+    void                    StartStage(AssetLoadRequest& request);
+
+    /** Execute the current stage of a request on the calling thread. */
+    void                    ExecuteStage(AssetLoadRequest& request);
+
+    /**
+     * Look up the files for an asset from its filesystem path (without
+     * extension), indexing its directory if not already done. Returns false
+     * if the asset has no files. Thread-safe.
+     */
+    bool                    FindAssetFiles(const Path& fsPath,
+                                           AssetFiles& outFiles);
+    void                    IndexDirectory(const Path& directoryPath);
+    void                    IndexFile(const Path& directoryPath,
+                                      const Path& name);
+
+    bool                    OpenAsset(AssetLoadRequest& request);
+    bool                    DeserialiseAsset(AssetLoadRequest& request);
+    bool                    LoadAsset(AssetLoadRequest& request);
+
 private:
     /**
      * Map of loaded assets. This stores a raw pointer rather than a reference
      * pointer since we don't want to increase the reference count. Assets
      * remove themselves from here when their reference count reaches 0.
-     * 
-     * TODO: Use a more appropriate data structure (radix tree?)
      */
     AssetMap                mAssets;
 
     SearchPathMap           mSearchPaths;
 
+    /**
+     * Index of asset files, keyed by filesystem path without extension. This
+     * is built lazily a directory at a time, on the first lookup of an asset
+     * within each directory, so that finding an asset does not need to scan
+     * its directory every time. Protected by mIndexLock since lookups are
+     * done from jobs for asynchronous loads.
+     */
+    AssetIndex              mAssetIndex;
+    HashSet<std::string>    mIndexedDirectories;
+    std::mutex              mIndexLock;
+
+    /** In-progress asynchronous loads, by path and in request order. */
+    AsyncLoadMap            mAsyncLoads;
+    std::vector<AssetLoadRequestPtr> mAsyncQueue;
+
+    uint64_t                mAsyncLoadBudget;
+
 };
 
+inline bool AssetLoadRequest::IsComplete() const
+{
+    return mJobs.IsComplete() && mStage == kStage_Complete;
+}
+
+inline const AssetPtr& AssetLoadRequest::GetAsset() const
+{
+    Assert(IsComplete());
+    return mAsset;
+}
+
+template <typename T>
+inline ObjPtr<T> AssetLoadRequest::GetAsset() const
+{
+    return object_cast<ObjPtr<T>>(GetAsset());
+}
+
 template <typename T>
 inline ObjPtr<T> AssetManager::Load(const Path& path)
 {
@@ -0,0 +1,1516 @@
+/*
+ * Copyright (C) 2018-2020 Alex Smith
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+/*
+ * File layout:
+ *
+ *   BinaryHeader
+ *   uint64_t objectOffsets[objectCount]
+ *   Objects, each aligned to kBinaryAlignment:
+ *     uint32_t classNameIndex
+ *     uint32_t reserved
+ *     uint64_t contentSize
+ *     Values (contentSize bytes)
+ *   Name table: nameCount NUL-terminated strings
+ *
+ * Each value is a BinaryTag byte, followed by a uint32_t index into the name
+ * table if it is within an object or group (but not an array), followed by
+ * its payload. Groups and arrays have a uint64_t payload size followed by
+ * the values they contain, so that they can be skipped over when searching
+ * for a value. Binary data has a uint64_t length, then padding up to
+ * kBinaryAlignment, then the data itself. Nothing else is aligned.
+ *
+ * The structure of the values is the same as that written by JSONSerialiser,
+ * including object references (see JSONSerialiser::Write()), which allows
+ * ConvertJSON() to be a direct translation. Since JSON does not record the
+ * exact types of values, numeric values are converted on reading where
+ * possible, and vectors can also be read from arrays.
+ */
+
+#include "Engine/BinarySerialiser.h"
+
+#include "Core/Base64.h"
+#include "Core/HashTable.h"
+#include "Core/Utility.h"
+
+#include "Engine/AssetManager.h"
+
+#include <rapidjson/document.h>
+#include <rapidjson/error/en.h>
+
+#include <algorithm>
+#include <limits>
+#include <vector>
+
+static constexpr uint8_t kBinaryMagic[4] = { 'G', 'B', 'I', 'N' };
+static constexpr uint32_t kBinaryVersion = 1;
+
+enum BinaryTag : uint8_t
+{
+    kBinaryTag_Bool,
+    kBinaryTag_Int8,
+    kBinaryTag_UInt8,
+    kBinaryTag_Int16,
+    kBinaryTag_UInt16,
+    kBinaryTag_Int32,
+    kBinaryTag_UInt32,
+    kBinaryTag_Int64,
+    kBinaryTag_UInt64,
+    kBinaryTag_Float,
+    kBinaryTag_Double,
+    kBinaryTag_Vec2,
+    kBinaryTag_Vec3,
+    kBinaryTag_Vec4,
+    kBinaryTag_IVec2,
+    kBinaryTag_IVec3,
+    kBinaryTag_IVec4,
+    kBinaryTag_UVec2,
+    kBinaryTag_UVec3,
+    kBinaryTag_UVec4,
+    kBinaryTag_Quat,
+    kBinaryTag_Enum,
+    kBinaryTag_String,
+    kBinaryTag_Group,
+    kBinaryTag_Array,
+    kBinaryTag_Binary,
+
+    kBinaryTagCount
+};
+
+/** Payload sizes of fixed size values, 0 for variable size values. */
+static constexpr size_t kBinaryTagSizes[kBinaryTagCount] =
+{
+    1, 1, 1, 2, 2, 4, 4, 8, 8, 4, 8,
+    8, 12, 16, 8, 12, 16, 8, 12, 16, 16,
+    8,
+    0, 0, 0, 0,
+};
+
+/* Vectors are written directly from memory. */
+static_assert(sizeof(glm::vec3) == 12 && sizeof(glm::ivec3) == 12 && sizeof(glm::uvec3) == 12,
+              "Unexpected vector size");
+
+struct BinaryHeader
+{
+    uint8_t                             magic[4];
+    uint32_t                            version;
+    uint32_t                            objectCount;
+    uint32_t                            nameCount;
+    uint64_t                            namesOffset;
+    uint64_t                            namesSize;
+};
+
+struct BinaryObjectHeader
+{
+    uint32_t                            classNameIndex;
+    uint32_t                            reserved;
+    uint64_t                            contentSize;
+};
+
+/** Details of a value found during deserialisation. */
+struct BinaryValue
+{
+    BinaryTag                           tag;
+    uint32_t                            name;
+
+    /** Offset and length of the payload, excluding any length prefix. */
+    size_t                              payload;
+    size_t                              length;
+
+    /** Offset of the following value. */
+    size_t                              end;
+};
+
+class BinaryScope
+{
+public:
+    enum Type
+    {
+        kObject,
+        kGroup,
+        kArray,
+    };
+
+public:
+                                        BinaryScope(const Type inType);
+
+public:
+    Type                                type;
+
+    /**
+     * Object buffer being written to, and offset of the size to fill in at
+     * the end of the scope (serialising).
+     */
+    uint32_t                            buffer;
+    size_t                              sizeOffset;
+
+    /**
+     * Range of the values within the scope, and the next value to look at
+     * (deserialising).
+     */
+    size_t                              start;
+    size_t                              end;
+    size_t                              next;
+
+};
+
+class BinaryState
+{
+public:
+    BinaryScope&                        GetCurrentScope(const char* const name);
+
+    /**
+     * Serialising.
+     */
+
+    uint32_t                            AddName(const std::string& name);
+
+    void                                WriteData(const void* const data,
+                                                  const size_t      size);
+
+    template <typename T>
+    void                                WriteData(const T& value)
+                                            { WriteData(&value, sizeof(value)); }
+
+    void                                BeginValue(const char* const name,
+                                                   const BinaryTag   tag);
+
+    void                                BeginWriteScope(const char* const       name,
+                                                        const BinaryScope::Type type);
+    void                                EndWriteScope(const BinaryScope::Type type);
+
+    /** Begin a new object, to be ended with EndWriteScope(kObject). */
+    void                                BeginObject(const char* const className);
+
+    /** Lay out the final data after all objects are written. */
+    ByteArray                           Finish();
+
+    /**
+     * Deserialising.
+     */
+
+    bool                                Load(const void* const inData,
+                                             const size_t      inSize);
+
+    bool                                ReadData(size_t&      ioOffset,
+                                                 void* const  outData,
+                                                 const size_t size) const;
+
+    template <typename T>
+    bool                                ReadData(size_t& ioOffset,
+                                                 T&      outValue) const
+                                            { return ReadData(ioOffset, &outValue, sizeof(outValue)); }
+
+    bool                                ParseValue(const BinaryScope& scope,
+                                                   size_t             offset,
+                                                   BinaryValue&       outValue) const;
+
+    bool                                FindValue(const char* const name,
+                                                  BinaryValue&      outValue);
+
+    bool                                BeginReadScope(const char* const       name,
+                                                       const BinaryScope::Type type);
+
+    /** Read a numeric value, converting it to the requested type. */
+    template <typename T>
+    bool                                ReadNumber(const BinaryValue& value,
+                                                   T&                 outValue) const;
+
+    /**
+     * Read the components of a vector value, which can either be stored as
+     * the given tag or as an array of numbers.
+     */
+    template <typename T>
+    bool                                ReadComponents(const BinaryValue& value,
+                                                       const BinaryTag    tag,
+                                                       T* const           outValues,
+                                                       const size_t       count) const;
+
+public:
+    bool                                writing;
+
+    /** Serialised data for each object (serialising). */
+    std::vector<std::vector<uint8_t>>   objects;
+
+    /** Map of object addresses to pre-existing IDs (serialising). */
+    HashMap<const Object*, uint32_t>    objectToIDMap;
+
+    /** Map of names to name table indices (serialising). */
+    HashMap<std::string, uint32_t>      nameToIndexMap;
+
+    /** Data being deserialised. */
+    const uint8_t*                      data;
+    size_t                              size;
+
+    /** Offsets of objects in the data (deserialising). */
+    std::vector<size_t>                 objectOffsets;
+
+    /** Name table, pointing into the data (deserialising). */
+    std::vector<const char*>            names;
+
+    /** Array of pre-existing objects indexed by ID (deserialising). */
+    std::vector<ObjPtr<>>               idToObject;
+
+    /**
+     * Stack of scopes, see JSONState. References to entries are invalidated
+     * when scopes are added.
+     */
+    std::vector<BinaryScope>            scopes;
+
+};
+
+static BinaryTag LookupTag(const MetaType& type)
+{
+    /* Order must match BinaryTag. */
+    static const MetaType* const kTypes[] =
+    {
+        &MetaType::Lookup<bool>(),
+        &MetaType::Lookup<int8_t>(),
+        &MetaType::Lookup<uint8_t>(),
+        &MetaType::Lookup<int16_t>(),
+        &MetaType::Lookup<uint16_t>(),
+        &MetaType::Lookup<int32_t>(),
+        &MetaType::Lookup<uint32_t>(),
+        &MetaType::Lookup<int64_t>(),
+        &MetaType::Lookup<uint64_t>(),
+        &MetaType::Lookup<float>(),
+        &MetaType::Lookup<double>(),
+        &MetaType::Lookup<glm::vec2>(),
+        &MetaType::Lookup<glm::vec3>(),
+        &MetaType::Lookup<glm::vec4>(),
+        &MetaType::Lookup<glm::ivec2>(),
+        &MetaType::Lookup<glm::ivec3>(),
+        &MetaType::Lookup<glm::ivec4>(),
+        &MetaType::Lookup<glm::uvec2>(),
+        &MetaType::Lookup<glm::uvec3>(),
+        &MetaType::Lookup<glm::uvec4>(),
+        &MetaType::Lookup<glm::quat>(),
+    };
+
+    static_assert(ArraySize(kTypes) == kBinaryTag_Quat + 1, "Type array does not match BinaryTag");
+
+    for (size_t i = 0; i < ArraySize(kTypes); i++)
+    {
+        if (&type == kTypes[i])
+        {
+            return static_cast<BinaryTag>(i);
+        }
+    }
+
+    if (&type == &MetaType::Lookup<std::string>())
+    {
+        return kBinaryTag_String;
+    }
+    else if (type.IsEnum())
+    {
+        return kBinaryTag_Enum;
+    }
+    else
+    {
+        return kBinaryTagCount;
+    }
+}
+
+template <typename T>
+static T ReadPayload(const uint8_t* const payload)
+{
+    T value;
+    memcpy(&value, payload, sizeof(value));
+    return value;
+}
+
+/**
+ * Convert a numeric value to another type. As with JSONSerialiser, integers
+ * can be read as floating point but not vice versa. Integers must be within
+ * the range of the requested type.
+ */
+template <typename T, typename S>
+static bool ConvertNumber(const S source,
+                          T&      outValue)
+{
+    if constexpr (std::is_floating_point<T>::value)
+    {
+        outValue = static_cast<T>(source);
+        return true;
+    }
+    else if constexpr (std::is_floating_point<S>::value)
+    {
+        return false;
+    }
+    else
+    {
+        bool inRange;
+
+        if constexpr (std::is_signed<S>::value)
+        {
+            inRange = (source < 0)
+                          ? std::is_signed<T>::value &&
+                            static_cast<int64_t>(source) >= static_cast<int64_t>(std::numeric_limits<T>::min())
+                          : static_cast<uint64_t>(source) <= static_cast<uint64_t>(std::numeric_limits<T>::max());
+        }
+        else
+        {
+            inRange = static_cast<uint64_t>(source) <= static_cast<uint64_t>(std::numeric_limits<T>::max());
+        }
+
+        if (inRange)
+        {
+            outValue = static_cast<T>(source);
+        }
+
+        return inRange;
+    }
+}
+
+BinaryScope::BinaryScope(const Type inType) :
+    type       (inType),
+    buffer     (0),
+    sizeOffset (0),
+    start      (0),
+    end        (0),
+    next       (0)
+{
+}
+
+BinaryScope& BinaryState::GetCurrentScope(const char* const name)
+{
+    BinaryScope& scope = this->scopes.back();
+
+    if (name)
+    {
+        Assert(scope.type != BinaryScope::kArray);
+    }
+    else
+    {
+        Assert(scope.type == BinaryScope::kArray);
+    }
+
+    return scope;
+}
+
+uint32_t BinaryState::AddName(const std::string& name)
+{
+    auto ret = this->nameToIndexMap.try_emplace(name, this->nameToIndexMap.size());
+    return ret.first->second;
+}
+
+void BinaryState::WriteData(const void* const data,
+                            const size_t      size)
+{
+    std::vector<uint8_t>& buffer = this->objects[this->scopes.back().buffer];
+    const uint8_t* const bytes   = reinterpret_cast<const uint8_t*>(data);
+
+    buffer.insert(buffer.end(), bytes, bytes + size);
+}
+
+void BinaryState::BeginValue(const char* const name,
+                             const BinaryTag   tag)
+{
+    const BinaryScope& scope = GetCurrentScope(name);
+
+    WriteData(tag);
+
+    if (scope.type != BinaryScope::kArray)
+    {
+        WriteData(AddName(name));
+    }
+}
+
+void BinaryState::BeginWriteScope(const char* const       name,
+                                  const BinaryScope::Type type)
+{
+    BeginValue(name, (type == BinaryScope::kArray) ? kBinaryTag_Array : kBinaryTag_Group);
+
+    BinaryScope scope(type);
+    scope.buffer     = this->scopes.back().buffer;
+    scope.sizeOffset = this->objects[scope.buffer].size();
+
+    /* Filled in by EndWriteScope(). */
+    WriteData<uint64_t>(0);
+
+    this->scopes.emplace_back(scope);
+}
+
+void BinaryState::EndWriteScope(const BinaryScope::Type type)
+{
+    const BinaryScope& scope = this->scopes.back();
+    Assert(scope.type == type);
+
+    std::vector<uint8_t>& buffer = this->objects[scope.buffer];
+    const uint64_t size          = buffer.size() - scope.sizeOffset - sizeof(uint64_t);
+
+    memcpy(&buffer[scope.sizeOffset], &size, sizeof(size));
+
+    this->scopes.pop_back();
+}
+
+void BinaryState::BeginObject(const char* const className)
+{
+    /* Each object is written into its own buffer, since objects can be added
+     * while in the middle of writing another. The content size is filled in
+     * by EndWriteScope(). */
+    BinaryScope scope(BinaryScope::kObject);
+    scope.buffer     = this->objects.size();
+    scope.sizeOffset = offsetof(BinaryObjectHeader, contentSize);
+
+    this->objects.emplace_back();
+    this->scopes.emplace_back(scope);
+
+    BinaryObjectHeader header;
+    header.classNameIndex = AddName(className);
+    header.reserved       = 0;
+    header.contentSize    = 0;
+
+    WriteData(header);
+}
+
+ByteArray BinaryState::Finish()
+{
+    BinaryHeader header;
+    memcpy(header.magic, kBinaryMagic, sizeof(kBinaryMagic));
+    header.version     = kBinaryVersion;
+    header.objectCount = this->objects.size();
+    header.nameCount   = this->nameToIndexMap.size();
+
+    std::vector<uint64_t> objectOffsets(header.objectCount);
+
+    size_t offset = sizeof(header) + (header.objectCount * sizeof(uint64_t));
+
+    for (uint32_t i = 0; i < header.objectCount; i++)
+    {
+        offset           = RoundUpPow2(offset, BinarySerialiser::kBinaryAlignment);
+        objectOffsets[i] = offset;
+        offset          += this->objects[i].size();
+    }
+
+    std::vector<const std::string*> nameTable(header.nameCount);
+
+    header.namesOffset = offset;
+    header.namesSize   = 0;
+
+    for (const auto& name : this->nameToIndexMap)
+    {
+        nameTable[name.second] = &name.first;
+        header.namesSize      += name.first.size() + 1;
+    }
+
+    /* Write it out. Zero it first to clear padding. */
+    ByteArray outData(header.namesOffset + header.namesSize);
+    memset(outData.Get(), 0, outData.GetSize());
+
+    memcpy(outData.Get(), &header, sizeof(header));
+    memcpy(outData.Get() + sizeof(header), objectOffsets.data(), header.objectCount * sizeof(uint64_t));
+
+    for (uint32_t i = 0; i < header.objectCount; i++)
+    {
+        memcpy(outData.Get() + objectOffsets[i], this->objects[i].data(), this->objects[i].size());
+    }
+
+    offset = header.namesOffset;
+
+    for (const std::string* name : nameTable)
+    {
+        memcpy(outData.Get() + offset, name->c_str(), name->size() + 1);
+        offset += name->size() + 1;
+    }
+
+    return outData;
+}
+
+bool BinaryState::Load(const void* const inData,
+                       const size_t      inSize)
+{
+    this->data = reinterpret_cast<const uint8_t*>(inData);
+    this->size = inSize;
+
+    BinaryHeader header;
+    size_t offset = 0;
+    if (!ReadData(offset, header) || memcmp(header.magic, kBinaryMagic, sizeof(kBinaryMagic)) != 0)
+    {
+        LogError("Serialised data is not in binary format");
+        return false;
+    }
+    else if (header.version != kBinaryVersion)
+    {
+        LogError("Serialised data has unsupported version %u (expected %u)",
+                 header.version,
+                 kBinaryVersion);
+
+        return false;
+    }
+
+    this->objectOffsets.resize(header.objectCount);
+
+    for (uint32_t i = 0; i < header.objectCount; i++)
+    {
+        uint64_t objectOffset;
+        if (!ReadData(offset, objectOffset) || objectOffset > this->size)
+        {
+            LogError("Serialised data has invalid object table");
+            return false;
+        }
+
+        this->objectOffsets[i] = objectOffset;
+    }
+
+    /* Names are used in place, so they must all be terminated within the
+     * name table. */
+    if (header.namesOffset > this->size ||
+        header.namesSize > this->size - header.namesOffset ||
+        (header.namesSize > 0 && this->data[header.namesOffset + header.namesSize - 1] != 0))
+    {
+        LogError("Serialised data has invalid name table");
+        return false;
+    }
+
+    this->names.reserve(header.nameCount);
+
+    const char* name     = reinterpret_cast<const char*>(&this->data[header.namesOffset]);
+    const char* namesEnd = name + header.namesSize;
+
+    while (name < namesEnd)
+    {
+        this->names.emplace_back(name);
+        name += strlen(name) + 1;
+    }
+
+    if (this->names.size() != header.nameCount)
+    {
+        LogError("Serialised data has invalid name table");
+        return false;
+    }
+
+    return true;
+}
+
+bool BinaryState::ReadData(size_t&      ioOffset,
+                           void* const  outData,
+                           const size_t size) const
+{
+    if (ioOffset > this->size || size > this->size - ioOffset)
+    {
+        return false;
+    }
+
+    memcpy(outData, &this->data[ioOffset], size);
+    ioOffset += size;
+    return true;
+}
+
+bool BinaryState::ParseValue(const BinaryScope& scope,
+                             size_t             offset,
+                             BinaryValue&       outValue) const
+{
+    bool success = ReadData(offset, outValue.tag) && outValue.tag < kBinaryTagCount;
+
+    outValue.name = 0;
+    if (success && scope.type != BinaryScope::kArray)
+    {
+        success = ReadData(offset, outValue.name) && outValue.name < this->names.size();
+    }
+
+    if (success)
+    {
+        switch (outValue.tag)
+        {
+            case kBinaryTag_String:
+            {
+                uint32_t length;
+                success         = ReadData(offset, length);
+                outValue.length = length;
+                break;
+            }
+
+            case kBinaryTag_Group:
+            case kBinaryTag_Array:
+            {
+                uint64_t length;
+                success         = ReadData(offset, length);
+                outValue.length = length;
+                break;
+            }
+
+            case kBinaryTag_Binary:
+            {
+                uint64_t length;
+                success         = ReadData(offset, length);
+                outValue.length = length;
+                offset          = RoundUpPow2(offset, BinarySerialiser::kBinaryAlignment);
+                break;
+            }
+
+            default:
+            {
+                outValue.length = kBinaryTagSizes[outValue.tag];
+                break;
+            }
+        }
+    }
+
+    if (!success || offset > scope.end || outValue.length > scope.end - offset)
+    {
+        LogError("Serialised data is corrupt (at %zu)", offset);
+        return false;
+    }
+
+    outValue.payload = offset;
+    outValue.end     = offset + outValue.length;
+    return true;
+}
+
+bool BinaryState::FindValue(const char* const name,
+                            BinaryValue&      outValue)
+{
+    BinaryScope& scope = GetCurrentScope(name);
+
+    if (scope.type == BinaryScope::kArray)
+    {
+        if (scope.next >= scope.end || !ParseValue(scope, scope.next, outValue))
+        {
+            return false;
+        }
+
+        scope.next = outValue.end;
+        return true;
+    }
+
+    /* Values are usually read in the same order that they were written, so
+     * search from after the last value found, then wrap around to the start
+     * of the scope. */
+    size_t offset  = scope.next;
+    size_t limit   = scope.end;
+    bool   wrapped = false;
+
+    while (true)
+    {
+        if (offset >= limit)
+        {
+            if (wrapped || scope.next == scope.start)
+            {
+                return false;
+            }
+
+            offset  = scope.start;
+            limit   = scope.next;
+            wrapped = true;
+            continue;
+        }
+
+        if (!ParseValue(scope, offset, outValue))
+        {
+            return false;
+        }
+        else if (strcmp(this->names[outValue.name], name) == 0)
+        {
+            scope.next = outValue.end;
+            return true;
+        }
+
+        offset = outValue.end;
+    }
+}
+
+bool BinaryState::BeginReadScope(const char* const       name,
+                                 const BinaryScope::Type type)
+{
+    const BinaryTag tag = (type == BinaryScope::kArray) ? kBinaryTag_Array : kBinaryTag_Group;
+
+    BinaryValue value;
+    if (!FindValue(name, value) || value.tag != tag)
+    {
+        return false;
+    }
+
+    BinaryScope scope(type);
+    scope.start = value.payload;
+    scope.end   = value.end;
+    scope.next  = value.payload;
+
+    this->scopes.emplace_back(scope);
+    return true;
+}
+
+template <typename T>
+bool BinaryState::ReadNumber(const BinaryValue& value,
+                             T&                 outValue) const
+{
+    const uint8_t* const payload = &this->data[value.payload];
+
+    switch (value.tag)
+    {
+        case kBinaryTag_Int8:   return ConvertNumber(ReadPayload<int8_t>(payload), outValue);
+        case kBinaryTag_UInt8:  return ConvertNumber(ReadPayload<uint8_t>(payload), outValue);
+        case kBinaryTag_Int16:  return ConvertNumber(ReadPayload<int16_t>(payload), outValue);
+        case kBinaryTag_UInt16: return ConvertNumber(ReadPayload<uint16_t>(payload), outValue);
+        case kBinaryTag_Int32:  return ConvertNumber(ReadPayload<int32_t>(payload), outValue);
+        case kBinaryTag_UInt32: return ConvertNumber(ReadPayload<uint32_t>(payload), outValue);
+        case kBinaryTag_Int64:  return ConvertNumber(ReadPayload<int64_t>(payload), outValue);
+        case kBinaryTag_UInt64: return ConvertNumber(ReadPayload<uint64_t>(payload), outValue);
+        case kBinaryTag_Float:  return ConvertNumber(ReadPayload<float>(payload), outValue);
+        case kBinaryTag_Double: return ConvertNumber(ReadPayload<double>(payload), outValue);
+
+        default:
+            return false;
+    }
+}
+
+template <typename T>
+bool BinaryState::ReadComponents(const BinaryValue& value,
+                                 const BinaryTag    tag,
+                                 T* const           outValues,
+                                 const size_t       count) const
+{
+    if (value.tag == tag)
+    {
+        memcpy(outValues, &this->data[value.payload], count * sizeof(T));
+        return true;
+    }
+    else if (value.tag == kBinaryTag_Array)
+    {
+        BinaryScope scope(BinaryScope::kArray);
+        scope.start = value.payload;
+        scope.end   = value.end;
+        scope.next  = value.payload;
+
+        for (size_t i = 0; i < count; i++)
+        {
+            BinaryValue element;
+            if (scope.next >= scope.end ||
+                !ParseValue(scope, scope.next, element) ||
+                !ReadNumber(element, outValues[i]))
+            {
+                return false;
+            }
+
+            scope.next = element.end;
+        }
+
+        return scope.next == scope.end;
+    }
+    else
+    {
+        return false;
+    }
+}
+
+BinarySerialiser::BinarySerialiser() :
+    mState (nullptr)
+{
+}
+
+bool BinarySerialiser::IsBinaryData(const void* const data,
+                                    const size_t      size)
+{
+    return size >= sizeof(BinaryHeader) &&
+           memcmp(data, kBinaryMagic, sizeof(kBinaryMagic)) == 0;
+}
+
+ByteArray BinarySerialiser::Serialise(const Object* const object)
+{
+    BinaryState state;
+
+    mState          = &state;
+    mState->writing = true;
+
+    /* Serialise the object. */
+    AddObject(object);
+
+    ByteArray data = mState->Finish();
+
+    mState = nullptr;
+    return data;
+}
+
+uint32_t BinarySerialiser::AddObject(const Object* const object)
+{
+    const uint32_t id = mState->objects.size();
+
+    /* Record it in the object map so we don't serialise it again. */
+    mState->objectToIDMap.insert(std::make_pair(object, id));
+
+    /* Serialise the object in a new scope. */
+    mState->BeginObject(object->GetMetaClass().GetName());
+    SerialiseObject(object);
+    mState->EndWriteScope(BinaryScope::kObject);
+
+    return id;
+}
+
+static bool ConvertJSONValue(Serialiser&             serialiser,
+                             const char* const       name,
+                             const rapidjson::Value& value)
+{
+    switch (value.GetType())
+    {
+        case rapidjson::kFalseType:
+        case rapidjson::kTrueType:
+        {
+            serialiser.Write(name, value.GetBool());
+            return true;
+        }
+
+        case rapidjson::kNumberType:
+        {
+            /* Use the smallest type which holds the value. Reading will
+             * convert it to the correct type. */
+            if (value.IsInt())
+            {
+                serialiser.Write(name, static_cast<int32_t>(value.GetInt()));
+            }
+            else if (value.IsUint())
+            {
+                serialiser.Write(name, static_cast<uint32_t>(value.GetUint()));
+            }
+            else if (value.IsInt64())
+            {
+                serialiser.Write(name, static_cast<int64_t>(value.GetInt64()));
+            }
+            else if (value.IsUint64())
+            {
+                serialiser.Write(name, static_cast<uint64_t>(value.GetUint64()));
+            }
+            else if (value.IsLosslessFloat())
+            {
+                serialiser.Write(name, value.GetFloat());
+            }
+            else
+            {
+                serialiser.Write(name, value.GetDouble());
+            }
+
+            return true;
+        }
+
+        case rapidjson::kStringType:
+        {
+            serialiser.Write(name, std::string(value.GetString(), value.GetStringLength()));
+            return true;
+        }
+
+        case rapidjson::kArrayType:
+        {
+            serialiser.BeginArray(name);
+
+            for (const rapidjson::Value& element : value.GetArray())
+            {
+                if (!ConvertJSONValue(serialiser, nullptr, element))
+                {
+                    return false;
+                }
+            }
+
+            serialiser.EndArray();
+            return true;
+        }
+
+        case rapidjson::kObjectType:
+        {
+            /* Binary data, see JSONSerialiser::WriteBinary(). */
+            if (value.MemberCount() == 1 && value.HasMember("base64") && value["base64"].IsString())
+            {
+                ByteArray binary;
+                if (!Base64::Decode(value["base64"].GetString(), binary))
+                {
+                    LogError("Serialised data contains invalid base64 data");
+                    return false;
+                }
+
+                serialiser.WriteBinary(name, binary);
+                return true;
+            }
+
+            serialiser.BeginGroup(name);
+
+            for (auto member = value.MemberBegin(); member != value.MemberEnd(); ++member)
+            {
+                if (!ConvertJSONValue(serialiser, member->name.GetString(), member->value))
+                {
+                    return false;
+                }
+            }
+
+            serialiser.EndGroup();
+            return true;
+        }
+
+        default:
+        {
+            LogError("Serialised data contains unexpected null value");
+            return false;
+        }
+    }
+}
+
+ByteArray BinarySerialiser::ConvertJSON(const ByteArray& data)
+{
+    rapidjson::Document document;
+    document.Parse(reinterpret_cast<const char*>(data.Get()), data.GetSize());
+
+    if (document.HasParseError())
+    {
+        LogError("Parse error in serialised data (at %zu): %s",
+                 document.GetErrorOffset(),
+                 rapidjson::GetParseError_En(document.GetParseError()));
+
+        return ByteArray();
+    }
+    else if (!document.IsArray())
+    {
+        LogError("Serialised data is not an array");
+        return ByteArray();
+    }
+
+    BinaryState state;
+
+    mState          = &state;
+    mState->writing = true;
+
+    bool success = true;
+
+    for (rapidjson::SizeType id = 0; id < document.Size() && success; id++)
+    {
+        const rapidjson::Value& value = document[id];
+
+        if (!value.IsObject() || !value.HasMember("objectClass") || !value["objectClass"].IsString())
+        {
+            LogError("Serialised object %u does not have an 'objectClass' value", id);
+            success = false;
+            break;
+        }
+
+        mState->BeginObject(value["objectClass"].GetString());
+
+        for (auto member = value.MemberBegin(); member != value.MemberEnd() && success; ++member)
+        {
+            const char* const name = member->name.GetString();
+
+            /* These are part of the object header. */
+            if (strcmp(name, "objectClass") != 0 && strcmp(name, "objectID") != 0)
+            {
+                success = ConvertJSONValue(*this, name, member->value);
+            }
+        }
+
+        mState->EndWriteScope(BinaryScope::kObject);
+    }
+
+    ByteArray outData;
+
+    if (success)
+    {
+        outData = mState->Finish();
+    }
+
+    mState = nullptr;
+    return outData;
+}
+
+ObjPtr<> BinarySerialiser::Deserialise(const void* const data,
+                                       const size_t      size,
+                                       const MetaClass&  expectedClass)
+{
+    BinaryState state;
+
+    mState          = &state;
+    mState->writing = false;
+
+    ObjPtr<> object;
+
+    if (mState->Load(data, size))
+    {
+        mState->idToObject.resize(mState->objectOffsets.size());
+
+        /* The object to return is the first object in the file. */
+        object = FindObject(0, expectedClass);
+    }
+
+    mState = nullptr;
+    return object;
+}
+
+ObjPtr<> BinarySerialiser::FindObject(const uint32_t   id,
+                                      const MetaClass& metaClass)
+{
+    /* Check if it is already deserialised. */
+    if (id < mState->idToObject.size() && mState->idToObject[id])
+    {
+        return mState->idToObject[id];
+    }
+    else if (id >= mState->objectOffsets.size())
+    {
+        LogError("Invalid serialised object ID %u (only %zu objects available)",
+                 id,
+                 mState->objectOffsets.size());
+
+        return nullptr;
+    }
+
+    size_t offset = mState->objectOffsets[id];
+
+    BinaryObjectHeader header;
+    if (!mState->ReadData(offset, header) ||
+        header.classNameIndex >= mState->names.size() ||
+        header.contentSize > mState->size - offset)
+    {
+        LogError("Serialised object %u is corrupt", id);
+        return nullptr;
+    }
+
+    /* Store the object in our array before deserialising it, see
+     * JSONSerialiser::FindObject(). */
+    ObjPtr<>& object = mState->idToObject[id];
+
+    BinaryScope scope(BinaryScope::kObject);
+    scope.start = offset;
+    scope.end   = offset + header.contentSize;
+    scope.next  = offset;
+
+    mState->scopes.emplace_back(scope);
+
+    const bool success = DeserialiseObject(mState->names[header.classNameIndex],
+                                           metaClass,
+                                           id == 0,
+                                           object);
+
+    mState->scopes.pop_back();
+
+    if (success)
+    {
+        return object;
+    }
+    else
+    {
+        object = nullptr;
+        return nullptr;
+    }
+}
+
+bool BinarySerialiser::BeginGroup(const char* const name)
+{
+    Assert(mState);
+
+    if (mState->writing)
+    {
+        mState->BeginWriteScope(name, BinaryScope::kGroup);
+        return true;
+    }
+    else
+    {
+        return mState->BeginReadScope(name, BinaryScope::kGroup);
+    }
+}
+
+void BinarySerialiser::EndGroup()
+{
+    Assert(mState);
+
+    if (mState->writing)
+    {
+        mState->EndWriteScope(BinaryScope::kGroup);
+    }
+    else
+    {
+        Assert(mState->scopes.back().type == BinaryScope::kGroup);
+        mState->scopes.pop_back();
+    }
+}
+
+bool BinarySerialiser::BeginArray(const char* const name)
+{
+    Assert(mState);
+
+    if (mState->writing)
+    {
+        mState->BeginWriteScope(name, BinaryScope::kArray);
+        return true;
+    }
+    else
+    {
+        return mState->BeginReadScope(name, BinaryScope::kArray);
+    }
+}
+
+void BinarySerialiser::EndArray()
+{
+    Assert(mState);
+
+    if (mState->writing)
+    {
+        mState->EndWriteScope(BinaryScope::kArray);
+    }
+    else
+    {
+        Assert(mState->scopes.back().type == BinaryScope::kArray);
+        mState->scopes.pop_back();
+    }
+}
+
+void BinarySerialiser::Write(const char* const name,
+                             const MetaType&   type,
+                             const void* const value)
+{
+    Assert(mState);
+    Assert(mState->writing);
+
+    if (type.IsPointer() && type.GetPointeeType().IsObject())
+    {
+        /* Same as JSONSerialiser::Write(), see there for details. Referenced
+         * objects are written to their own buffer, so it is fine to add them
+         * while inside the group. */
+        BeginGroup(name);
+
+        const Object* const object = *reinterpret_cast<const Object* const*>(value);
+        if (object)
+        {
+            auto existing = mState->objectToIDMap.find(object);
+
+            const Asset* asset;
+
+            if (existing != mState->objectToIDMap.end())
+            {
+                Serialiser::Write("objectID", existing->second);
+            }
+            else if ((asset = object_cast<const Asset*>(object)) && asset->IsManaged())
+            {
+                Serialiser::Write("asset", asset->GetPath());
+            }
+            else
+            {
+                const uint32_t id = AddObject(object);
+                Serialiser::Write("objectID", id);
+            }
+        }
+
+        EndGroup();
+        return;
+    }
+
+    const BinaryTag tag = LookupTag(type);
+    if (tag == kBinaryTagCount)
+    {
+        Fatal("Type '%s' is unsupported for serialisation", type.GetName());
+    }
+
+    mState->BeginValue(name, tag);
+
+    switch (tag)
+    {
+        case kBinaryTag_Bool:
+        {
+            const uint8_t boolValue = (*reinterpret_cast<const bool*>(value)) ? 1 : 0;
+            mState->WriteData(boolValue);
+            break;
+        }
+
+        case kBinaryTag_Quat:
+        {
+            auto quat = reinterpret_cast<const glm::quat*>(value);
+            const float components[4] = { quat->w, quat->x, quat->y, quat->z };
+            mState->WriteData(components);
+            break;
+        }
+
+        case kBinaryTag_Enum:
+        {
+            int64_t intValue;
+
+            switch (type.GetSize())
+            {
+                case 1: intValue = static_cast<int64_t>(*reinterpret_cast<const int8_t* >(value)); break;
+                case 2: intValue = static_cast<int64_t>(*reinterpret_cast<const int16_t*>(value)); break;
+                case 4: intValue = static_cast<int64_t>(*reinterpret_cast<const int32_t*>(value)); break;
+                case 8: intValue = static_cast<int64_t>(*reinterpret_cast<const int64_t*>(value)); break;
+
+                default:
+                    Unreachable();
+            }
+
+            mState->WriteData(intValue);
+            break;
+        }
+
+        case kBinaryTag_String:
+        {
+            auto str = reinterpret_cast<const std::string*>(value);
+            mState->WriteData<uint32_t>(str->size());
+            mState->WriteData(str->data(), str->size());
+            break;
+        }
+
+        default:
+        {
+            mState->WriteData(value, kBinaryTagSizes[tag]);
+            break;
+        }
+    }
+}
+
+bool BinarySerialiser::Read(const char* const name,
+                            const MetaType&   type,
+                            void* const       outValue)
+{
+    Assert(mState);
+    Assert(!mState->writing);
+
+    if (type.IsPointer() && type.GetPointeeType().IsObject())
+    {
+        /* See JSONSerialiser::Read(). */
+        if (!BeginGroup(name))
+        {
+            return false;
+        }
+
+        /* An empty group indicates a null reference. */
+        if (mState->scopes.back().start == mState->scopes.back().end)
+        {
+            if (type.IsRefcounted())
+            {
+                *reinterpret_cast<ObjPtr<>*>(outValue) = nullptr;
+            }
+            else
+            {
+                *reinterpret_cast<Object**>(outValue) = nullptr;
+            }
+
+            EndGroup();
+            return true;
+        }
+
+        auto& metaClass = static_cast<const MetaClass&>(type.GetPointeeType());
+
+        ObjPtr<> ret;
+
+        std::string path;
+        if (Serialiser::Read("asset", path))
+        {
+            ret = AssetManager::Get().Load(path);
+            if (ret && !metaClass.IsBaseOf(ret->GetMetaClass()))
+            {
+                LogError("Class mismatch in serialised data (expected '%s', have '%s')",
+                         metaClass.GetName(),
+                         ret->GetMetaClass().GetName());
+
+                ret.Reset();
+            }
+        }
+        else
+        {
+            uint32_t id;
+            if (Serialiser::Read("objectID", id))
+            {
+                ret = FindObject(id, metaClass);
+            }
+        }
+
+        EndGroup();
+
+        if (ret)
+        {
+            if (type.IsRefcounted())
+            {
+                *reinterpret_cast<ObjPtr<>*>(outValue) = std::move(ret);
+            }
+            else
+            {
+                *reinterpret_cast<Object**>(outValue) = ret;
+            }
+
+            return true;
+        }
+        else
+        {
+            return false;
+        }
+    }
+
+    const BinaryTag tag = LookupTag(type);
+    if (tag == kBinaryTagCount)
+    {
+        Fatal("Type '%s' is unsupported for deserialisation", type.GetName());
+    }
+
+    BinaryValue value;
+    if (!mState->FindValue(name, value))
+    {
+        return false;
+    }
+
+    const uint8_t* const payload = &mState->data[value.payload];
+
+    switch (tag)
+    {
+        case kBinaryTag_Bool:
+        {
+            if (value.tag != kBinaryTag_Bool)
+            {
+                return false;
+            }
+
+            *reinterpret_cast<bool*>(outValue) = payload[0] != 0;
+            return true;
+        }
+
+        case kBinaryTag_Int8:   return mState->ReadNumber(value, *reinterpret_cast<int8_t*  >(outValue));
+        case kBinaryTag_UInt8:  return mState->ReadNumber(value, *reinterpret_cast<uint8_t* >(outValue));
+        case kBinaryTag_Int16:  return mState->ReadNumber(value, *reinterpret_cast<int16_t* >(outValue));
+        case kBinaryTag_UInt16: return mState->ReadNumber(value, *reinterpret_cast<uint16_t*>(outValue));
+        case kBinaryTag_Int32:  return mState->ReadNumber(value, *reinterpret_cast<int32_t* >(outValue));
+        case kBinaryTag_UInt32: return mState->ReadNumber(value, *reinterpret_cast<uint32_t*>(outValue));
+        case kBinaryTag_Int64:  return mState->ReadNumber(value, *reinterpret_cast<int64_t* >(outValue));
+        case kBinaryTag_UInt64: return mState->ReadNumber(value, *reinterpret_cast<uint64_t*>(outValue));
+        case kBinaryTag_Float:  return mState->ReadNumber(value, *reinterpret_cast<float*   >(outValue));
+        case kBinaryTag_Double: return mState->ReadNumber(value, *reinterpret_cast<double*  >(outValue));
+
+        case kBinaryTag_Vec2:
+        case kBinaryTag_Vec3:
+        case kBinaryTag_Vec4:
+        {
+            return mState->ReadComponents(value,
+                                          tag,
+                                          reinterpret_cast<float*>(outValue),
+                                          kBinaryTagSizes[tag] / sizeof(float));
+        }
+
+        case kBinaryTag_IVec2:
+        case kBinaryTag_IVec3:
+        case kBinaryTag_IVec4:
+        {
+            return mState->ReadComponents(value,
+                                          tag,
+                                          reinterpret_cast<int32_t*>(outValue),
+                                          kBinaryTagSizes[tag] / sizeof(int32_t));
+        }
+
+        case kBinaryTag_UVec2:
+        case kBinaryTag_UVec3:
+        case kBinaryTag_UVec4:
+        {
+            return mState->ReadComponents(value,
+                                          tag,
+                                          reinterpret_cast<uint32_t*>(outValue),
+                                          kBinaryTagSizes[tag] / sizeof(uint32_t));
+        }
+
+        case kBinaryTag_Quat:
+        {
+            float components[4];
+            if (!mState->ReadComponents(value, tag, components, 4))
+            {
+                return false;
+            }
+
+            *reinterpret_cast<glm::quat*>(outValue) = glm::quat(components[0],
+                                                                components[1],
+                                                                components[2],
+                                                                components[3]);
+            return true;
+        }
+
+        case kBinaryTag_Enum:
+        {
+            /* Enums are written by value, but converted from JSON as the
+             * constant name. Either way it must match a constant. */
+            const MetaType::EnumConstantArray& constants = type.GetEnumConstants();
+            auto constant = constants.end();
+
+            if (value.tag == kBinaryTag_Enum)
+            {
+                const int64_t intValue = ReadPayload<int64_t>(payload);
+
+                constant = std::find_if(constants.begin(),
+                                        constants.end(),
+                                        [intValue] (const MetaType::EnumConstant& c) { return c.second == intValue; });
+            }
+            else if (value.tag == kBinaryTag_String)
+            {
+                const std::string string(reinterpret_cast<const char*>(payload), value.length);
+
+                constant = std::find_if(constants.begin(),
+                                        constants.end(),
+                                        [&string] (const MetaType::EnumConstant& c) { return string == c.first; });
+            }
+
+            if (constant == constants.end())
+            {
+                return false;
+            }
+
+            switch (type.GetSize())
+            {
+                case 1: *reinterpret_cast<int8_t* >(outValue) = static_cast<int8_t >(constant->second); break;
+                case 2: *reinterpret_cast<int16_t*>(outValue) = static_cast<int16_t>(constant->second); break;
+                case 4: *reinterpret_cast<int32_t*>(outValue) = static_cast<int32_t>(constant->second); break;
+                case 8: *reinterpret_cast<int64_t*>(outValue) = static_cast<int64_t>(constant->second); break;
+
+                default:
+                    Unreachable();
+            }
+
+            return true;
+        }
+
+        case kBinaryTag_String:
+        {
+            if (value.tag != kBinaryTag_String)
+            {
+                return false;
+            }
+
+            reinterpret_cast<std::string*>(outValue)->assign(reinterpret_cast<const char*>(payload), value.length);
+            return true;
+        }
+
+        default:
+        {
+            Unreachable();
+        }
+    }
+}
+
+void BinarySerialiser::WriteBinary(const char* const name,
+                                   const void* const data,
+                                   const size_t      length)
+{
+    Assert(mState);
+    Assert(mState->writing);
+
+    mState->BeginValue(name, kBinaryTag_Binary);
+    mState->WriteData<uint64_t>(length);
+
+    /* Object buffers are placed at aligned offsets in the file, so aligning
+     * within the buffer gives alignment within the file. */
+    std::vector<uint8_t>& buffer = mState->objects[mState->scopes.back().buffer];
+    buffer.resize(RoundUpPow2(buffer.size(), kBinaryAlignment), 0);
+
+    mState->WriteData(data, length);
+}
+
+bool BinarySerialiser::ReadBinary(const char* const name,
+                                  ByteArray&        outData)
+{
+    Assert(mState);
+    Assert(!mState->writing);
+
+    BinaryValue value;
+    if (!mState->FindValue(name, value) || value.tag != kBinaryTag_Binary)
+    {
+        return false;
+    }
+
+    outData = ByteArray(value.length);
+    memcpy(outData.Get(), &mState->data[value.payload], value.length);
+    return true;
+}
@@ -0,0 +1,97 @@
+/*
+ * Copyright (C) 2018-2020 Alex Smith
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#pragma once
+
+#include "Engine/Serialiser.h"
+
+class BinaryState;
+
+/**
+ * Serialiser implementing a compact binary format. This is intended for
+ * cooked/shipping data rather than for editing: unlike JSON it is not human
+ * readable, but it requires no parsing or intermediate DOM to deserialise,
+ * and binary data is stored raw rather than base64 encoded. Binary data is
+ * aligned to kBinaryAlignment within the file so that it can be used in
+ * place.
+ *
+ * Values are stored in native byte order. The structure of the data matches
+ * that of JSONSerialiser, and data serialised by it can be converted to this
+ * format with ConvertJSON().
+ */
+class BinarySerialiser final : public Serialiser
+{
+public:
+    static constexpr size_t     kBinaryAlignment = 16;
+
+public:
+                                BinarySerialiser();
+
+public:
+    /** Check whether some data is in the format written by this serialiser. */
+    static bool                 IsBinaryData(const void* const data,
+                                             const size_t      size);
+
+    ByteArray                   Serialise(const Object* const object) override;
+
+    ObjPtr<>                    Deserialise(const void* const data,
+                                            const size_t      size,
+                                            const MetaClass&  expectedClass) override;
+
+    using Serialiser::Deserialise;
+
+    /**
+     * Convert data serialised by JSONSerialiser to the binary format, without
+     * deserialising it. This allows conversion where the objects cannot be
+     * created, e.g. during asset cooking, since many assets require a GPU
+     * device. Returns an empty array on failure.
+     */
+    ByteArray                   ConvertJSON(const ByteArray& data);
+
+    bool                        BeginGroup(const char* const name) override;
+    void                        EndGroup() override;
+
+    bool                        BeginArray(const char* const name) override;
+    void                        EndArray() override;
+
+    void                        WriteBinary(const char* const name,
+                                            const void* const data,
+                                            const size_t      length) override;
+
+    bool                        ReadBinary(const char* const name,
+                                           ByteArray&        outData) override;
+
+protected:
+    void                        Write(const char* const name,
+                                      const MetaType&   type,
+                                      const void* const value) override;
+
+    bool                        Read(const char* const name,
+                                     const MetaType&   type,
+                                     void* const       outValue) override;
+
+private:
+    uint32_t                    AddObject(const Object* const object);
+
+    ObjPtr<>                    FindObject(const uint32_t   id,
+                                           const MetaClass& metaClass);
+
+private:
+    /* Internal state. Stored in a separate structure to keep the format
+     * details out of the public header. */
+    BinaryState*                mState;
+
+};
@@ -17,6 +17,7 @@
 #include "Engine/DebugManager.h"
 
 #include "Engine/DebugWindow.h"
+#include "Engine/FrameAllocator.h"
 #include "Engine/ImGUI.h"
 #include "Engine/Window.h"
 
@@ -321,8 +322,8 @@ void DebugManager::RenderPrimitives(const RenderView&     view,
         DebugPrimitiveConstants constants;
         constants.colour = glm::vec4(FLT_MAX, FLT_MAX, FLT_MAX, FLT_MAX);
 
-        std::vector<glm::vec3> vertices;
-        std::vector<uint16_t> indices;
+        FrameVector<glm::vec3> vertices;
+        FrameVector<uint16_t> indices;
 
         for (const Primitive& primitive : mPrimitives)
         {
@@ -17,6 +17,7 @@
 #include "Engine/Engine.h"
 
 #include "Core/Filesystem.h"
+#include "Core/JobSystem.h"
 #include "Core/String.h"
 #include "Core/Thread.h"
 #include "Core/Time.h"
@@ -27,6 +28,7 @@
 #include "Engine/FrameAllocator.h"
 #include "Engine/Game.h"
 #include "Engine/ImGUI.h"
+#include "Engine/JobSystemWindow.h"
 #include "Engine/Profiler.h"
 #include "Engine/Window.h"
 
@@ -63,6 +65,9 @@ Engine::Engine() :
 
     LogInfo("Hello, World!");
 
+    new JobSystem();
+    FrameAllocator::Init({});
+
     /* Find the game class and get the engine configuration from it. */
     const MetaClass* gameClass = nullptr;
     MetaClass::Visit(
@@ -126,6 +131,8 @@ Engine::Engine() :
     new ImGUIManager();
     new DebugManager();
 
+    mJobSystemWindow.reset(new JobSystemWindow);
+
     #if GEMINI_PROFILER
         Profiler::Get().WindowInit({});
     #endif
@@ -182,6 +189,8 @@ void Engine::InitSettings()
     }
 
     SetPaused(mSettings->startPaused);
+
+    JobSystem::Get().SetSerial(mSettings->serialJobs);
 }
 
 void Engine::Run()
@@ -228,6 +237,9 @@ void Engine::Run()
             }
         }
 
+        /* Complete any asynchronous asset loads which are ready. */
+        AssetManager::Get().Update({});
+
         ImGUIManager::Get().BeginFrame({});
 
         auto& debugManager = DebugManager::Get();
@@ -241,6 +253,10 @@ void Engine::Run()
             mWorld->Tick(mDeltaTime);
         }
 
+        /* Apply all transformation changes made during the tick (or by the
+         * editor if paused) before rendering. */
+        mWorld->UpdateTransforms();
+
         RenderManager::Get().Render({});
 
         /* Render ImGUI as late as possible in the frame. What we render will
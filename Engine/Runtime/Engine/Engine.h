@@ -22,6 +22,7 @@
 #include "Engine/Object.h"
 
 class EngineSettings;
+class JobSystemWindow;
 class World;
 
 /**
@@ -91,4 +92,6 @@ private:
 
     ObjPtr<World>           mWorld;
 
+    UPtr<JobSystemWindow>   mJobSystemWindow;
+
 };
@@ -19,6 +19,7 @@
 EngineSettings::EngineSettings() :
     profilerWebServer       (false),
     startPaused             (false),
+    serialJobs              (false),
     mMainWindowSize         (1600, 900),
     mMainWindowFullscreen   (false)
 {
@@ -44,6 +44,12 @@ public:
     /** Whether to pause at startup. */
     PROPERTY() bool         startPaused;
 
+    /**
+     * Whether to execute jobs serially on the submitting thread, for
+     * debugging. See JobSystem.
+     */
+    PROPERTY() bool         serialJobs;
+
 private:
                             ~EngineSettings();
 
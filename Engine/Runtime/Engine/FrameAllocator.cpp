@@ -16,6 +16,43 @@
 
 #include "Engine/FrameAllocator.h"
 
-static const size_t kFrameAllocatorSize = 16 * 1024 * 1024;
+/** Size of the blocks allocated by each arena. */
+static const size_t kFrameAllocatorBlockSize = 2 * 1024 * 1024;
 
-LinearAllocator FrameAllocator::mAllocator(kFrameAllocatorSize);
+LinearAllocator                     FrameAllocator::mSharedAllocator(kFrameAllocatorBlockSize);
+std::vector<UPtr<LinearAllocator>>  FrameAllocator::mThreadAllocators;
+
+#if GEMINI_BUILD_DEBUG
+std::atomic<uint32_t>               FrameAllocator::mOutstandingDeletions(0);
+#endif
+
+void FrameAllocator::Init(OnlyCalledBy<Engine>)
+{
+    Assert(mThreadAllocators.empty());
+
+    const uint32_t threadCount = JobSystem::Get().GetThreadCount();
+
+    mThreadAllocators.reserve(threadCount);
+
+    for (uint32_t i = 0; i < threadCount; i++)
+    {
+        mThreadAllocators.emplace_back(new LinearAllocator(kFrameAllocatorBlockSize));
+    }
+}
+
+void FrameAllocator::EndFrame(OnlyCalledBy<Engine>)
+{
+    #if GEMINI_BUILD_DEBUG
+        if (mOutstandingDeletions.load(std::memory_order_relaxed))
+        {
+            Fatal("FrameAllocator still has undeleted allocations at end of frame");
+        }
+    #endif
+
+    mSharedAllocator.Reset();
+
+    for (UPtr<LinearAllocator>& allocator : mThreadAllocators)
+    {
+        allocator->Reset();
+    }
+}
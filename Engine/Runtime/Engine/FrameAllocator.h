@@ -16,9 +16,13 @@
 
 #pragma once
 
+#include "Core/HashTable.h"
+#include "Core/JobSystem.h"
 #include "Core/LinearAllocator.h"
 #include "Core/Utility.h"
 
+#include <vector>
+
 class Engine;
 
 /**
@@ -26,6 +30,12 @@ class Engine;
  * with it will only last until the end of the current frame, after which the
  * allocator will be reset and the memory reused for the next frame.
  *
+ * Each JobSystem thread allocates from its own arena, so allocations do not
+ * contend between threads. Threads outside of the job system share a single
+ * arena. Memory allocated on one thread can be freely used (and Delete()'d)
+ * on another within the same frame. All arenas are reset together at the end
+ * of the frame, and grow as necessary (see LinearAllocator).
+ *
  * Allocations of plain memory or trivially destructible types can be done with
  * the Allocate() methods. These allocations do not need to be explicitly freed,
  * and will be automatically freed at end of frame.
@@ -54,48 +64,135 @@ public:
     template <typename T>
     static void                 Delete(T* const object);
 
+    /**
+     * Create per-thread arenas for the JobSystem's threads. Until this is
+     * called, all allocations are made from the shared arena.
+     */
+    static void                 Init(OnlyCalledBy<Engine>);
+
     static void                 EndFrame(OnlyCalledBy<Engine>);
 
 private:
                                 FrameAllocator() {}
                                 ~FrameAllocator() {}
 
+    static LinearAllocator&     GetAllocator();
+
 private:
-    static LinearAllocator      mAllocator;
+    static LinearAllocator      mSharedAllocator;
+    static std::vector<UPtr<LinearAllocator>>
+                                mThreadAllocators;
+
+    /**
+     * Outstanding New() allocations are tracked here rather than by the
+     * individual arenas, since an object can be deleted by a different thread
+     * to the one that allocated it.
+     */
+    #if GEMINI_BUILD_DEBUG
+    static std::atomic<uint32_t> mOutstandingDeletions;
+    #endif
 
 };
 
+inline LinearAllocator& FrameAllocator::GetAllocator()
+{
+    /* kInvalidThreadIndex is always out of range here. */
+    const uint32_t index = JobSystem::GetCurrentThreadIndex();
+
+    return (index < mThreadAllocators.size())
+               ? *mThreadAllocators[index]
+               : mSharedAllocator;
+}
+
 inline void* FrameAllocator::Allocate(const size_t size,
                                       const size_t alignment)
 {
-    return mAllocator.Allocate(size, alignment);
+    return GetAllocator().Allocate(size, alignment);
 }
 
 template <typename T, typename... Args>
 inline T* FrameAllocator::Allocate(Args&&... args)
 {
-    return mAllocator.Allocate<T>(std::forward<Args>(args)...);
+    return GetAllocator().Allocate<T>(std::forward<Args>(args)...);
 }
 
 template <typename T>
 inline T* FrameAllocator::AllocateArray(const uint32_t count)
 {
-    return mAllocator.AllocateArray<T>(count);
+    return GetAllocator().AllocateArray<T>(count);
 }
 
 template <typename T, typename... Args>
 inline T* FrameAllocator::New(Args&&... args)
 {
-    return mAllocator.New<T>(std::forward<Args>(args)...);
+    static_assert(!std::is_array<T>::value,
+                  "T must not be an array type");
+    static_assert(!std::is_trivially_destructible<T>::value,
+                  "T must not be trivially destructible - use Allocate() instead");
+
+    #if GEMINI_BUILD_DEBUG
+        mOutstandingDeletions.fetch_add(1, std::memory_order_relaxed);
+    #endif
+
+    void* const allocation = GetAllocator().Allocate(sizeof(T), alignof(T));
+
+    return new (allocation) T(std::forward<Args>(args)...);
 }
 
 template <typename T>
 inline void FrameAllocator::Delete(T* const object)
 {
-    mAllocator.Delete<T>(object);
+    object->~T();
+
+    #if GEMINI_BUILD_DEBUG
+        mOutstandingDeletions.fetch_sub(1, std::memory_order_relaxed);
+    #endif
 }
 
-inline void FrameAllocator::EndFrame(OnlyCalledBy<Engine>)
+/**
+ * STL allocator which allocates from the FrameAllocator. Deallocation does
+ * nothing, memory is freed at the end of the frame. Containers using this
+ * must therefore be destroyed before the end of the frame they were created
+ * in. Intended for temporary containers on hot paths (e.g. rendering), where
+ * general purpose heap allocation would be costly.
+ *
+ * Note that growing a container leaves its old storage unused until the end
+ * of the frame, so where the size is known up front, reserve it.
+ */
+template <typename T>
+class FrameStlAllocator
 {
-    mAllocator.Reset();
+public:
+    using value_type = T;
+
+                                FrameStlAllocator() {}
+
+    template <typename U>
+                                FrameStlAllocator(const FrameStlAllocator<U>&) {}
+
+    T*                          allocate(const size_t count);
+    void                        deallocate(T* const pointer, const size_t count) {}
+
+    template <typename U>
+    bool                        operator==(const FrameStlAllocator<U>&) const
+                                    { return true; }
+
+    template <typename U>
+    bool                        operator!=(const FrameStlAllocator<U>&) const
+                                    { return false; }
+
+};
+
+template <typename T>
+inline T* FrameStlAllocator<T>::allocate(const size_t count)
+{
+    return reinterpret_cast<T*>(FrameAllocator::Allocate(sizeof(T) * count, alignof(T)));
 }
+
+/** Container aliases using FrameStlAllocator, see that for details. */
+
+template <typename T>
+using FrameVector = std::vector<T, FrameStlAllocator<T>>;
+
+template <typename Key, typename Value>
+using FrameHashMap = HashMap<Key, Value, FrameStlAllocator<std::pair<const Key, Value>>>;
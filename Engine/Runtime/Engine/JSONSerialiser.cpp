@@ -26,6 +26,7 @@
 #include <rapidjson/stringbuffer.h>
 
 #include <list>
+#include <vector>
 
 class JSONScope
 {
@@ -70,8 +71,12 @@ public:
     /** Map of object addresses to pre-existing IDs (serialising). */
     HashMap<const Object*, uint32_t>    objectToIDMap;
 
-    /** Map of IDs to pre-existing objects (deserialising). */
-    HashMap<uint32_t, ObjPtr<>>         idToObjectMap;
+    /**
+     * Array of pre-existing objects indexed by ID (deserialising). IDs are
+     * indices into the document array, so this is sized to match that up
+     * front, and never resized during deserialisation.
+     */
+    std::vector<ObjPtr<>>               idToObject;
 
     /**
      * This is used to keep track of which value we are currently reading from
@@ -243,8 +248,9 @@ uint32_t JSONSerialiser::AddObject(const Object* const object)
     return id;
 }
 
-ObjPtr<> JSONSerialiser::Deserialise(const ByteArray& data,
-                                     const MetaClass& expectedClass)
+ObjPtr<> JSONSerialiser::Deserialise(const void* const data,
+                                     const size_t      size,
+                                     const MetaClass&  expectedClass)
 {
     JSONState state;
 
@@ -252,7 +258,7 @@ ObjPtr<> JSONSerialiser::Deserialise(const ByteArray& data,
     mState->writing = false;
 
     /* Parse the JSON stream. */
-    mState->document.Parse(reinterpret_cast<const char*>(data.Get()), data.GetSize());
+    mState->document.Parse(reinterpret_cast<const char*>(data), size);
 
     if (mState->document.HasParseError())
     {
@@ -263,6 +269,11 @@ ObjPtr<> JSONSerialiser::Deserialise(const ByteArray& data,
         return nullptr;
     }
 
+    if (mState->document.IsArray())
+    {
+        mState->idToObject.resize(mState->document.Size());
+    }
+
     /* The object to return is the first object in the file. */
     ObjPtr<> object = FindObject(0, expectedClass);
 
@@ -274,10 +285,9 @@ ObjPtr<> JSONSerialiser::FindObject(const uint32_t   id,
                                     const MetaClass& metaClass)
 {
     /* Check if it is already deserialised. */
-    auto existing = mState->idToObjectMap.find(id);
-    if (existing != mState->idToObjectMap.end())
+    if (id < mState->idToObject.size() && mState->idToObject[id])
     {
-        return existing->second;
+        return mState->idToObject[id];
     }
 
     if (!mState->document.IsArray())
@@ -304,30 +314,29 @@ ObjPtr<> JSONSerialiser::FindObject(const uint32_t   id,
 
     /* The serialised object or any objects it refers to may contain references
      * back to itself. Therefore, to ensure that we don't deserialise the object
-     * multiple times, we must store it in our map before we call its
+     * multiple times, we must store it in our array before we call its
      * Deserialise() method. Serialiser::DeserialiseObject() sets the object
      * pointer referred to as soon it has constructed the object, before calling
      * Deserialise(). This ensures that deserialised references to the object
      * will point to the correct object. */
-    auto inserted = mState->idToObjectMap.insert(std::make_pair(id, nullptr));
-    Assert(inserted.second);
+    ObjPtr<>& object = mState->idToObject[id];
 
     mState->scopes.emplace_back(JSONScope::kObject, value);
 
     const bool success = DeserialiseObject(value["objectClass"].GetString(),
                                            metaClass,
                                            id == 0,
-                                           inserted.first->second);
+                                           object);
 
     mState->scopes.pop_back();
 
     if (success)
     {
-        return inserted.first->second;
+        return object;
     }
     else
     {
-        mState->idToObjectMap.erase(inserted.first);
+        object = nullptr;
         return nullptr;
     }
 }
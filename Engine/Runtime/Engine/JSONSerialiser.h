@@ -28,8 +28,9 @@ public:
 public:
     ByteArray                   Serialise(const Object* const object) override;
 
-    ObjPtr<>                    Deserialise(const ByteArray& data,
-                                            const MetaClass& expectedClass) override;
+    ObjPtr<>                    Deserialise(const void* const data,
+                                            const size_t      size,
+                                            const MetaClass&  expectedClass) override;
 
     using Serialiser::Deserialise;
 
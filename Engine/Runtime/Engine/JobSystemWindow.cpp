@@ -0,0 +1,197 @@
+/*
+ * Copyright (C) 2018-2020 Alex Smith
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#include "Engine/JobSystemWindow.h"
+
+#include "Core/JobSystem.h"
+#include "Core/Math/BoundingBox.h"
+#include "Core/Parallel.h"
+#include "Core/Time.h"
+
+#include "Engine/Engine.h"
+
+#include "Entity/Entity.h"
+#include "Entity/World.h"
+
+/** Grain sizes to compare in the benchmark. */
+static constexpr size_t kBenchmarkGrainSizes[] = { 1, 4, 16, 64, 256, 1024 };
+
+/** Number of iterations to run for each grain size. */
+static constexpr uint32_t kBenchmarkIterations = 50;
+
+static void CollectEntities(const Entity* const        entity,
+                            std::vector<const Entity*>& outEntities)
+{
+    outEntities.emplace_back(entity);
+
+    for (const Entity* child : entity->GetChildren())
+    {
+        if (child->GetActiveInWorld())
+        {
+            CollectEntities(child, outEntities);
+        }
+    }
+}
+
+/**
+ * Per-entity work done by the benchmark. This is roughly representative of
+ * what we do per-entity when culling: transform a bounding box into world
+ * space.
+ */
+static inline void BenchmarkWork(const Entity* const entity,
+                                 BoundingBox&        outBox)
+{
+    static const BoundingBox kUnitBox(glm::vec3(-1.0f), glm::vec3(1.0f));
+
+    outBox = kUnitBox.Transform(entity->GetWorldTransform());
+}
+
+static double ToMilliseconds(const uint64_t time)
+{
+    return static_cast<double>(time) / static_cast<double>(kNanosecondsPerMillisecond);
+}
+
+JobSystemWindow::JobSystemWindow() :
+    DebugWindow             ("Engine", "Job System"),
+    mBenchmarkEntityCount   (0),
+    mBenchmarkBaseline      (0.0)
+{
+}
+
+void JobSystemWindow::Render()
+{
+    ImGui::SetNextWindowPos(ImVec2(10, 550), ImGuiCond_Once);
+
+    if (!Begin(ImGuiWindowFlags_AlwaysAutoResize))
+    {
+        return;
+    }
+
+    ImGui::Text("Threads: %u", JobSystem::Get().GetThreadCount());
+
+    /* Serial mode can only be changed while no jobs are outstanding, which is
+     * the case when the overlay is rendered. */
+    bool serial = JobSystem::Get().IsSerial();
+    if (ImGui::Checkbox("Serial mode", &serial))
+    {
+        JobSystem::Get().SetSerial(serial);
+    }
+
+    ImGui::Separator();
+
+    if (ImGui::Button("Run ParallelFor benchmark"))
+    {
+        RunBenchmark();
+    }
+
+    if (!mBenchmarkResults.empty())
+    {
+        ImGui::Text("Entities: %zu", mBenchmarkEntityCount);
+        ImGui::Text("Baseline (plain loop): %.4f ms", mBenchmarkBaseline);
+
+        ImGui::Columns(4);
+
+        ImGui::Text("Grain");     ImGui::NextColumn();
+        ImGui::Text("Avg (ms)");  ImGui::NextColumn();
+        ImGui::Text("Min (ms)");  ImGui::NextColumn();
+        ImGui::Text("Speedup");   ImGui::NextColumn();
+
+        ImGui::Separator();
+
+        for (const BenchmarkResult& result : mBenchmarkResults)
+        {
+            ImGui::Text("%zu", result.grainSize);                           ImGui::NextColumn();
+            ImGui::Text("%.4f", result.averageTime);                        ImGui::NextColumn();
+            ImGui::Text("%.4f", result.minimumTime);                        ImGui::NextColumn();
+            ImGui::Text("%.2fx", mBenchmarkBaseline / result.averageTime);  ImGui::NextColumn();
+        }
+
+        ImGui::Columns(1);
+    }
+
+    ImGui::End();
+}
+
+void JobSystemWindow::RunBenchmark()
+{
+    std::vector<const Entity*> entities;
+    CollectEntities(Engine::Get().GetWorld()->GetRoot(), entities);
+
+    std::vector<BoundingBox> boxes(entities.size());
+
+    mBenchmarkEntityCount = entities.size();
+    mBenchmarkResults.clear();
+
+    /* Baseline with a plain loop, no job system involvement at all. */
+    {
+        const uint64_t startTime = Platform::GetPerformanceCounter();
+
+        for (uint32_t iteration = 0; iteration < kBenchmarkIterations; iteration++)
+        {
+            for (size_t i = 0; i < entities.size(); i++)
+            {
+                BenchmarkWork(entities[i], boxes[i]);
+            }
+        }
+
+        const uint64_t totalTime = Platform::GetPerformanceCounter() - startTime;
+        mBenchmarkBaseline = ToMilliseconds(totalTime) / kBenchmarkIterations;
+    }
+
+    for (const size_t grainSize : kBenchmarkGrainSizes)
+    {
+        BenchmarkResult& result = mBenchmarkResults.emplace_back();
+        result.grainSize   = grainSize;
+        result.minimumTime = std::numeric_limits<double>::max();
+
+        uint64_t totalTime = 0;
+
+        for (uint32_t iteration = 0; iteration < kBenchmarkIterations; iteration++)
+        {
+            const uint64_t startTime = Platform::GetPerformanceCounter();
+
+            ParallelForRange(
+                entities.size(),
+                grainSize,
+                [&] (const size_t begin, const size_t end)
+                {
+                    for (size_t i = begin; i < end; i++)
+                    {
+                        BenchmarkWork(entities[i], boxes[i]);
+                    }
+                });
+
+            const uint64_t iterationTime = Platform::GetPerformanceCounter() - startTime;
+
+            totalTime         += iterationTime;
+            result.minimumTime = std::min(result.minimumTime, ToMilliseconds(iterationTime));
+        }
+
+        result.averageTime = ToMilliseconds(totalTime) / kBenchmarkIterations;
+    }
+
+    LogInfo("ParallelFor benchmark over %zu entities (baseline %.4f ms):",
+            mBenchmarkEntityCount,
+            mBenchmarkBaseline);
+
+    for (const BenchmarkResult& result : mBenchmarkResults)
+    {
+        LogInfo("  Grain %-5zu: avg %.4f ms, min %.4f ms",
+                result.grainSize,
+                result.averageTime,
+                result.minimumTime);
+    }
+}
@@ -0,0 +1,54 @@
+/*
+ * Copyright (C) 2018-2020 Alex Smith
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#pragma once
+
+#include "Engine/DebugWindow.h"
+
+#include <vector>
+
+/**
+ * Debug overlay window for the job system. Allows switching serial mode on and
+ * off, and contains a microbenchmark for ParallelFor() which runs a per-entity
+ * workload over the current world's entities with a range of grain sizes.
+ */
+class JobSystemWindow : public DebugWindow
+{
+public:
+                            JobSystemWindow();
+
+protected:
+    void                    Render() override;
+
+private:
+    struct BenchmarkResult
+    {
+        size_t              grainSize;
+
+        /** Average/minimum time per iteration, in milliseconds. */
+        double              averageTime;
+        double              minimumTime;
+    };
+
+private:
+    void                    RunBenchmark();
+
+private:
+    size_t                  mBenchmarkEntityCount;
+    double                  mBenchmarkBaseline;
+    std::vector<BenchmarkResult> mBenchmarkResults;
+
+};
@@ -36,7 +36,6 @@
 
 #include "Engine/AssetManager.h"
 #include "Engine/DebugWindow.h"
-#include "Engine/JSONSerialiser.h"
 #include "Engine/Serialiser.h"
 
 #include "Entity/Entity.h"
@@ -455,10 +454,8 @@ ObjPtr<> Object::LoadObject(const Path&      path,
         return nullptr;
     }
 
-    /* TODO: Assumed as JSON for now. When we have binary serialisation this
-     * will need to detect the file type. */
-    JSONSerialiser serialiser;
-    ObjPtr<> object = serialiser.Deserialise(serialisedData, expectedClass);
+    UPtr<Serialiser> serialiser = Serialiser::Create(serialisedData);
+    ObjPtr<> object = serialiser->Deserialise(serialisedData, expectedClass);
     if (!object)
     {
         LogError("Failed to deserialise '%s'", path.GetCString());
@@ -16,6 +16,24 @@
 
 #include "Engine/Serialiser.h"
 
+#include "Engine/BinarySerialiser.h"
+#include "Engine/JSONSerialiser.h"
+
+UPtr<Serialiser> Serialiser::Create(const void* const data,
+                                    const size_t      size)
+{
+    /* Binary data has a header we can identify, anything else is assumed to
+     * be JSON. */
+    if (BinarySerialiser::IsBinaryData(data, size))
+    {
+        return UPtr<Serialiser>(new BinarySerialiser());
+    }
+    else
+    {
+        return UPtr<Serialiser>(new JSONSerialiser());
+    }
+}
+
 void Serialiser::SerialiseObject(const Object* const object)
 {
     /* We are a friend of Object, we can call this. */
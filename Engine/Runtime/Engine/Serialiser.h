@@ -95,6 +95,9 @@ namespace Detail
  *     JSONSerialiser serialiser;
  *     ObjPtr<MyClass> object = serialiser.Deserialise<MyClass>(data);
  *
+ * Where the format of the data is not known, Create() can be used to get a
+ * serialiser that can deserialise it.
+ *
  * Internally, this uses Object::Serialise() and Object::Deserialise() to
  * (de)serialise the data. The base Object implementations of these methods
  * automatically (de)serialise all class properties. If any additional data
@@ -140,17 +143,36 @@ public:
 
     /**
      * Deserialises an object previously serialised in the format implemented
-     * by this serialiser instance. Returns null on failure.
+     * by this serialiser instance. Returns null on failure. The data is used
+     * in place, so can be e.g. a mapped file (see Filesystem::MapFile()), and
+     * need only remain valid for the duration of the call.
      */
-    virtual ObjPtr<>                Deserialise(const ByteArray& data,
-                                                const MetaClass& expectedClass) = 0;
+    virtual ObjPtr<>                Deserialise(const void* const data,
+                                                const size_t      size,
+                                                const MetaClass&  expectedClass) = 0;
+    ObjPtr<>                        Deserialise(const ByteArray& data,
+                                                const MetaClass& expectedClass)
+                                        { return Deserialise(data.Get(), data.GetSize(), expectedClass); }
 
     /**
      * Deserialises an object previously serialised in the format implemented
      * by this serialiser instance. Returns null on failure.
      */
     template <typename T>
-    ObjPtr<T>                       Deserialise(const ByteArray& data);
+    ObjPtr<T>                       Deserialise(const void* const data,
+                                                const size_t      size);
+    template <typename T>
+    ObjPtr<T>                       Deserialise(const ByteArray& data)
+                                        { return Deserialise<T>(data.Get(), data.GetSize()); }
+
+    /**
+     * Creates a serialiser instance which can deserialise the given data,
+     * based on the format of the data.
+     */
+    static UPtr<Serialiser>         Create(const void* const data,
+                                           const size_t      size);
+    static UPtr<Serialiser>         Create(const ByteArray& data)
+                                        { return Create(data.Get(), data.GetSize()); }
 
     /**
      * A function that will be called after construction of the object being
@@ -387,9 +409,10 @@ protected:
 };
 
 template <typename T>
-inline ObjPtr<T> Serialiser::Deserialise(const ByteArray& data)
+inline ObjPtr<T> Serialiser::Deserialise(const void* const data,
+                                         const size_t      size)
 {
-    ObjPtr<> object = Deserialise(data, T::staticMetaClass);
+    ObjPtr<> object = Deserialise(data, size, T::staticMetaClass);
     return object.StaticCast<T>();
 }
 
@@ -18,8 +18,19 @@
 
 #include "Engine/Serialiser.h"
 
+#include "Entity/World.h"
+
 Component::Component() :
-    mActive (false)
+    mActive             (false),
+    mTickGroup          (kTickGroup_None),
+    mTickParallel       (false),
+    mTickIndex          (0),
+    mTickFrameInterval  (1),
+    mTickTimeInterval   (0.0f),
+    mTickDistanceLOD    (false),
+    mTickPhase          (0),
+    mLastTickTime       (0.0),
+    mNextTickTime       (0.0)
 {
 }
 
@@ -29,6 +40,8 @@ Component::~Component()
 
 void Component::Destroy()
 {
+    GetWorld()->CheckParallelTickAccess(nullptr);
+
     SetActive(false);
 
     mEntity->RemoveComponent(this, {});
@@ -59,6 +72,8 @@ void Component::Deserialise(Serialiser& serialiser)
 
 void Component::SetActive(const bool active)
 {
+    GetWorld()->CheckParallelTickAccess(nullptr);
+
     const bool wasActive = GetActiveInWorld();
 
     mActive = active;
@@ -67,14 +82,64 @@ void Component::SetActive(const bool active)
     {
         if (!wasActive && mEntity->GetActiveInWorld())
         {
-            Activated();
+            Activate();
         }
     }
     else
     {
         if (wasActive)
         {
-            Deactivated();
+            Deactivate();
         }
     }
 }
+
+void Component::Activate()
+{
+    if (mTickGroup != kTickGroup_None)
+    {
+        GetWorld()->AddTick(this, {});
+    }
+
+    Activated();
+}
+
+void Component::Deactivate()
+{
+    Deactivated();
+
+    if (mTickGroup != kTickGroup_None)
+    {
+        GetWorld()->RemoveTick(this, {});
+    }
+}
+
+void Component::SetTickGroup(const TickGroup group,
+                             const bool      parallel)
+{
+    AssertMsg(!GetActiveInWorld(),
+              "Cannot change tick group of component '%s' while it is active",
+              GetMetaClass().GetName());
+
+    mTickGroup    = group;
+    mTickParallel = parallel;
+}
+
+void Component::SetTickFrameInterval(const uint32_t frames)
+{
+    Assert(frames > 0);
+
+    mTickFrameInterval = frames;
+}
+
+void Component::SetTickRate(const float rate)
+{
+    Assert(rate >= 0.0f);
+
+    mTickTimeInterval = (rate > 0.0f) ? 1.0f / rate : 0.0f;
+}
+
+void Component::SetTickDistanceLOD(const bool enable)
+{
+    mTickDistanceLOD = enable;
+}
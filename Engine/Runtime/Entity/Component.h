@@ -47,6 +47,13 @@
  *
  * As can be seen, this ensures that the hook functions are called when the
  * component is fully constructed.
+ *
+ * Components are not ticked by default. Those which need Tick() to be called
+ * must set a tick group with SetTickGroup(). While active in the world, they
+ * are then registered in the World's tick list for their class, and ticked
+ * along with all other components of the same class in that group. Classes
+ * can also declare that their ticks only touch their own entity, which
+ * allows them to be ticked in parallel.
  */
 class Component : public Object
 {
@@ -73,6 +80,9 @@ public:
      */
     bool                    GetActiveInWorld() const;
 
+    TickGroup               GetTickGroup() const    { return mTickGroup; }
+    bool                    IsTickParallel() const  { return mTickParallel; }
+
     /**
      * Entity property shortcuts.
      */
@@ -81,10 +91,10 @@ public:
     const glm::vec3&        GetPosition() const         { return mEntity->GetPosition(); }
     const glm::quat&        GetOrientation() const      { return mEntity->GetOrientation(); }
     const glm::vec3&        GetScale() const            { return mEntity->GetScale(); }
-    const Transform&        GetWorldTransform() const   { return mEntity->GetWorldTransform(); }
-    const glm::vec3&        GetWorldPosition() const    { return mEntity->GetWorldPosition(); }
-    const glm::quat&        GetWorldOrientation() const { return mEntity->GetWorldOrientation(); }
-    const glm::vec3&        GetWorldScale() const       { return mEntity->GetWorldScale(); }
+    Transform               GetWorldTransform() const   { return mEntity->GetWorldTransform(); }
+    glm::vec3               GetWorldPosition() const    { return mEntity->GetWorldPosition(); }
+    glm::quat               GetWorldOrientation() const { return mEntity->GetWorldOrientation(); }
+    glm::vec3               GetWorldScale() const       { return mEntity->GetWorldScale(); }
 
 protected:
                             Component();
@@ -100,14 +110,77 @@ protected:
     /** Called when the transformation changes. */
     virtual void            Transformed() {}
 
-    /** Called every frame to update the component. */
+    /**
+     * Set the group that the component is ticked in. Components are only
+     * ticked if this is set to something other than kTickGroup_None (the
+     * default). This should normally be done in the constructor, and cannot
+     * be changed while the component is active in the world.
+     *
+     * If parallel is true, the component declares that its Tick() only
+     * modifies its own entity and the components attached to it. Ticks for
+     * the class are then run across the JobSystem's threads. All components
+     * of a class must use the same value. Parallel ticks must not:
+     *
+     *  - Change the transformation of any entity other than their own.
+     *  - Create, destroy, activate or deactivate entities or components.
+     *
+     * These are checked in debug builds. World transformations seen during
+     * a parallel tick are those from the start of the tick: changes made to
+     * our own entity's transformation are applied after all components of
+     * the class have been ticked.
+     */
+    void                    SetTickGroup(const TickGroup group,
+                                         const bool      parallel = false);
+
+    /**
+     * Tick interval control. By default, components are ticked every frame.
+     * SetTickFrameInterval() ticks only every N frames, and SetTickRate()
+     * ticks at most the given number of times per second (0 for no limit).
+     * World staggers the ticks of components of each class so that they are
+     * spread evenly across frames, so the first tick after activation may be
+     * delayed by up to one interval.
+     *
+     * If distance LOD is enabled, the tick interval is also increased with
+     * distance from the World's tick LOD viewer (see World::SetTickLOD()).
+     *
+     * In all cases, the delta passed to Tick() is the time elapsed since the
+     * previous tick of the component.
+     */
+    void                    SetTickFrameInterval(const uint32_t frames);
+    void                    SetTickRate(const float rate);
+    void                    SetTickDistanceLOD(const bool enable);
+
+    /** Called every frame to update the component, if it has a tick group. */
     virtual void            Tick(const float delta) {}
 
+private:
+    void                    Activate();
+    void                    Deactivate();
+
 private:
     EntityPtr               mEntity;
     bool                    mActive;
+    TickGroup               mTickGroup;
+    bool                    mTickParallel;
+
+    /** Index in World's tick list for our class (while registered). */
+    uint32_t                mTickIndex;
+
+    /** Tick interval settings. */
+    uint32_t                mTickFrameInterval;
+    float                   mTickTimeInterval;
+    bool                    mTickDistanceLOD;
+
+    /**
+     * Tick scheduling state, managed by World. Times are World::GetTime()
+     * values.
+     */
+    uint32_t                mTickPhase;
+    double                  mLastTickTime;
+    double                  mNextTickTime;
 
     friend class Entity;
+    friend class World;
 };
 
 using ComponentPtr = ObjPtr<Component>;
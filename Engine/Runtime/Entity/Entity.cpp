@@ -19,13 +19,19 @@
 #include "Engine/Serialiser.h"
 
 #include "Entity/Component.h"
+#include "Entity/TransformStore.h"
 #include "Entity/World.h"
 
 Entity::Entity() :
-    mWorld          (nullptr),
-    mParent         (nullptr),
-    mActive         (false),
-    mActiveInWorld  (false)
+    mWorld              (nullptr),
+    mParent             (nullptr),
+    mActive             (false),
+    mActiveInWorld      (false),
+    mStatic             (false),
+    mStaticInWorld      (false),
+    mTransformPending   (false),
+    mTransformLevel     (TransformStore::kInvalidIndex),
+    mTransformIndex     (TransformStore::kInvalidIndex)
 {
 }
 
@@ -41,6 +47,8 @@ Entity::~Entity()
 
 void Entity::Destroy()
 {
+    mWorld->CheckParallelTickAccess(nullptr);
+
     SetActive(false);
 
     while (!mChildren.IsEmpty())
@@ -55,6 +63,15 @@ void Entity::Destroy()
         mComponents.back()->Destroy();
     }
 
+    /* World may still have us in its update list, make sure it ignores us. */
+    mTransformPending = false;
+
+    /* Children have been destroyed so have already freed theirs. */
+    if (mTransformIndex != TransformStore::kInvalidIndex)
+    {
+        FreeTransform();
+    }
+
     if (mParent)
     {
         EntityPtr parent(std::move(mParent));
@@ -115,10 +132,11 @@ void Entity::Deserialise(Serialiser& serialiser)
     /* If this is the root entity, we don't deserialise properties. Two reasons:
      * firstly, the root entity's transformation cannot be changed anyway. Due
      * to floating point inaccuracy, deserialising the transformation can
-     * trigger the assertion in UpdateTransform() to ensure that the root is not
-     * transformed. Secondly, we do not want to activate things in the middle of
-     * deserialisation as this will cause problems. We instead delay activation
-     * to the end of deserialisation (in World::Deserialise()). */
+     * trigger the assertion in CalculateWorldTransform() to ensure that the
+     * root is not transformed. Secondly, we do not want to activate things in
+     * the middle of deserialisation as this will cause problems. We instead
+     * delay activation to the end of deserialisation (in
+     * World::Deserialise()). */
     if (mParent)
     {
         Object::Deserialise(serialiser);
@@ -180,6 +198,8 @@ std::string Entity::GetPath()
 
 void Entity::SetActive(const bool active)
 {
+    mWorld->CheckParallelTickAccess(nullptr);
+
     mActive = active;
 
     if (mActive)
@@ -198,11 +218,66 @@ void Entity::SetActive(const bool active)
     }
 }
 
+void Entity::SetStatic(const bool isStatic)
+{
+    AssertMsg(mParent || !isStatic, "Root entity cannot be static");
+
+    if (isStatic == mStatic)
+    {
+        return;
+    }
+
+    /* Components may have done things at activation based on whether we are
+     * static, so deactivate while changing it. */
+    const bool wasActive = GetActiveInWorld();
+    if (wasActive)
+    {
+        Deactivate();
+    }
+
+    mStatic = isStatic;
+
+    UpdateStaticInWorld();
+
+    /* Transformed() calls are skipped while static, so make sure they get
+     * done if we're no longer static. */
+    MarkTransformDirty();
+
+    if (wasActive)
+    {
+        Activate();
+    }
+}
+
+void Entity::UpdateStaticInWorld()
+{
+    mStaticInWorld = mStatic || (mParent && mParent->IsStaticInWorld());
+
+    for (Entity* entity : mChildren)
+    {
+        entity->UpdateStaticInWorld();
+    }
+}
+
 void Entity::Activate()
 {
     Assert(mActive);
     Assert(!mActiveInWorld);
 
+    if (mStaticInWorld)
+    {
+        /* Components of static entities are not notified of changes while
+         * inactive (see MarkTransformDirty()), so let them know about the
+         * final transformation now. This is the only time this is done until
+         * the entity is deactivated. */
+        mTransformPending = false;
+
+        for (Component* component : mComponents)
+        {
+            component->Transformed();
+        }
+    }
+
     mActiveInWorld = true;
 
     /* Order is important: components become activated before child entities
@@ -211,7 +286,7 @@ void Entity::Activate()
     {
         if (component->GetActive())
         {
-            component->Activated();
+            component->Activate();
         }
     }
 
@@ -240,15 +315,19 @@ void Entity::Deactivate()
     {
         if (component->GetActive())
         {
-            component->Deactivated();
+            component->Deactivate();
         }
     }
 
     mActiveInWorld = false;
+
+    mWorld->EntityDeactivated(this, {});
 }
 
 Entity* Entity::CreateChild(std::string name)
 {
+    mWorld->CheckParallelTickAccess(nullptr);
+
     Entity* const entity = new Entity();
     entity->SetName(std::move(name));
     AddChild(entity);
@@ -277,8 +356,18 @@ void Entity::AddChild(Entity* const entity)
 
     mChildren.Append(entity);
 
-    /* Update the cached world transform to incorporate our transformation. */
-    entity->UpdateTransform();
+    entity->UpdateStaticInWorld();
+
+    /* If we are not yet connected to the root (see Deserialise()), we don't
+     * know the child's depth yet. It will get a transform entry once we get
+     * ours. */
+    if (!mParent || mTransformIndex != TransformStore::kInvalidIndex)
+    {
+        entity->AllocateTransform();
+    }
+
+    /* The world transform must be recalculated to incorporate ours. */
+    entity->MarkTransformDirty();
 }
 
 Component* Entity::CreateComponent(const MetaClass& metaClass)
@@ -352,31 +441,248 @@ void Entity::RemoveComponent(Component* const component,
                    component->GetMetaClass().GetName(), mName.c_str());
 }
 
-void Entity::UpdateTransform()
+void Entity::AllocateTransform()
 {
-    glm::vec3 worldPosition    = GetPosition();
-    glm::quat worldOrientation = GetOrientation();
-    glm::vec3 worldScale       = GetScale();
+    Assert(mTransformIndex == TransformStore::kInvalidIndex);
+    Assert(mParent);
 
-    /* Recalculate absolute transformations. We don't allow the root entity to
-     * be transformed so we can skip this for entities at the root. */
-    if (mParent && mParent->mParent)
+    uint32_t parentIndex = TransformStore::kInvalidIndex;
+
+    if (mParent->mParent)
+    {
+        Assert(mParent->mTransformIndex != TransformStore::kInvalidIndex);
+
+        mTransformLevel = mParent->mTransformLevel + 1;
+        parentIndex     = mParent->mTransformIndex;
+    }
+    else
     {
-        glm::vec3 parentPosition    = mParent->GetWorldPosition();
-        glm::quat parentOrientation = mParent->GetWorldOrientation();
-        glm::vec3 parentScale       = mParent->GetWorldScale();
+        mTransformLevel = 0;
+    }
+
+    mTransformIndex = mWorld->GetTransformStore().Allocate(this,
+                                                            mTransformLevel,
+                                                            parentIndex,
+                                                            mTransform);
+
+    for (Entity* entity : mChildren)
+    {
+        entity->AllocateTransform();
+    }
+}
+
+void Entity::FreeTransform()
+{
+    TransformStore& store = mWorld->GetTransformStore();
+
+    /* Another entity's entry may be moved into ours. */
+    Entity* const moved = store.Free(mTransformLevel, mTransformIndex);
+
+    if (moved)
+    {
+        moved->mTransformIndex = mTransformIndex;
 
-        worldPosition    = (parentOrientation * (parentScale * worldPosition)) + parentPosition;
-        worldOrientation = parentOrientation * worldOrientation;
-        worldScale       = parentScale * worldScale;
+        for (Entity* entity : moved->mChildren)
+        {
+            store.SetParent(entity->mTransformLevel, entity->mTransformIndex, mTransformIndex);
+        }
+    }
+
+    mTransformLevel = TransformStore::kInvalidIndex;
+    mTransformIndex = TransformStore::kInvalidIndex;
+}
+
+bool Entity::IsWorldTransformDirty() const
+{
+    /* Without an entry, we always need to calculate from scratch. */
+    return mTransformIndex == TransformStore::kInvalidIndex ||
+           mWorld->GetTransformStore().IsDirty(mTransformLevel, mTransformIndex);
+}
+
+const TransformStore* Entity::ResolveWorldTransform() const
+{
+    if (mTransformIndex != TransformStore::kInvalidIndex)
+    {
+        TransformStore& store = mWorld->GetTransformStore();
+        store.Resolve(mTransformLevel, mTransformIndex);
+        return &store;
+    }
+    else
+    {
+        return nullptr;
+    }
+}
+
+void Entity::CalculateWorldTransform(glm::vec3& outPosition,
+                                     glm::quat& outOrientation,
+                                     glm::vec3& outScale) const
+{
+    outPosition    = GetPosition();
+    outOrientation = GetOrientation();
+    outScale       = GetScale();
+
+    /* Only used for entities without a TransformStore entry. We don't allow
+     * the root entity to be transformed so we can skip this for entities at
+     * the root. */
+    if (mParent && mParent->mParent)
+    {
+        const Transform parentTransform = mParent->GetWorldTransform();
+
+        TransformStore::Concatenate(parentTransform.GetPosition(),
+                                    parentTransform.GetOrientation(),
+                                    parentTransform.GetScale(),
+                                    outPosition,
+                                    outOrientation,
+                                    outScale);
     }
     else if (!mParent)
     {
-        AssertMsg(worldPosition == glm::vec3() && worldOrientation == glm::quat() && worldScale == glm::vec3(),
+        AssertMsg(outPosition == glm::vec3() && outOrientation == glm::quat() && outScale == glm::vec3(),
                   "Cannot transform root entity");
     }
+}
+
+Transform Entity::GetWorldTransform() const
+{
+    if (const TransformStore* const store = ResolveWorldTransform())
+    {
+        return Transform(store->GetPosition(mTransformLevel, mTransformIndex),
+                         store->GetOrientation(mTransformLevel, mTransformIndex),
+                         store->GetScale(mTransformLevel, mTransformIndex),
+                         store->GetMatrix(mTransformLevel, mTransformIndex));
+    }
+    else
+    {
+        glm::vec3 position;
+        glm::quat orientation;
+        glm::vec3 scale;
+        CalculateWorldTransform(position, orientation, scale);
+
+        return Transform(position, orientation, scale);
+    }
+}
+
+glm::vec3 Entity::GetWorldPosition() const
+{
+    if (const TransformStore* const store = ResolveWorldTransform())
+    {
+        return store->GetPosition(mTransformLevel, mTransformIndex);
+    }
+    else
+    {
+        return GetWorldTransform().GetPosition();
+    }
+}
+
+glm::quat Entity::GetWorldOrientation() const
+{
+    if (const TransformStore* const store = ResolveWorldTransform())
+    {
+        return store->GetOrientation(mTransformLevel, mTransformIndex);
+    }
+    else
+    {
+        return GetWorldTransform().GetOrientation();
+    }
+}
+
+glm::vec3 Entity::GetWorldScale() const
+{
+    if (const TransformStore* const store = ResolveWorldTransform())
+    {
+        return store->GetScale(mTransformLevel, mTransformIndex);
+    }
+    else
+    {
+        return GetWorldTransform().GetScale();
+    }
+}
+
+glm::mat4 Entity::GetWorldMatrix() const
+{
+    if (const TransformStore* const store = ResolveWorldTransform())
+    {
+        return store->GetMatrix(mTransformLevel, mTransformIndex);
+    }
+    else
+    {
+        return GetWorldTransform().GetMatrix();
+    }
+}
+
+void Entity::LocalTransformChanged()
+{
+    if (mTransformIndex != TransformStore::kInvalidIndex)
+    {
+        mWorld->GetTransformStore().SetLocal(mTransformLevel, mTransformIndex, mTransform);
+    }
+
+    /* Marking dirty touches our parent and children, which may be being
+     * ticked on other threads, so this must be left until after parallel
+     * ticks. */
+    if (mWorld && mWorld->IsParallelTicking())
+    {
+        mWorld->CheckParallelTickAccess(this);
+        mWorld->DeferTransformChange(this, {});
+    }
+    else
+    {
+        MarkTransformDirty();
+    }
+}
+
+void Entity::MarkTransformDirty()
+{
+    if (mStaticInWorld)
+    {
+        AssertMsg(!mActiveInWorld,
+                  "Cannot transform static entity '%s' while it is active",
+                  mName.c_str());
+
+        /* Components of static entities are notified when they are activated
+         * instead, so we only need to flag the world transform. */
+        if (IsWorldTransformDirty())
+        {
+            return;
+        }
+    }
+    else
+    {
+        /* If this is already set, it is set for all of our children as well. */
+        if (IsWorldTransformDirty() && mTransformPending)
+        {
+            return;
+        }
+
+        if (!mTransformPending)
+        {
+            mTransformPending = true;
+
+            /* If our parent is pending it will update us, otherwise World
+             * needs to. */
+            if (mWorld && !(mParent && mParent->mTransformPending))
+            {
+                mWorld->AddTransformUpdate(this, {});
+            }
+        }
+    }
 
-    mWorldTransform.Set(worldPosition, worldOrientation, worldScale);
+    if (mTransformIndex != TransformStore::kInvalidIndex)
+    {
+        mWorld->GetTransformStore().SetDirty(mTransformLevel, mTransformIndex);
+    }
+
+    for (Entity* entity : mChildren)
+    {
+        entity->MarkTransformDirty();
+    }
+}
+
+void Entity::UpdateTransform()
+{
+    Assert(mTransformPending);
+
+    mTransformPending = false;
 
     /* Let components know about the transformation. */
     for (Component* component : mComponents)
@@ -384,10 +690,22 @@ void Entity::UpdateTransform()
          component->Transformed();
     }
 
-    /* Visit children and recalculate their transformations. */
+    /* Children which are pending were changed along with us. Others have
+     * either been updated already, or are static. */
     for (Entity* entity : mChildren)
     {
-        entity->UpdateTransform();
+        if (entity->mTransformPending)
+        {
+            entity->UpdateTransform();
+        }
+    }
+}
+
+void Entity::FlushTransform()
+{
+    if (mTransformPending)
+    {
+        UpdateTransform();
     }
 }
 
@@ -395,7 +713,7 @@ void Entity::SetTransform(const Transform& transform)
 {
     mTransform = transform;
 
-    UpdateTransform();
+    LocalTransformChanged();
 }
 
 void Entity::SetTransform(const glm::vec3& position,
@@ -404,35 +722,35 @@ void Entity::SetTransform(const glm::vec3& position,
 {
     mTransform.Set(position, orientation, scale);
 
-    UpdateTransform();
+    LocalTransformChanged();
 }
 
 void Entity::SetPosition(const glm::vec3& position)
 {
     mTransform.SetPosition(position);
 
-    UpdateTransform();
+    LocalTransformChanged();
 }
 
 void Entity::SetOrientation(const glm::quat& orientation)
 {
     mTransform.SetOrientation(orientation);
 
-    UpdateTransform();
+    LocalTransformChanged();
 }
 
 void Entity::SetScale(const glm::vec3& scale)
 {
     mTransform.SetScale(scale);
 
-    UpdateTransform();
+    LocalTransformChanged();
 }
 
 void Entity::Translate(const glm::vec3& vector)
 {
     mTransform.SetPosition(mTransform.GetPosition() + vector);
 
-    UpdateTransform();
+    LocalTransformChanged();
 }
 
 void Entity::Rotate(const glm::quat& rotation)
@@ -441,7 +759,7 @@ void Entity::Rotate(const glm::quat& rotation)
      * commutative. */
     mTransform.SetOrientation(rotation * mTransform.GetOrientation());
 
-    UpdateTransform();
+    LocalTransformChanged();
 }
 
 void Entity::Rotate(const Degrees    angle,
@@ -449,28 +767,3 @@ void Entity::Rotate(const Degrees    angle,
 {
     Rotate(glm::angleAxis(glm::radians(angle), glm::normalize(axis)));
 }
-
-void Entity::Tick(const float delta)
-{
-    // FIXME: This does not handle activation/deactivation quite well. When
-    // an entity becomes active in a frame, it should *not* have it's tick
-    // function called in the rest of the frame, otherwise it will get a
-    // meaningless dt value. It shouldn't be called until next frame, where
-    // dt would be time since activation.
-
-    for (Component* component : mComponents)
-    {
-        if (component->GetActive())
-        {
-            component->Tick(delta);
-        }
-    }
-
-    for (Entity* entity : mChildren)
-    {
-        if (entity->GetActive())
-        {
-            entity->Tick(delta);
-        }
-    }
-}
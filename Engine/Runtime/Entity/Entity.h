@@ -24,6 +24,7 @@
 #include "Entity/EntityDefs.h"
 
 class Component;
+class TransformStore;
 class World;
 
 /**
@@ -35,6 +36,13 @@ class World;
  * are defined relative to its parent's transformation. The transformation
  * functions of this class operate on the relative transformation, except where
  * noted.
+ *
+ * Changes to transformations are propagated lazily. Changing an entity's
+ * transformation just flags it and its children as needing their world
+ * transformations recalculated, which is done on demand when they are next
+ * requested. Component::Transformed() callbacks are deferred until World
+ * updates transformations once per frame (see World::UpdateTransforms()), so
+ * an entity moved several times in a frame only has its subtree updated once.
  */
 class Entity final : public Object
 {
@@ -90,6 +98,30 @@ public:
      */
     bool                    GetActiveInWorld() const { return mActiveInWorld; }
 
+    /**
+     * Whether the entity is static. A static entity and all of its children
+     * cannot be moved while they are active in the world. This allows their
+     * world transformations (and anything derived from them, e.g. rendering
+     * bounds) to be calculated once at activation, and then skipped by
+     * anything which handles moving entities.
+     *
+     * While a static entity is inactive, its transformation can be changed as
+     * normal, but components and children are not notified of the change
+     * until the entity is activated.
+     *
+     * Changing this while the entity is active will deactivate and then
+     * reactivate it.
+     */
+    VPROPERTY(bool, static, "get": "IsStatic", "set": "SetStatic");
+    bool                    IsStatic() const { return mStatic; }
+    void                    SetStatic(const bool isStatic);
+
+    /**
+     * Whether the entity is really static, based on the static property of
+     * this entity and all of its parents.
+     */
+    bool                    IsStaticInWorld() const { return mStaticInWorld; }
+
     Entity*                 CreateChild(std::string name);
 
     Entity*                 FindChild(const std::string& name);
@@ -151,12 +183,23 @@ public:
 
     /**
      * World transformation is the effective transformation in the world based
-     * on parent entities.
+     * on parent entities. This is recalculated on demand if it is out of date.
+     * World transformations are held in the World's TransformStore, so these
+     * return by value.
+     */
+    Transform               GetWorldTransform() const;
+    glm::vec3               GetWorldPosition() const;
+    glm::quat               GetWorldOrientation() const;
+    glm::vec3               GetWorldScale() const;
+    glm::mat4               GetWorldMatrix() const;
+
+    /**
+     * Immediately call Component::Transformed() for this entity and its
+     * children if the transformation has changed, rather than waiting for
+     * World::UpdateTransforms(). This is for callers that need to react to
+     * their own changes straight away.
      */
-    const Transform&        GetWorldTransform() const   { return mWorldTransform; }
-    const glm::vec3&        GetWorldPosition() const    { return mWorldTransform.GetPosition(); }
-    const glm::quat&        GetWorldOrientation() const { return mWorldTransform.GetOrientation(); }
-    const glm::vec3&        GetWorldScale() const       { return mWorldTransform.GetScale(); }
+    void                    FlushTransform();
 
 private:
                             Entity();
@@ -172,9 +215,20 @@ private:
 
     void                    AddComponent(ObjPtr<Component> component);
 
-    void                    UpdateTransform();
+    void                    UpdateStaticInWorld();
+
+    void                    AllocateTransform();
+    void                    FreeTransform();
 
-    void                    Tick(const float delta);
+    bool                    IsWorldTransformDirty() const;
+    const TransformStore*   ResolveWorldTransform() const;
+    void                    CalculateWorldTransform(glm::vec3& outPosition,
+                                                    glm::quat& outOrientation,
+                                                    glm::vec3& outScale) const;
+
+    void                    LocalTransformChanged();
+    void                    MarkTransformDirty();
+    void                    UpdateTransform();
 
 private:
     World*                  mWorld;
@@ -194,6 +248,8 @@ private:
     std::string             mName;
     bool                    mActive;
     bool                    mActiveInWorld;
+    bool                    mStatic;
+    bool                    mStaticInWorld;
 
     /**
      * Array of components. Components reference their parent, and entities
@@ -203,7 +259,23 @@ private:
     ComponentArray          mComponents;
 
     Transform               mTransform;
-    Transform               mWorldTransform;
+
+    /**
+     * Location of our entry in the World's TransformStore, which holds our
+     * world transformation and whether it needs to be recalculated. If an
+     * entity is dirty, then so are all of its children. The root entity does
+     * not have an entry, and neither do entities which have not yet been
+     * connected to the root (during deserialisation).
+     */
+    uint32_t                mTransformLevel;
+    uint32_t                mTransformIndex;
+
+    /**
+     * Whether Transformed() needs to be called on our components. If this is
+     * set then either our parent also has it set, or we are in World's list
+     * of entities to update.
+     */
+    bool                    mTransformPending;
 
     /* World needs to initialise the root entity. */
     friend class World;
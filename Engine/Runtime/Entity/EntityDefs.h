@@ -20,3 +20,27 @@
 
 #define ENTITY_PROFILER_SCOPE(timer)    PROFILER_SCOPE("Entity", timer, 0xff00ff)
 #define ENTITY_PROFILER_FUNC_SCOPE()    PROFILER_FUNC_SCOPE("Entity", 0xff00ff)
+
+/**
+ * Groups that component ticks are run in. Groups are run in the order given
+ * here. See Component::SetTickGroup().
+ */
+enum TickGroup : uint8_t
+{
+    /**
+     * Before the physics simulation. Transformation changes made here are
+     * seen by the simulation.
+     */
+    kTickGroup_PrePhysics,
+
+    /** After the physics simulation. */
+    kTickGroup_PostPhysics,
+
+    /** After all other groups, before rendering. */
+    kTickGroup_PreRender,
+
+    kTickGroupCount,
+
+    /** Component does not need to be ticked. */
+    kTickGroup_None = kTickGroupCount,
+};
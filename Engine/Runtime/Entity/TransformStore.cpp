@@ -0,0 +1,202 @@
+/*
+ * Copyright (C) 2018-2020 Alex Smith
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#include "Entity/TransformStore.h"
+
+#include "Core/Parallel.h"
+
+#include "Entity/EntityDefs.h"
+
+/**
+ * Number of entries per job in Update(). The per-entry work is small, so this
+ * needs to be fairly large to be worth a job.
+ */
+static constexpr size_t kUpdateGrainSize = 2048;
+
+TransformStore::TransformStore() :
+    mAnyDirty   (false)
+{
+}
+
+TransformStore::~TransformStore()
+{
+    for (const Level& level : mLevels)
+    {
+        Assert(level.entities.empty());
+    }
+}
+
+uint32_t TransformStore::Allocate(Entity* const    entity,
+                                  const uint32_t   level,
+                                  const uint32_t   parentIndex,
+                                  const Transform& localTransform)
+{
+    Assert(level <= mLevels.size());
+    Assert(level == 0 || parentIndex < mLevels[level - 1].entities.size());
+
+    if (level == mLevels.size())
+    {
+        mLevels.emplace_back();
+    }
+
+    Level& data = mLevels[level];
+
+    const uint32_t index = data.entities.size();
+
+    data.entities.emplace_back(entity);
+    data.parents.emplace_back((level > 0) ? parentIndex : kInvalidIndex);
+    data.dirty.emplace_back(1);
+    mAnyDirty = true;
+
+    data.localPositions.emplace_back(localTransform.GetPosition());
+    data.localOrientations.emplace_back(localTransform.GetOrientation());
+    data.localScales.emplace_back(localTransform.GetScale());
+
+    data.worldPositions.emplace_back(0.0f);
+    data.worldOrientations.emplace_back(1.0f, 0.0f, 0.0f, 0.0f);
+    data.worldScales.emplace_back(1.0f);
+    data.worldMatrices.emplace_back(1.0f);
+
+    return index;
+}
+
+Entity* TransformStore::Free(const uint32_t level,
+                             const uint32_t index)
+{
+    Level& data = mLevels[level];
+
+    Assert(index < data.entities.size());
+
+    const uint32_t last  = data.entities.size() - 1;
+    Entity* const  moved = (index != last) ? data.entities[last] : nullptr;
+
+    if (moved)
+    {
+        data.entities[index]          = data.entities[last];
+        data.parents[index]           = data.parents[last];
+        data.dirty[index]             = data.dirty[last];
+        data.localPositions[index]    = data.localPositions[last];
+        data.localOrientations[index] = data.localOrientations[last];
+        data.localScales[index]       = data.localScales[last];
+        data.worldPositions[index]    = data.worldPositions[last];
+        data.worldOrientations[index] = data.worldOrientations[last];
+        data.worldScales[index]       = data.worldScales[last];
+        data.worldMatrices[index]     = data.worldMatrices[last];
+    }
+
+    data.entities.pop_back();
+    data.parents.pop_back();
+    data.dirty.pop_back();
+    data.localPositions.pop_back();
+    data.localOrientations.pop_back();
+    data.localScales.pop_back();
+    data.worldPositions.pop_back();
+    data.worldOrientations.pop_back();
+    data.worldScales.pop_back();
+    data.worldMatrices.pop_back();
+
+    return moved;
+}
+
+void TransformStore::SetParent(const uint32_t level,
+                               const uint32_t index,
+                               const uint32_t parentIndex)
+{
+    Assert(level > 0);
+
+    mLevels[level].parents[index] = parentIndex;
+}
+
+void TransformStore::SetLocal(const uint32_t   level,
+                              const uint32_t   index,
+                              const Transform& transform)
+{
+    Level& data = mLevels[level];
+
+    data.localPositions[index]    = transform.GetPosition();
+    data.localOrientations[index] = transform.GetOrientation();
+    data.localScales[index]       = transform.GetScale();
+}
+
+void TransformStore::Calculate(const uint32_t level,
+                               const uint32_t index)
+{
+    Level& data = mLevels[level];
+
+    glm::vec3 position    = data.localPositions[index];
+    glm::quat orientation = data.localOrientations[index];
+    glm::vec3 scale       = data.localScales[index];
+
+    if (level > 0)
+    {
+        const Level& parentData = mLevels[level - 1];
+        const uint32_t parent   = data.parents[index];
+
+        Concatenate(parentData.worldPositions[parent],
+                    parentData.worldOrientations[parent],
+                    parentData.worldScales[parent],
+                    position,
+                    orientation,
+                    scale);
+    }
+
+    /* Equivalent to Transform::UpdateMatrix(), without the full matrix
+     * multiplications. */
+    glm::mat4 matrix = glm::mat4_cast(orientation);
+    matrix[0]       *= scale.x;
+    matrix[1]       *= scale.y;
+    matrix[2]       *= scale.z;
+    matrix[3]        = glm::vec4(position, 1.0f);
+
+    data.worldPositions[index]    = position;
+    data.worldOrientations[index] = orientation;
+    data.worldScales[index]       = scale;
+    data.worldMatrices[index]     = matrix;
+    data.dirty[index]             = 0;
+}
+
+void TransformStore::Update()
+{
+    if (!mAnyDirty)
+    {
+        return;
+    }
+
+    ENTITY_PROFILER_FUNC_SCOPE();
+
+    mAnyDirty = false;
+
+    /* Each level depends only on the previous one, so levels are done in
+     * order, but entries within a level can be done in parallel. */
+    for (uint32_t level = 0; level < mLevels.size(); level++)
+    {
+        const uint8_t* const dirty = mLevels[level].dirty.data();
+
+        ParallelForRange(
+            mLevels[level].entities.size(),
+            kUpdateGrainSize,
+            [&] (const size_t begin, const size_t end)
+            {
+                for (size_t index = begin; index < end; index++)
+                {
+                    if (dirty[index])
+                    {
+                        Calculate(level, index);
+                    }
+                }
+            });
+    }
+}
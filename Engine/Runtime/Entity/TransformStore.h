@@ -0,0 +1,214 @@
+/*
+ * Copyright (C) 2018-2020 Alex Smith
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#pragma once
+
+#include "Core/Math/Transform.h"
+
+#include <limits>
+#include <vector>
+
+class Entity;
+
+/**
+ * Storage for the transformations of all entities in a World, owned by the
+ * World. Entities are grouped into levels by their depth in the hierarchy
+ * (children of the root are level 0), and each level stores its data as a
+ * structure of arrays. An entity refers to its data by its level and its
+ * index within that level, and each entry refers to its parent by index
+ * within the previous level.
+ *
+ * This allows world transformations to be calculated with a linear pass
+ * over each level in turn, with the parents of a level always having been
+ * calculated by the previous pass. Each pass is split across threads.
+ *
+ * Entries are flagged as dirty when their world transformation needs to be
+ * recalculated. Entity ensures that if an entry is dirty then so are all of
+ * its children. Dirty entries can be resolved individually on demand with
+ * Resolve(), otherwise they are all resolved by Update().
+ *
+ * Entity is responsible for keeping the local transformations in here up to
+ * date and for handling entries being moved by Free().
+ */
+class TransformStore : Uncopyable
+{
+public:
+    static constexpr uint32_t   kInvalidIndex = std::numeric_limits<uint32_t>::max();
+
+public:
+                                TransformStore();
+                                ~TransformStore();
+
+    /**
+     * Allocate an entry for an entity at the given level, with the given
+     * parent index in the previous level (ignored for level 0). The entry is
+     * initially dirty.
+     */
+    uint32_t                    Allocate(Entity* const    entity,
+                                         const uint32_t   level,
+                                         const uint32_t   parentIndex,
+                                         const Transform& localTransform);
+
+    /**
+     * Free an entry, which must not have any children. To keep the level
+     * tightly packed, the last entry in the level is moved into the freed
+     * index. The entity owning the moved entry is returned (or null if none
+     * was moved), and the caller must update it and the parent index of its
+     * children accordingly.
+     */
+    Entity*                     Free(const uint32_t level,
+                                     const uint32_t index);
+
+    void                        SetParent(const uint32_t level,
+                                          const uint32_t index,
+                                          const uint32_t parentIndex);
+    void                        SetLocal(const uint32_t   level,
+                                         const uint32_t   index,
+                                         const Transform& transform);
+
+    bool                        IsDirty(const uint32_t level,
+                                        const uint32_t index) const;
+    void                        SetDirty(const uint32_t level,
+                                         const uint32_t index);
+
+    /**
+     * Recalculate the world transformation for an entry if it is dirty,
+     * along with any dirty parents. Not thread-safe.
+     */
+    void                        Resolve(const uint32_t level,
+                                        const uint32_t index);
+
+    /**
+     * Recalculate all dirty entries. Does nothing if nothing has been marked
+     * dirty since the last call.
+     */
+    void                        Update();
+
+    /**
+     * Get world transformation for an entry. Only valid if the entry is not
+     * dirty. References are invalidated by Allocate() and Free().
+     */
+    const glm::vec3&            GetPosition(const uint32_t level,
+                                            const uint32_t index) const;
+    const glm::quat&            GetOrientation(const uint32_t level,
+                                               const uint32_t index) const;
+    const glm::vec3&            GetScale(const uint32_t level,
+                                         const uint32_t index) const;
+    const glm::mat4&            GetMatrix(const uint32_t level,
+                                          const uint32_t index) const;
+
+    /**
+     * Concatenate a local transformation (given in ioPosition, etc.) with a
+     * parent's world transformation.
+     */
+    static void                 Concatenate(const glm::vec3& parentPosition,
+                                            const glm::quat& parentOrientation,
+                                            const glm::vec3& parentScale,
+                                            glm::vec3&       ioPosition,
+                                            glm::quat&       ioOrientation,
+                                            glm::vec3&       ioScale);
+
+private:
+    struct Level
+    {
+        std::vector<Entity*>    entities;
+        std::vector<uint32_t>   parents;
+        std::vector<uint8_t>    dirty;
+
+        std::vector<glm::vec3>  localPositions;
+        std::vector<glm::quat>  localOrientations;
+        std::vector<glm::vec3>  localScales;
+
+        std::vector<glm::vec3>  worldPositions;
+        std::vector<glm::quat>  worldOrientations;
+        std::vector<glm::vec3>  worldScales;
+        std::vector<glm::mat4>  worldMatrices;
+    };
+
+private:
+    void                        Calculate(const uint32_t level,
+                                          const uint32_t index);
+
+private:
+    std::vector<Level>          mLevels;
+
+    /** Whether any entry has been marked dirty since the last Update(). */
+    bool                        mAnyDirty;
+
+};
+
+inline bool TransformStore::IsDirty(const uint32_t level,
+                                    const uint32_t index) const
+{
+    return mLevels[level].dirty[index] != 0;
+}
+
+inline void TransformStore::SetDirty(const uint32_t level,
+                                     const uint32_t index)
+{
+    mLevels[level].dirty[index] = 1;
+    mAnyDirty = true;
+}
+
+inline void TransformStore::Resolve(const uint32_t level,
+                                    const uint32_t index)
+{
+    if (IsDirty(level, index))
+    {
+        if (level > 0)
+        {
+            Resolve(level - 1, mLevels[level].parents[index]);
+        }
+
+        Calculate(level, index);
+    }
+}
+
+inline const glm::vec3& TransformStore::GetPosition(const uint32_t level,
+                                                    const uint32_t index) const
+{
+    return mLevels[level].worldPositions[index];
+}
+
+inline const glm::quat& TransformStore::GetOrientation(const uint32_t level,
+                                                       const uint32_t index) const
+{
+    return mLevels[level].worldOrientations[index];
+}
+
+inline const glm::vec3& TransformStore::GetScale(const uint32_t level,
+                                                 const uint32_t index) const
+{
+    return mLevels[level].worldScales[index];
+}
+
+inline const glm::mat4& TransformStore::GetMatrix(const uint32_t level,
+                                                  const uint32_t index) const
+{
+    return mLevels[level].worldMatrices[index];
+}
+
+inline void TransformStore::Concatenate(const glm::vec3& parentPosition,
+                                        const glm::quat& parentOrientation,
+                                        const glm::vec3& parentScale,
+                                        glm::vec3&       ioPosition,
+                                        glm::quat&       ioOrientation,
+                                        glm::vec3&       ioScale)
+{
+    ioPosition    = (parentOrientation * (parentScale * ioPosition)) + parentPosition;
+    ioOrientation = parentOrientation * ioOrientation;
+    ioScale       = parentScale * ioScale;
+}
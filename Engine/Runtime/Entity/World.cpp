@@ -16,21 +16,47 @@
 
 #include "Entity/World.h"
 
+#include "Core/Parallel.h"
+
 #include "Engine/Serialiser.h"
 
+#include "Entity/Component.h"
 #include "Entity/Entity.h"
+#include "Entity/TransformStore.h"
 #include "Entity/WorldEditorWindow.h"
 
 #include "Physics/PhysicsWorld.h"
 
 #include "Render/RenderWorld.h"
 
+#include <algorithm>
+
 static constexpr char kRootEntityName[] = "Root";
 
+/** Number of components per job for parallel ticks. */
+static constexpr size_t kParallelTickGrainSize = 64;
+
+/**
+ * Used to stagger component ticks. Multiples of this modulo 1 give an even
+ * spread of values in [0, 1) for any number of components.
+ */
+static constexpr double kTickStaggerFraction = 0.6180339887498949;
+
+#if GEMINI_BUILD_DEBUG
+    /** Entity whose component is being ticked on this thread in parallel. */
+    static thread_local const Entity* sParallelTickEntity = nullptr;
+#endif
+
 World::World() :
+    mTransformStore (new TransformStore),
     mRenderWorld    (new RenderWorld),
     mPhysicsWorld   (new PhysicsWorld),
-    mEditorWindow   (new WorldEditorWindow(this))
+    mEditorWindow   (new WorldEditorWindow(this)),
+    mTicking        (false),
+    mParallelTicking(false),
+    mTime           (0.0),
+    mFrameIndex     (0),
+    mTickLODViewer  (nullptr)
 {
     mRoot         = new Entity();
     mRoot->mName  = kRootEntityName;
@@ -82,7 +108,378 @@ void World::Tick(const float delta)
 {
     ENTITY_PROFILER_FUNC_SCOPE();
 
+    mTime += delta;
+    mFrameIndex++;
+
+    RunTickGroup(kTickGroup_PrePhysics);
+
+    /* Make sure the physics world sees any changes made since the last tick. */
+    UpdateTransforms();
+
     mPhysicsWorld->Tick(delta);
 
-    mRoot->Tick(delta);
+    RunTickGroup(kTickGroup_PostPhysics);
+    RunTickGroup(kTickGroup_PreRender);
+}
+
+void World::SetTickLOD(const TickLOD& lod)
+{
+    Assert(lod.nearDistance >= 0.0f && lod.farDistance > lod.nearDistance);
+    Assert(lod.farInterval >= 0.0f);
+
+    mTickLOD = lod;
+}
+
+void World::SetTickLODViewer(Entity* const entity)
+{
+    if (entity)
+    {
+        mTickLODViewer = entity;
+    }
+    else
+    {
+        mTickLODViewer = (!mActiveCameras.empty()) ? mActiveCameras.front() : nullptr;
+    }
+}
+
+void World::AddActiveCamera(Entity* const entity,
+                            OnlyCalledBy<Camera>)
+{
+    mActiveCameras.emplace_back(entity);
+
+    if (!mTickLODViewer)
+    {
+        mTickLODViewer = entity;
+    }
+}
+
+void World::RemoveActiveCamera(Entity* const entity,
+                               OnlyCalledBy<Camera>)
+{
+    auto it = std::find(mActiveCameras.begin(), mActiveCameras.end(), entity);
+    Assert(it != mActiveCameras.end());
+    mActiveCameras.erase(it);
+
+    /* Hand over to another camera. If another camera on the same entity is
+     * still active, this will pick that. */
+    if (mTickLODViewer == entity)
+    {
+        SetTickLODViewer(nullptr);
+    }
+}
+
+void World::EntityDeactivated(Entity* const entity,
+                              OnlyCalledBy<Entity>)
+{
+    /* Cameras on the entity have been deactivated before this, so it can no
+     * longer be picked as the default. */
+    if (mTickLODViewer == entity)
+    {
+        SetTickLODViewer(nullptr);
+    }
+}
+
+float World::CalculateLODInterval(const float distance) const
+{
+    if (distance <= mTickLOD.nearDistance)
+    {
+        return 0.0f;
+    }
+
+    const float t = (distance - mTickLOD.nearDistance) / (mTickLOD.farDistance - mTickLOD.nearDistance);
+    return std::min(t, 1.0f) * mTickLOD.farInterval;
+}
+
+inline bool World::ShouldTick(Component* const       component,
+                              const glm::vec3* const viewerPosition,
+                              float&                 outDelta) const
+{
+    /* Anything registered during this frame's ticks waits until the next
+     * frame, rather than getting a zero delta. */
+    if (component->mLastTickTime >= mTime)
+    {
+        return false;
+    }
+
+    if (component->mTickFrameInterval > 1 &&
+        ((mFrameIndex + component->mTickPhase) % component->mTickFrameInterval) != 0)
+    {
+        return false;
+    }
+
+    if (mTime < component->mNextTickTime)
+    {
+        return false;
+    }
+
+    float interval = component->mTickTimeInterval;
+
+    if (component->mTickDistanceLOD && viewerPosition)
+    {
+        const float distance = glm::distance(component->GetWorldPosition(), *viewerPosition);
+        interval = std::max(interval, CalculateLODInterval(distance));
+    }
+
+    /* Keep to the staggered schedule unless we've fallen behind it. */
+    component->mNextTickTime += interval;
+    if (component->mNextTickTime <= mTime)
+    {
+        component->mNextTickTime = mTime + interval;
+    }
+
+    outDelta = static_cast<float>(mTime - component->mLastTickTime);
+    component->mLastTickTime = mTime;
+
+    return true;
+}
+
+void World::RunTickGroup(const TickGroup group)
+{
+    ENTITY_PROFILER_FUNC_SCOPE();
+
+    TickGroupData& data = mTickGroups[group];
+
+    /* Get the viewer position for tick LOD once up front. */
+    glm::vec3 viewerPosition;
+    const glm::vec3* viewer = nullptr;
+
+    if (mTickLODViewer && mTickLODViewer->GetActiveInWorld())
+    {
+        viewerPosition = mTickLODViewer->GetWorldPosition();
+        viewer         = &viewerPosition;
+    }
+
+    mTicking = true;
+
+    /* Components may be activated or deactivated by ticks. Anything added
+     * during the loop is not ticked until the next frame, since it would get
+     * a meaningless delta, so only go up to the initial counts. Lists may be
+     * reallocated, so don't hold references to them. */
+    const size_t listCount = data.lists.size();
+
+    for (size_t listIndex = 0; listIndex < listCount; listIndex++)
+    {
+        if (data.lists[listIndex].parallel)
+        {
+            RunParallelTicks(data.lists[listIndex], viewer);
+            continue;
+        }
+
+        const size_t count = data.lists[listIndex].components.size();
+
+        for (size_t i = 0; i < count; i++)
+        {
+            Component* const component = data.lists[listIndex].components[i];
+            float delta;
+
+            if (component && ShouldTick(component, viewer, delta))
+            {
+                component->Tick(delta);
+            }
+        }
+    }
+
+    mTicking = false;
+
+    /* Components removed during the ticks of this group could be in any
+     * group's lists. Compact them all now, since RemoveTick() relies on
+     * lists not containing null entries outside of ticking. */
+    for (TickGroupData& groupData : mTickGroups)
+    {
+        for (TickList& list : groupData.lists)
+        {
+            if (list.needsCompact)
+            {
+                size_t count = 0;
+
+                for (Component* const component : list.components)
+                {
+                    if (component)
+                    {
+                        component->mTickIndex    = count;
+                        list.components[count++] = component;
+                    }
+                }
+
+                list.components.resize(count);
+                list.needsCompact = false;
+            }
+        }
+    }
+}
+
+void World::UpdateTransforms()
+{
+    ENTITY_PROFILER_FUNC_SCOPE();
+
+    mTransformStore->Update();
+
+    /* Transformed() callbacks could move other entities and add them to the
+     * list, so don't use iterators here. */
+    for (size_t i = 0; i < mTransformUpdates.size(); i++)
+    {
+        mTransformUpdates[i]->FlushTransform();
+    }
+
+    mTransformUpdates.clear();
+}
+
+void World::AddTransformUpdate(Entity* const entity,
+                               OnlyCalledBy<Entity>)
+{
+    mTransformUpdates.emplace_back(entity);
+}
+
+void World::RunParallelTicks(TickList&              list,
+                             const glm::vec3* const viewerPosition)
+{
+    ENTITY_PROFILER_FUNC_SCOPE();
+
+    /* Parallel ticks can read world transformations of any entity, make sure
+     * they're all up to date so that there are no writes from resolving them
+     * on demand. Nothing can be marked dirty while parallel ticking. */
+    mTransformStore->Update();
+
+    mDeferredTransformChanges.resize(JobSystem::Get().GetThreadCount());
+
+    mParallelTicking = true;
+
+    ParallelForRange(
+        list.components.size(),
+        kParallelTickGrainSize,
+        [&] (const size_t begin, const size_t end)
+        {
+            for (size_t i = begin; i < end; i++)
+            {
+                Component* const component = list.components[i];
+                float delta;
+
+                if (component && ShouldTick(component, viewerPosition, delta))
+                {
+                    #if GEMINI_BUILD_DEBUG
+                        sParallelTickEntity = component->GetEntity();
+                    #endif
+
+                    component->Tick(delta);
+                }
+            }
+
+            #if GEMINI_BUILD_DEBUG
+                sParallelTickEntity = nullptr;
+            #endif
+        });
+
+    mParallelTicking = false;
+
+    /* Now propagate transformation changes. */
+    for (std::vector<Entity*>& entities : mDeferredTransformChanges)
+    {
+        for (Entity* const entity : entities)
+        {
+            entity->MarkTransformDirty();
+        }
+
+        entities.clear();
+    }
+}
+
+void World::DeferTransformChange(Entity* const entity,
+                                 OnlyCalledBy<Entity>)
+{
+    Assert(mParallelTicking);
+
+    const uint32_t threadIndex = JobSystem::GetCurrentThreadIndex();
+    mDeferredTransformChanges[threadIndex].emplace_back(entity);
+}
+
+#if GEMINI_BUILD_DEBUG
+
+void World::CheckParallelTickAccess(const Entity* const entity) const
+{
+    if (mParallelTicking)
+    {
+        if (entity)
+        {
+            AssertMsg(entity == sParallelTickEntity,
+                      "Entity '%s' accessed from parallel tick of another entity",
+                      entity->GetName().c_str());
+        }
+        else
+        {
+            Fatal("Operation is not permitted during parallel ticks");
+        }
+    }
+}
+
+#endif
+
+void World::AddTick(Component* const component,
+                    OnlyCalledBy<Component>)
+{
+    Assert(component->GetTickGroup() < kTickGroupCount);
+    Assert(!mParallelTicking);
+
+    TickGroupData& data = mTickGroups[component->GetTickGroup()];
+
+    const MetaClass* const metaClass = &component->GetMetaClass();
+
+    auto it = data.listIndices.find(metaClass);
+    if (it == data.listIndices.end())
+    {
+        it = data.listIndices.emplace(metaClass, data.lists.size()).first;
+        data.lists.emplace_back().parallel = component->IsTickParallel();
+    }
+
+    TickList& list = data.lists[it->second];
+
+    AssertMsg(list.parallel == component->IsTickParallel(),
+              "All components of class '%s' must have the same tick parallelism",
+              metaClass->GetName());
+
+    component->mTickIndex = list.components.size();
+    list.components.emplace_back(component);
+
+    /* Stagger the first tick across the interval. Distance LOD can increase
+     * the interval up to farInterval, so include that. */
+    float interval = component->mTickTimeInterval;
+    if (component->mTickDistanceLOD)
+    {
+        interval = std::max(interval, mTickLOD.farInterval);
+    }
+
+    const double stagger = std::fmod(list.staggerCount * kTickStaggerFraction, 1.0);
+
+    component->mTickPhase    = list.staggerCount++;
+    component->mLastTickTime = mTime;
+    component->mNextTickTime = mTime + (stagger * interval);
+}
+
+void World::RemoveTick(Component* const component,
+                       OnlyCalledBy<Component>)
+{
+    Assert(!mParallelTicking);
+
+    TickGroupData& data = mTickGroups[component->GetTickGroup()];
+
+    auto it = data.listIndices.find(&component->GetMetaClass());
+    Assert(it != data.listIndices.end());
+
+    TickList& list = data.lists[it->second];
+
+    Assert(list.components[component->mTickIndex] == component);
+
+    if (mTicking)
+    {
+        /* Don't disturb the order while iterating over the list. */
+        list.components[component->mTickIndex] = nullptr;
+        list.needsCompact = true;
+    }
+    else
+    {
+        Component* const last = list.components.back();
+
+        last->mTickIndex = component->mTickIndex;
+        list.components[component->mTickIndex] = last;
+        list.components.pop_back();
+    }
 }
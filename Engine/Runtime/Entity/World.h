@@ -16,13 +16,19 @@
 
 #pragma once
 
+#include "Core/HashTable.h"
+#include "Core/Math.h"
+
 #include "Engine/Asset.h"
 
 #include "Entity/EntityDefs.h"
 
+class Camera;
+class Component;
 class Entity;
 class RenderWorld;
 class PhysicsWorld;
+class TransformStore;
 class WorldEditorWindow;
 
 /**
@@ -31,11 +37,31 @@ class WorldEditorWindow;
  * system) hold their own views of the world in addition to this. Adding
  * entities to these systems is handled automatically when they are activated
  * in the world.
+ *
+ * Components which need to be ticked are registered in tick lists when they
+ * are activated. There is a list per component class in each tick group, so
+ * that ticking is a linear loop over each list, and components which do not
+ * tick are not visited at all. Lists for classes which declare that they can
+ * be ticked in parallel are split across the JobSystem's threads.
  */
 class World final : public Asset
 {
     CLASS();
 
+public:
+    /**
+     * Settings for distance-based tick LOD (see
+     * Component::SetTickDistanceLOD()). Components within nearDistance of
+     * the viewer tick at their normal rate. Beyond that, their tick interval
+     * is increased linearly up to farInterval (in seconds) at farDistance.
+     */
+    struct TickLOD
+    {
+        float                       nearDistance = 30.0f;
+        float                       farDistance  = 150.0f;
+        float                       farInterval  = 0.5f;
+    };
+
 public:
     Entity*                         GetRoot()           { return mRoot; }
     const Entity*                   GetRoot() const     { return mRoot; }
@@ -45,9 +71,77 @@ public:
 
     RenderWorld*                    GetRenderWorld()    { return mRenderWorld.get(); }
     PhysicsWorld*                   GetPhysicsWorld()   { return mPhysicsWorld.get(); }
+    TransformStore&                 GetTransformStore() { return *mTransformStore; }
 
     void                            Tick(const float delta);
 
+    /** Total time that the world has been ticked for, in seconds. */
+    double                          GetTime() const         { return mTime; }
+
+    /** Number of times that the world has been ticked. */
+    uint64_t                        GetFrameIndex() const   { return mFrameIndex; }
+
+    const TickLOD&                  GetTickLOD() const      { return mTickLOD; }
+    void                            SetTickLOD(const TickLOD& lod);
+
+    /**
+     * Entity that distance-based tick LOD is calculated relative to. If there
+     * is none, components tick at their normal rate. By default this is the
+     * earliest activated Camera that is still active. Setting null reverts
+     * to the default, as does the viewer being deactivated.
+     */
+    Entity*                         GetTickLODViewer() const { return mTickLODViewer; }
+    void                            SetTickLODViewer(Entity* const entity);
+
+    /** Add/remove an active camera as a candidate tick LOD viewer. */
+    void                            AddActiveCamera(Entity* const entity,
+                                                    OnlyCalledBy<Camera>);
+    void                            RemoveActiveCamera(Entity* const entity,
+                                                       OnlyCalledBy<Camera>);
+
+    /** Called when an entity is deactivated. */
+    void                            EntityDeactivated(Entity* const entity,
+                                                      OnlyCalledBy<Entity>);
+
+    /**
+     * Recalculate all out of date world transformations, and call
+     * Component::Transformed() for all entities whose transformation has
+     * changed since the last call. This is done at the start of Tick(), and
+     * by Engine again before rendering, including when the world is paused.
+     */
+    void                            UpdateTransforms();
+
+    /** Add an entity to the list to be updated by UpdateTransforms(). */
+    void                            AddTransformUpdate(Entity* const entity,
+                                                       OnlyCalledBy<Entity>);
+
+    /** Add/remove a component in the tick list for its group and class. */
+    void                            AddTick(Component* const component,
+                                            OnlyCalledBy<Component>);
+    void                            RemoveTick(Component* const component,
+                                               OnlyCalledBy<Component>);
+
+    /**
+     * Whether parallel ticks are currently being run. Changes to entity
+     * transformations made during this are deferred until afterwards with
+     * DeferTransformChange().
+     */
+    bool                            IsParallelTicking() const { return mParallelTicking; }
+    void                            DeferTransformChange(Entity* const entity,
+                                                         OnlyCalledBy<Entity>);
+
+    /**
+     * Debug check for operations that are restricted during parallel ticks.
+     * If an entity is given, checks that it is the entity whose component is
+     * being ticked on the current thread. Otherwise, checks that parallel
+     * ticks are not being run at all.
+     */
+    #if GEMINI_BUILD_DEBUG
+    void                            CheckParallelTickAccess(const Entity* const entity) const;
+    #else
+    void                            CheckParallelTickAccess(const Entity* const entity) const {}
+    #endif
+
 protected:
                                     World();
                                     ~World();
@@ -56,6 +150,42 @@ protected:
     void                            Deserialise(Serialiser& serialiser) override;
 
 private:
+    struct TickList
+    {
+        std::vector<Component*>     components;
+
+        /** Whether the class declared that it can be ticked in parallel. */
+        bool                        parallel = false;
+
+        /** Number of components added, used to stagger ticks. */
+        uint32_t                    staggerCount = 0;
+
+        /**
+         * Components removed while ticking are set to null rather than being
+         * removed, this indicates that the list needs compacting afterwards.
+         */
+        bool                        needsCompact = false;
+    };
+
+    struct TickGroupData
+    {
+        std::vector<TickList>       lists;
+        HashMap<const MetaClass*, uint32_t> listIndices;
+    };
+
+private:
+    void                            RunTickGroup(const TickGroup group);
+    void                            RunParallelTicks(TickList&              list,
+                                                     const glm::vec3* const viewerPosition);
+
+    float                           CalculateLODInterval(const float distance) const;
+    bool                            ShouldTick(Component* const       component,
+                                               const glm::vec3* const viewerPosition,
+                                               float&                 outDelta) const;
+
+private:
+    const UPtr<TransformStore>      mTransformStore;
+
     ObjPtr<Entity>                  mRoot;
 
     const UPtr<RenderWorld>         mRenderWorld;
@@ -63,6 +193,29 @@ private:
 
     const UPtr<WorldEditorWindow>   mEditorWindow;
 
+    /**
+     * Highest entities in the hierarchy whose transformation has changed
+     * since the last UpdateTransforms(). Referenced so that they stay alive
+     * until then.
+     */
+    std::vector<ObjPtr<Entity>>     mTransformUpdates;
+
+    TickGroupData                   mTickGroups[kTickGroupCount];
+    bool                            mTicking;
+    bool                            mParallelTicking;
+
+    /** Per-thread lists of entities changed during parallel ticks. */
+    std::vector<std::vector<Entity*>> mDeferredTransformChanges;
+
+    double                          mTime;
+    uint64_t                        mFrameIndex;
+
+    TickLOD                         mTickLOD;
+    Entity*                         mTickLODViewer;
+
+    /** Entities of active cameras, in activation order. */
+    std::vector<Entity*>            mActiveCameras;
+
     friend class Engine;
 };
 
@@ -330,6 +330,14 @@ public:
     void                            SetViewport(const GPUViewport& viewport);
     void                            SetScissor(const IntRect& scissor);
 
+    /**
+     * Get the current viewport/scissor state. Child command lists do not
+     * inherit these from their parent, so these can be used to re-apply the
+     * parent's state to a child.
+     */
+    const GPUViewport&              GetViewport() const             { return mViewport; }
+    const IntRect&                  GetScissor() const              { return mScissor; }
+
     void                            SetVertexBuffer(const uint32_t   index,
                                                     GPUBuffer* const buffer,
                                                     const uint32_t   offset = 0);
@@ -352,12 +360,21 @@ public:
                                                      const void* const  data,
                                                      const size_t       size);
 
+    /**
+     * Draw primitives. Instances are numbered from firstInstance, and the
+     * instance number is visible to shaders through SV_InstanceID. This is
+     * used to index per-instance data (e.g. the entity data buffer).
+     */
     virtual void                    Draw(const uint32_t vertexCount,
-                                         const uint32_t firstVertex = 0) = 0;
+                                         const uint32_t firstVertex   = 0,
+                                         const uint32_t instanceCount = 1,
+                                         const uint32_t firstInstance = 0) = 0;
 
     virtual void                    DrawIndexed(const uint32_t indexCount,
-                                                const uint32_t firstIndex  = 0,
-                                                const int32_t  vertexOffset = 0) = 0;
+                                                const uint32_t firstIndex    = 0,
+                                                const int32_t  vertexOffset  = 0,
+                                                const uint32_t instanceCount = 1,
+                                                const uint32_t firstInstance = 0) = 0;
 
 protected:
     /**
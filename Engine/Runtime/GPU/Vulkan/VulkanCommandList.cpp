@@ -479,29 +479,33 @@ void VulkanGraphicsCommandList::PreDraw(const bool isIndexed)
 }
 
 void VulkanGraphicsCommandList::Draw(const uint32_t vertexCount,
-                                     const uint32_t firstVertex)
+                                     const uint32_t firstVertex,
+                                     const uint32_t instanceCount,
+                                     const uint32_t firstInstance)
 {
     PreDraw(false);
 
     vkCmdDraw(GetCommandBuffer(),
               vertexCount,
-              1,
+              instanceCount,
               firstVertex,
-              0);
+              firstInstance);
 }
 
 void VulkanGraphicsCommandList::DrawIndexed(const uint32_t indexCount,
                                             const uint32_t firstIndex,
-                                            const int32_t  vertexOffset)
+                                            const int32_t  vertexOffset,
+                                            const uint32_t instanceCount,
+                                            const uint32_t firstInstance)
 {
     PreDraw(true);
 
     vkCmdDrawIndexed(GetCommandBuffer(),
                      indexCount,
-                     1,
+                     instanceCount,
                      firstIndex,
                      vertexOffset,
-                     0);
+                     firstInstance);
 }
 
 uint32_t VulkanGraphicsCommandList::AllocateTransientBuffer(const size_t size,
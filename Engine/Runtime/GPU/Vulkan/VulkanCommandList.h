@@ -134,11 +134,15 @@ public:
      */
 public:
     void                            Draw(const uint32_t vertexCount,
-                                         const uint32_t firstVertex) override;
+                                         const uint32_t firstVertex,
+                                         const uint32_t instanceCount,
+                                         const uint32_t firstInstance) override;
 
     void                            DrawIndexed(const uint32_t indexCount,
                                                 const uint32_t firstIndex,
-                                                const int32_t  vertexOffset) override;
+                                                const int32_t  vertexOffset,
+                                                const uint32_t instanceCount,
+                                                const uint32_t firstInstance) override;
 
 protected:
     GPUCommandList*                 CreateChildImpl() override;
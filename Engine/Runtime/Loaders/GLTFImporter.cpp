@@ -152,21 +152,14 @@ bool GLTFImporter::Import(const Path&             path,
 
     /* Parse the file content. */
     {
-        UPtr<DataStream> file(Filesystem::OpenFile(mPath));
+        UPtr<DataStream> file(Filesystem::MapFile(mPath));
         if (!file)
         {
-            LogError("%s: Failed to open file", mPath.GetCString());
+            LogError("%s: Failed to map file", mPath.GetCString());
             return false;
         }
 
-        ByteArray data(file->GetSize());
-        if (!file->Read(data.Get(), data.GetSize()))
-        {
-            LogError("%s: Failed to read file", mPath.GetCString());
-            return false;
-        }
-
-        mDocument.Parse(reinterpret_cast<const char*>(data.Get()), data.GetSize());
+        mDocument.Parse(reinterpret_cast<const char*>(file->GetMemory()), file->GetSize());
         if (mDocument.HasParseError())
         {
             LogError("%s: Parse error at %zu: %s",
@@ -446,29 +439,25 @@ bool GLTFImporter::LoadBuffers()
             return false;
         }
 
-        ByteArray& buffer = mBuffers.emplace_back();
+        Buffer& buffer = mBuffers.emplace_back();
 
         std::string mediaType;
 
-        if (!LoadURI(entry["uri"], buffer, mediaType))
+        if (!LoadURI(entry["uri"], buffer.data, mediaType))
         {
             return false;
         }
 
-        const uint64_t byteLength = entry["byteLength"].GetUint64();
+        buffer.length = entry["byteLength"].GetUint64();
 
-        if (byteLength > buffer.GetSize())
+        if (buffer.length > buffer.data->GetSize())
         {
-            LogError("%s: Buffer specifies length (%" PRIu64 ") longer than actual data (%zu)",
+            LogError("%s: Buffer specifies length (%" PRIu64 ") longer than actual data (%" PRIu64 ")",
                      mPath.GetCString(),
-                     byteLength,
-                     buffer.GetSize());
+                     buffer.length,
+                     buffer.data->GetSize());
             return false;
         }
-        else if (byteLength < buffer.GetSize())
-        {
-            buffer.Resize(byteLength, false);
-        }
     }
 
     return true;
@@ -513,7 +502,7 @@ bool GLTFImporter::LoadBufferViews()
             LogError("%s: Buffer %u does not exist", mPath.GetCString(), bufferView.buffer);
             return false;
         }
-        else if (bufferView.offset + bufferView.length > mBuffers[bufferView.buffer].GetSize())
+        else if (bufferView.offset + bufferView.length > mBuffers[bufferView.buffer].length)
         {
             LogError("%s: Range %" PRIu64 " + %" PRIu64 " is outside of range of buffer %u",
                      mPath.GetCString(),
@@ -1231,7 +1220,7 @@ bool GLTFImporter::LoadTextures()
 }
 
 bool GLTFImporter::LoadURI(const rapidjson::Value& uriValue,
-                           ByteArray&              outData,
+                           UPtr<MemoryDataStream>& outData,
                            std::string&            outMediaType)
 {
     if (!uriValue.IsString())
@@ -1274,27 +1263,25 @@ bool GLTFImporter::LoadURI(const rapidjson::Value& uriValue,
 
         uri += strlen(kBase64Specifier);
 
-        if (!Base64::Decode(uri, strlen(uri), outData))
+        ByteArray data;
+        if (!Base64::Decode(uri, strlen(uri), data))
         {
             LogError("%s: URI has malformed base64 data", mPath.GetCString());
             return false;
         }
+
+        outData.reset(new MemoryDataStream(std::move(data)));
     }
     else
     {
         const Path path = mPath.GetDirectoryName() / uri;
 
-        UPtr<DataStream> file(Filesystem::OpenFile(path));
-        if (!file)
+        /* Map external files rather than reading them, buffers can be large
+         * and we only need to read from them while generating assets. */
+        outData.reset(Filesystem::MapFile(path));
+        if (!outData)
         {
-            LogError("%s: Failed to open URI '%s' ('%s')", mPath.GetCString(), uri, path.GetCString());
-            return false;
-        }
-
-        outData = ByteArray(file->GetSize());
-        if (!file->Read(outData.Get(), outData.GetSize()))
-        {
-            LogError("%s: Failed to read URI '%s'", mPath.GetCString(), uri);
+            LogError("%s: Failed to map URI '%s' ('%s')", mPath.GetCString(), uri, path.GetCString());
             return false;
         }
 
@@ -1501,7 +1488,7 @@ bool GLTFImporter::GenerateMesh(const uint32_t meshIndex)
                 }
 
                 asset->SetVertexData(bufferIndex,
-                                     mBuffers[bufferView.buffer].Get() + bufferView.offset);
+                                     mBuffers[bufferView.buffer].data->GetMemory() + bufferView.offset);
             }
         }
 
@@ -1544,7 +1531,7 @@ bool GLTFImporter::GenerateMesh(const uint32_t meshIndex)
                                      primitive.topology,
                                      accessor.count,
                                      indexType,
-                                     mBuffers[bufferView.buffer].Get() + bufferView.offset + accessor.offset);
+                                     mBuffers[bufferView.buffer].data->GetMemory() + bufferView.offset + accessor.offset);
         }
         else
         {
@@ -1728,11 +1715,13 @@ bool GLTFImporter::GenerateTexture(const uint32_t textureIndex,
             return false;
         }
 
-        if (!file->Write(image.data.Get(), image.data.GetSize()))
+        if (!file->Write(image.data->GetMemory(), image.data->GetSize()))
         {
             LogError("%s: Failed to write '%s'", mPath.GetCString(), fsPath.GetCString());
             return false;
         }
+
+        AssetManager::Get().AddIndexedFile(fsPath);
     }
 
     /* Write loader metadata specifying properties. TODO: Better interface for
@@ -1769,6 +1758,8 @@ bool GLTFImporter::GenerateTexture(const uint32_t textureIndex,
             LogError("%s: Failed to write '%s'", mPath.GetCString(), fsPath.GetCString());
             return false;
         }
+
+        AssetManager::Get().AddIndexedFile(fsPath);
     }
 
     /* Now load it back in as a proper texture asset. */
@@ -16,7 +16,7 @@
 
 #pragma once
 
-#include "Core/ByteArray.h"
+#include "Core/DataStream.h"
 #include "Core/Path.h"
 
 #include "Engine/Mesh.h"
@@ -30,8 +30,6 @@
 
 #include <rapidjson/document.h>
 
-class ByteArray;
-
 /** glTF import behaviour flags. */
 enum GLTFImporterFlags : uint32_t
 {
@@ -103,9 +101,15 @@ private:
         kImageType_JPG,
     };
 
+    struct Buffer
+    {
+        UPtr<MemoryDataStream>      data;
+        uint64_t                    length;
+    };
+
     struct Image
     {
-        ByteArray                   data;
+        UPtr<MemoryDataStream>      data;
         ImageType                   type;
     };
 
@@ -204,7 +208,7 @@ private:
                                                     const bool     sRGB);
 
     bool                            LoadURI(const rapidjson::Value& uriValue,
-                                            ByteArray&              outData,
+                                            UPtr<MemoryDataStream>& outData,
                                             std::string&            outMediaType);
 
 private:
@@ -216,7 +220,7 @@ private:
     rapidjson::Document             mDocument;
 
     std::vector<Accessor>           mAccessors;
-    std::vector<ByteArray>          mBuffers;
+    std::vector<Buffer>             mBuffers;
     std::vector<BufferView>         mBufferViews;
     std::vector<Image>              mImages;
     std::vector<LightDef>           mLights;
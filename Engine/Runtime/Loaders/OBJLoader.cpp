@@ -38,13 +38,13 @@ OBJLoader::~OBJLoader()
 {
 }
 
-AssetPtr OBJLoader::Load()
+bool OBJLoader::Prepare()
 {
-    if (!Parse())
-    {
-        return nullptr;
-    }
+    return Parse();
+}
 
+AssetPtr OBJLoader::Load()
+{
     return BuildMesh();
 }
 
@@ -59,6 +59,7 @@ public:
 protected:
                                 ~OBJLoader();
 
+    bool                        Prepare() override;
     AssetPtr                    Load() override;
 
 private:
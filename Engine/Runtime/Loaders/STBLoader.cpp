@@ -21,6 +21,8 @@
 #define STBI_NO_STDIO
 #include "stb_image.h"
 
+#include <limits>
+
 static int STBImageRead(void* const user,
                         char*       outData,
                         const int   size)
@@ -73,13 +75,25 @@ bool STBLoader::LoadData()
 
     /* Force conversion to 4 channels as we don't have 3 channel pixel formats.
      * Alpha channel will be filled with 1. TODO: What about 2 channel images,
-     * do we want to support that? */
-    stbi_uc* const image = stbi_load_from_callbacks(&sSTBImageIOCallbacks,
-                                                    this,
-                                                    &width,
-                                                    &height,
-                                                    &origChannels,
-                                                    4);
+     * do we want to support that? If the data is in memory (e.g. a mapped
+     * file), decode directly from it rather than streaming through the
+     * callbacks, unless it is too large for stb_image's int length. */
+    const uint8_t* const memory = mData->GetMemory();
+    const bool fromMemory       = memory && mData->GetSize() <= static_cast<uint64_t>(std::numeric_limits<int>::max());
+
+    stbi_uc* const image = (fromMemory)
+                               ? stbi_load_from_memory(memory,
+                                                       static_cast<int>(mData->GetSize()),
+                                                       &width,
+                                                       &height,
+                                                       &origChannels,
+                                                       4)
+                               : stbi_load_from_callbacks(&sSTBImageIOCallbacks,
+                                                          this,
+                                                          &width,
+                                                          &height,
+                                                          &origChannels,
+                                                          4);
 
     if (!image)
     {
@@ -16,6 +16,8 @@
 
 #include "Loaders/TextureLoader.h"
 
+#include "Engine/Serialiser.h"
+
 TextureLoader::TextureLoader() :
     addressU (kGPUAddressMode_Repeat),
     addressV (kGPUAddressMode_Repeat),
@@ -66,13 +68,14 @@ Texture2DLoader::~Texture2DLoader()
 {
 }
 
-AssetPtr Texture2DLoader::Load()
+bool Texture2DLoader::Prepare()
 {
-    if (!LoadData())
-    {
-        return nullptr;
-    }
+    /* Decoding can be done off the main thread. */
+    return LoadData();
+}
 
+AssetPtr Texture2DLoader::Load()
+{
     return new Texture2D(mWidth,
                          mHeight,
                          0,
@@ -81,6 +84,96 @@ AssetPtr Texture2DLoader::Load()
                          mTextureData);
 }
 
+bool Texture2DLoader::Cook(ObjPtr<AssetLoader>& outLoader)
+{
+    if (!LoadData())
+    {
+        return false;
+    }
+
+    ObjPtr<CookedTexture2DLoader> loader = new CookedTexture2DLoader();
+
+    loader->addressU     = this->addressU;
+    loader->addressV     = this->addressV;
+    loader->addressW     = this->addressW;
+    loader->sRGB         = this->sRGB;
+    loader->mFormat      = mFormat;
+    loader->mWidth       = mWidth;
+    loader->mHeight      = mHeight;
+    loader->mTextureData = std::move(mTextureData);
+
+    outLoader = std::move(loader);
+    return true;
+}
+
+CookedTexture2DLoader::CookedTexture2DLoader()
+{
+}
+
+CookedTexture2DLoader::~CookedTexture2DLoader()
+{
+}
+
+const char* CookedTexture2DLoader::GetExtension() const
+{
+    /* Our data is stored in the loader. */
+    return nullptr;
+}
+
+bool CookedTexture2DLoader::LoadData()
+{
+    /* Already loaded by Deserialise(). */
+    if (mTextureData.empty())
+    {
+        LogError("%s: Cooked texture has no data", mPath);
+        return false;
+    }
+
+    return true;
+}
+
+void CookedTexture2DLoader::Serialise(Serialiser& serialiser) const
+{
+    Texture2DLoader::Serialise(serialiser);
+
+    serialiser.Write("width",  mWidth);
+    serialiser.Write("height", mHeight);
+    serialiser.Write("format", static_cast<uint8_t>(mFormat));
+
+    serialiser.BeginArray("mipLevels");
+
+    for (const ByteArray& data : mTextureData)
+    {
+        serialiser.WriteBinary(nullptr, data);
+    }
+
+    serialiser.EndArray();
+}
+
+void CookedTexture2DLoader::Deserialise(Serialiser& serialiser)
+{
+    Texture2DLoader::Deserialise(serialiser);
+
+    uint8_t format = kPixelFormat_Unknown;
+
+    serialiser.Read("width",  mWidth);
+    serialiser.Read("height", mHeight);
+    serialiser.Read("format", format);
+
+    mFormat = static_cast<PixelFormat>(format);
+
+    if (serialiser.BeginArray("mipLevels"))
+    {
+        ByteArray data;
+        while (serialiser.ReadBinary(nullptr, data))
+        {
+            mTextureData.emplace_back(std::move(data));
+        }
+
+        serialiser.EndArray();
+    }
+}
+
 TextureCubeLoader::TextureCubeLoader()
 {
 }
@@ -57,6 +57,8 @@ protected:
                                 Texture2DLoader();
                                 ~Texture2DLoader();
 
+    bool                        Prepare() override;
+
     /**
      * Load the texture data from the source file. This function is expected
      * to set mWidth, mHeight and mFormat, and populate mTextureData with data
@@ -65,6 +67,8 @@ protected:
      */
     virtual bool                LoadData() = 0;
 
+    bool                        Cook(ObjPtr<AssetLoader>& outLoader) override;
+
 protected:
     uint32_t                    mWidth;
     uint32_t                    mHeight;
@@ -72,6 +76,32 @@ protected:
 
 };
 
+/**
+ * Loader for cooked 2D textures. This stores the decoded texture data
+ * directly in the serialised loader, so loading requires no decoding of the
+ * source file.
+ */
+class CookedTexture2DLoader final : public Texture2DLoader
+{
+    CLASS();
+
+public:
+    const char*                 GetExtension() const override;
+
+protected:
+                                CookedTexture2DLoader();
+                                ~CookedTexture2DLoader();
+
+    bool                        LoadData() override;
+
+private:
+    void                        Serialise(Serialiser& serialiser) const override;
+    void                        Deserialise(Serialiser& serialiser) override;
+
+    friend class Texture2DLoader;
+
+};
+
 class TextureCubeLoader : public TextureLoader
 {
     CLASS();
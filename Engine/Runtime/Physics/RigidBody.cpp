@@ -57,6 +57,10 @@ void RigidBody::MotionState::setWorldTransform(const btTransform &transform)
                                           BulletUtil::FromBullet(transform.getRotation()),
                                           mRigidBody->GetScale());
 
+    /* Transformed() calls would normally be deferred until after we've
+     * cleared the flag, do them now. */
+    mRigidBody->GetEntity()->FlushTransform();
+
     mRigidBody->mUpdatingTransform = false;
 }
 
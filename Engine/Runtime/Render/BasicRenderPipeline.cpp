@@ -53,16 +53,16 @@ void BasicRenderPipeline::Render(const RenderWorld&    world,
 
     /* Build a draw list for the entities. */
     context->drawList.Reserve(context->cullResults.entities.size());
+    context->drawList.SetView(context->GetView());
     for (const RenderEntity* entity : context->cullResults.entities)
     {
         if (entity->SupportsPassType(kShaderPassType_Basic))
         {
-            const GPUPipelineRef pipeline = entity->GetPipeline(kShaderPassType_Basic);
+            EntityDrawSortKey sortKey;
+            const EntityDrawPacket& packet = entity->GetDrawPacket(kShaderPassType_Basic, sortKey);
 
-            const EntityDrawSortKey sortKey = EntityDrawSortKey::GetOpaque(pipeline);
-            EntityDrawCall& drawCall = context->drawList.Add(sortKey);
-
-            entity->GetDrawCall(kShaderPassType_Basic, context->GetView(), drawCall);
+            context->drawList.Add(sortKey.WithDepth(context->GetView(), entity->GetTransform().GetPosition()),
+                                  packet);
         }
     }
 
@@ -91,11 +91,16 @@ void Camera::Activated()
     this->renderPipeline->SetName(GetEntity()->GetPath());
 
     mRenderLayer->ActivateLayer();
+
+    /* Becomes the viewer for tick LOD if nothing else is. */
+    GetWorld()->AddActiveCamera(GetEntity(), {});
 }
 
 void Camera::Deactivated()
 {
     mRenderLayer->DeactivateLayer();
+
+    GetWorld()->RemoveActiveCamera(GetEntity(), {});
 }
 
 RenderOutput* Camera::GetOutput() const
@@ -56,9 +56,9 @@ private:
 struct ShadowLight
 {
     const RenderLight*          light;
-    std::vector<RenderView>     views;
+    FrameVector<RenderView>     views;
     float                       splitDepths[RenderPipeline::kMaxShadowCascades] = {};
-    std::vector<EntityDrawList> drawLists;
+    FrameVector<EntityDrawList> drawLists;
 };
 
 static_assert(kDeferredMaxShadowCascades == RenderPipeline::kMaxShadowCascades,
@@ -76,7 +76,7 @@ struct DeferredRenderContext : public RenderContext
     uint32_t                    tilesHeight;
     uint32_t                    tilesCount;
 
-    std::vector<ShadowLight>    shadowLights;
+    FrameVector<ShadowLight>    shadowLights;
 
     /**
      * Render graph resource handles (always refer to latest version unless
@@ -539,26 +539,26 @@ void DeferredRenderPipeline::BuildDrawLists(DeferredRenderContext* const context
      * reserving space for the unlit draw list since there won't be many things
      * in there. */
     context->opaqueDrawList.Reserve(context->cullResults.entities.size());
+    context->opaqueDrawList.SetView(context->GetView());
+    context->unlitDrawList.SetView(context->GetView());
 
     for (const RenderEntity* entity : context->cullResults.entities)
     {
         if (entity->SupportsPassType(kShaderPassType_DeferredOpaque))
         {
-            const GPUPipelineRef pipeline = entity->GetPipeline(kShaderPassType_DeferredOpaque);
+            EntityDrawSortKey sortKey;
+            const EntityDrawPacket& packet = entity->GetDrawPacket(kShaderPassType_DeferredOpaque, sortKey);
 
-            const EntityDrawSortKey sortKey = EntityDrawSortKey::GetOpaque(pipeline);
-            EntityDrawCall& drawCall = context->opaqueDrawList.Add(sortKey);
-
-            entity->GetDrawCall(kShaderPassType_DeferredOpaque, context->GetView(), drawCall);
+            context->opaqueDrawList.Add(sortKey.WithDepth(context->GetView(), entity->GetTransform().GetPosition()),
+                                        packet);
         }
         else if (entity->SupportsPassType(kShaderPassType_DeferredUnlit))
         {
-            const GPUPipelineRef pipeline = entity->GetPipeline(kShaderPassType_DeferredUnlit);
-
-            const EntityDrawSortKey sortKey = EntityDrawSortKey::GetOpaque(pipeline);
-            EntityDrawCall& drawCall = context->unlitDrawList.Add(sortKey);
+            EntityDrawSortKey sortKey;
+            const EntityDrawPacket& packet = entity->GetDrawPacket(kShaderPassType_DeferredUnlit, sortKey);
 
-            entity->GetDrawCall(kShaderPassType_DeferredUnlit, context->GetView(), drawCall);
+            context->unlitDrawList.Add(sortKey.WithDepth(context->GetView(), entity->GetTransform().GetPosition()),
+                                       packet);
         }
 
         if (mDebugEntityBoundingBoxes)
@@ -578,29 +578,44 @@ void DeferredRenderPipeline::BuildDrawLists(DeferredRenderContext* const context
     const size_t entityCount = context->opaqueDrawList.Size() + context->unlitDrawList.Size();
     DebugManager::Get().AddText(StringUtils::Format("Visible Entities: %zu", entityCount));
 
+    /* Cull all shadow views together, which is done in parallel and only
+     * traverses the world once. */
+    FrameVector<const RenderView*> shadowViews;
+
+    for (const auto& shadowLight : context->shadowLights)
+    {
+        for (const RenderView& view : shadowLight.views)
+        {
+            shadowViews.emplace_back(&view);
+        }
+    }
+
+    FrameVector<CullResults> shadowCullResults(shadowViews.size());
+    context->GetWorld().Cull(shadowViews.data(), shadowViews.size(), kCullFlags_NoLights, shadowCullResults.data());
+
     /* Build shadow map draw lists. */
+    size_t shadowViewIndex = 0;
+
     for (auto& shadowLight : context->shadowLights)
     {
         shadowLight.drawLists.resize(shadowLight.views.size());
 
         for (size_t i = 0; i < shadowLight.views.size(); i++)
         {
-            CullResults cullResults;
-            context->GetWorld().Cull(shadowLight.views[i], kCullFlags_NoLights, cullResults);
+            const CullResults& cullResults = shadowCullResults[shadowViewIndex++];
 
             shadowLight.drawLists[i].Reserve(cullResults.entities.size());
+            shadowLight.drawLists[i].SetView(shadowLight.views[i]);
 
             for (const RenderEntity* entity : cullResults.entities)
             {
                 if (entity->SupportsPassType(kShaderPassType_ShadowMap))
                 {
-                    const GPUPipelineRef pipeline = entity->GetPipeline(kShaderPassType_ShadowMap);
-
-                    // TODO: Sort based on depth instead.
-                    const EntityDrawSortKey sortKey = EntityDrawSortKey::GetOpaque(pipeline);
-                    EntityDrawCall& drawCall = shadowLight.drawLists[i].Add(sortKey);
+                    EntityDrawSortKey sortKey;
+                    const EntityDrawPacket& packet = entity->GetDrawPacket(kShaderPassType_ShadowMap, sortKey);
 
-                    entity->GetDrawCall(kShaderPassType_ShadowMap, shadowLight.views[i], drawCall);
+                    shadowLight.drawLists[i].Add(sortKey.WithDepth(shadowLight.views[i], entity->GetTransform().GetPosition()),
+                                                 packet);
                 }
             }
 
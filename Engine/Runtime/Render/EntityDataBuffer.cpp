@@ -0,0 +1,263 @@
+/*
+ * Copyright (C) 2018-2020 Alex Smith
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#include "Render/EntityDataBuffer.h"
+
+#include "GPU/GPUBuffer.h"
+#include "GPU/GPUContext.h"
+#include "GPU/GPUDevice.h"
+#include "GPU/GPUResourceView.h"
+#include "GPU/GPUStagingResource.h"
+
+#include <algorithm>
+
+/** Initial number of elements that the buffers are sized for. */
+static constexpr uint32_t kInitialCapacity = 1024;
+
+/** State that the buffers are kept in outside of Flush(). */
+static constexpr GPUResourceState kBufferState = kGPUResourceState_VertexShaderRead;
+
+EntityDataBuffer::EntityDataBuffer() :
+    mArgumentSet    (nullptr)
+{
+    GPUArgumentSetLayoutDesc argumentLayoutDesc(kEntityDataArgumentCount);
+    argumentLayoutDesc.arguments[kEntityDataArguments_Data]      = kGPUArgumentType_Buffer;
+    argumentLayoutDesc.arguments[kEntityDataArguments_Instances] = kGPUArgumentType_Buffer;
+
+    mArgumentSetLayout = GPUDevice::Get().GetArgumentSetLayout(std::move(argumentLayoutDesc));
+}
+
+EntityDataBuffer::~EntityDataBuffer()
+{
+    delete mArgumentSet;
+
+    for (Buffer* buffer : { &mDataBuffer, &mInstanceBuffer })
+    {
+        delete buffer->view;
+        delete buffer->buffer;
+    }
+}
+
+uint32_t EntityDataBuffer::Allocate(OnlyCalledBy<RenderEntity>)
+{
+    uint32_t index;
+
+    if (!mFreeIndices.empty())
+    {
+        index = mFreeIndices.back();
+        mFreeIndices.pop_back();
+    }
+    else
+    {
+        index = mData.size();
+
+        mData.emplace_back();
+        mDirty.emplace_back(false);
+    }
+
+    return index;
+}
+
+void EntityDataBuffer::Free(const uint32_t index,
+                            OnlyCalledBy<RenderEntity>)
+{
+    Assert(index < mData.size());
+
+    mFreeIndices.emplace_back(index);
+}
+
+void EntityDataBuffer::Update(const uint32_t         index,
+                              const EntityConstants& constants,
+                              OnlyCalledBy<RenderEntity>)
+{
+    Assert(index < mData.size());
+
+    mData[index] = constants;
+
+    if (!mDirty[index])
+    {
+        mDirty[index] = true;
+        mDirtyIndices.emplace_back(index);
+    }
+}
+
+uint32_t EntityDataBuffer::AddInstances(const uint32_t* const indices,
+                                        const uint32_t        count,
+                                        OnlyCalledBy<EntityDrawList>)
+{
+    const uint32_t first = mInstances.size();
+
+    mInstances.insert(mInstances.end(), indices, indices + count);
+
+    return first;
+}
+
+void EntityDataBuffer::Flush(OnlyCalledBy<RenderManager>)
+{
+    RENDER_PROFILER_FUNC_SCOPE();
+
+    const bool dataResized      = FlushData();
+    const bool instancesResized = FlushInstances();
+
+    if (dataResized || instancesResized)
+    {
+        delete mArgumentSet;
+
+        GPUArgument arguments[kEntityDataArgumentCount];
+        arguments[kEntityDataArguments_Data].view      = mDataBuffer.view;
+        arguments[kEntityDataArguments_Instances].view = mInstanceBuffer.view;
+
+        mArgumentSet = GPUDevice::Get().CreateArgumentSet(mArgumentSetLayout, arguments);
+    }
+}
+
+bool EntityDataBuffer::Reserve(Buffer&        buffer,
+                               const uint32_t count,
+                               const uint32_t elementSize,
+                               const char*    name)
+{
+    if (buffer.buffer && count <= buffer.capacity)
+    {
+        return false;
+    }
+
+    uint32_t capacity = std::max(buffer.capacity, kInitialCapacity);
+    while (capacity < count)
+    {
+        capacity *= 2;
+    }
+
+    /* The GPU layer defers destruction of these until the GPU is finished
+     * with them, so we can free them immediately. */
+    delete buffer.view;
+    delete buffer.buffer;
+
+    buffer.capacity = capacity;
+
+    GPUBufferDesc bufferDesc;
+    bufferDesc.usage = kGPUResourceUsage_ShaderRead;
+    bufferDesc.size  = capacity * elementSize;
+
+    buffer.buffer = GPUDevice::Get().CreateBuffer(bufferDesc);
+    buffer.buffer->SetName(name);
+
+    GPUResourceViewDesc viewDesc;
+    viewDesc.type         = kGPUResourceViewType_Buffer;
+    viewDesc.usage        = kGPUResourceUsage_ShaderRead;
+    viewDesc.elementCount = bufferDesc.size;
+
+    buffer.view = GPUDevice::Get().CreateResourceView(buffer.buffer, viewDesc);
+
+    return true;
+}
+
+bool EntityDataBuffer::FlushData()
+{
+    GPUGraphicsContext& context = GPUGraphicsContext::Get();
+
+    const bool resized = Reserve(mDataBuffer, mData.size(), sizeof(EntityConstants), "EntityData");
+
+    if (resized)
+    {
+        /* New buffer, upload everything. */
+        const uint32_t size = mData.size() * sizeof(EntityConstants);
+
+        if (size > 0)
+        {
+            GPUStagingBuffer stagingBuffer(kGPUStagingAccess_Write, size);
+            stagingBuffer.Write(mData.data(), size);
+            stagingBuffer.Finalise();
+
+            context.UploadBuffer(mDataBuffer.buffer, stagingBuffer, size);
+            context.ResourceBarrier(mDataBuffer.buffer, kGPUResourceState_TransferWrite, kBufferState);
+        }
+    }
+    else if (!mDirtyIndices.empty())
+    {
+        /* Sort so that we can upload runs of adjacent entries together. */
+        std::sort(mDirtyIndices.begin(), mDirtyIndices.end());
+
+        const uint32_t count = mDirtyIndices.size();
+
+        GPUStagingBuffer stagingBuffer(kGPUStagingAccess_Write, count * sizeof(EntityConstants));
+        EntityConstants* const stagingData = stagingBuffer.MapWrite<EntityConstants>();
+
+        for (uint32_t i = 0; i < count; i++)
+        {
+            stagingData[i] = mData[mDirtyIndices[i]];
+        }
+
+        stagingBuffer.Finalise();
+
+        context.ResourceBarrier(mDataBuffer.buffer, kBufferState, kGPUResourceState_TransferWrite);
+
+        for (uint32_t start = 0; start < count; )
+        {
+            uint32_t end = start + 1;
+            while (end < count && mDirtyIndices[end] == mDirtyIndices[end - 1] + 1)
+            {
+                end++;
+            }
+
+            context.UploadBuffer(mDataBuffer.buffer,
+                                 stagingBuffer,
+                                 (end - start) * sizeof(EntityConstants),
+                                 mDirtyIndices[start] * sizeof(EntityConstants),
+                                 start * sizeof(EntityConstants));
+
+            start = end;
+        }
+
+        context.ResourceBarrier(mDataBuffer.buffer, kGPUResourceState_TransferWrite, kBufferState);
+    }
+
+    for (const uint32_t index : mDirtyIndices)
+    {
+        mDirty[index] = false;
+    }
+
+    mDirtyIndices.clear();
+
+    return resized;
+}
+
+bool EntityDataBuffer::FlushInstances()
+{
+    GPUGraphicsContext& context = GPUGraphicsContext::Get();
+
+    const bool resized = Reserve(mInstanceBuffer, mInstances.size(), sizeof(uint32_t), "EntityInstances");
+
+    const uint32_t size = mInstances.size() * sizeof(uint32_t);
+
+    if (size > 0)
+    {
+        GPUStagingBuffer stagingBuffer(kGPUStagingAccess_Write, size);
+        stagingBuffer.Write(mInstances.data(), size);
+        stagingBuffer.Finalise();
+
+        if (!resized)
+        {
+            context.ResourceBarrier(mInstanceBuffer.buffer, kBufferState, kGPUResourceState_TransferWrite);
+        }
+
+        context.UploadBuffer(mInstanceBuffer.buffer, stagingBuffer, size);
+        context.ResourceBarrier(mInstanceBuffer.buffer, kGPUResourceState_TransferWrite, kBufferState);
+    }
+
+    mInstances.clear();
+
+    return resized;
+}
@@ -0,0 +1,135 @@
+/*
+ * Copyright (C) 2018-2020 Alex Smith
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#pragma once
+
+#include "GPU/GPUArgumentSet.h"
+
+#include "Render/RenderDefs.h"
+
+class EntityDrawList;
+class GPUBuffer;
+class GPUResourceView;
+class RenderEntity;
+class RenderManager;
+
+/**
+ * Persistent GPU buffer holding EntityConstants for every RenderEntity. Each
+ * entity is allocated a stable index in the buffer for its lifetime, and its
+ * data is only rewritten when its transform changes.
+ *
+ * Draws find their entity data through a second, per-frame buffer of entity
+ * indices, which is indexed by the instance ID of the draw (see EntityLoad()
+ * in ShaderDefs.h). EntityDrawList adds the indices for all its draws, in
+ * draw order, so that an instanced draw just needs to give the position of
+ * its first index as the base instance.
+ *
+ * Changes are made to CPU-side copies of the data, and uploaded to the GPU
+ * once per frame by Flush(), after all draw lists have been built and before
+ * any rendering is done.
+ */
+class EntityDataBuffer : Uncopyable
+{
+public:
+                                EntityDataBuffer();
+                                ~EntityDataBuffer();
+
+    /**
+     * Get the argument set layout/set for entity data, to be bound at
+     * kArgumentSet_EntityData. The set can change in Flush() when a buffer is
+     * resized, so should only be retrieved at draw time.
+     */
+    GPUArgumentSetLayoutRef     GetArgumentSetLayout() const    { return mArgumentSetLayout; }
+    GPUArgumentSet*             GetArgumentSet() const          { return mArgumentSet; }
+
+    /** Number of entities in the buffer (including free entries). */
+    uint32_t                    GetSize() const                 { return mData.size(); }
+
+    /**
+     * Interface with RenderEntity.
+     */
+
+    uint32_t                    Allocate(OnlyCalledBy<RenderEntity>);
+    void                        Free(const uint32_t index,
+                                     OnlyCalledBy<RenderEntity>);
+    void                        Update(const uint32_t         index,
+                                       const EntityConstants& constants,
+                                       OnlyCalledBy<RenderEntity>);
+
+    /**
+     * Interface with EntityDrawList.
+     */
+
+    /**
+     * Add entity indices for the current frame. Returns the instance ID of the
+     * first of them. This is not thread-safe, draw lists must be sorted from
+     * the main thread.
+     */
+    uint32_t                    AddInstances(const uint32_t* const indices,
+                                             const uint32_t        count,
+                                             OnlyCalledBy<EntityDrawList>);
+
+    /**
+     * Interface with RenderManager.
+     */
+
+    /**
+     * Upload all changes made since the last flush to the GPU, as well as the
+     * instance indices added for this frame.
+     */
+    void                        Flush(OnlyCalledBy<RenderManager>);
+
+private:
+    struct Buffer
+    {
+        GPUBuffer*              buffer   = nullptr;
+        GPUResourceView*        view     = nullptr;
+        uint32_t                capacity = 0;
+    };
+
+private:
+    bool                        Reserve(Buffer&        buffer,
+                                        const uint32_t count,
+                                        const uint32_t elementSize,
+                                        const char*    name);
+
+    bool                        FlushData();
+    bool                        FlushInstances();
+
+private:
+    GPUArgumentSetLayoutRef     mArgumentSetLayout;
+    GPUArgumentSet*             mArgumentSet;
+
+    Buffer                      mDataBuffer;
+    Buffer                      mInstanceBuffer;
+
+    /** CPU copy of the buffer contents. */
+    std::vector<EntityConstants> mData;
+
+    /** Entries freed by Free(), to be reused by Allocate(). */
+    std::vector<uint32_t>       mFreeIndices;
+
+    /**
+     * Entries changed since the last flush. mDirty gives whether each entry
+     * is in mDirtyIndices, to avoid duplicates.
+     */
+    std::vector<uint32_t>       mDirtyIndices;
+    std::vector<bool>           mDirty;
+
+    /** Instance indices for the current frame. */
+    std::vector<uint32_t>       mInstances;
+
+};
@@ -16,24 +16,83 @@
 
 #include "Render/EntityDrawList.h"
 
+#include "Core/Hash.h"
+#include "Core/JobSystem.h"
+
 #include "GPU/GPUCommandList.h"
 #include "GPU/GPUPipeline.h"
 
+#include "Render/EntityDataBuffer.h"
 #include "Render/RenderGraph.h"
+#include "Render/RenderManager.h"
+#include "Render/RenderView.h"
+
+/** Radix sort parameters. The sort is done in 8-bit digits. */
+static constexpr uint32_t kRadixBits        = 8;
+static constexpr uint32_t kRadixSize        = 1 << kRadixBits;
+static constexpr uint32_t kRadixMask        = kRadixSize - 1;
+
+/**
+ * Only the low 16 bits of the state hash are included in the radix sort. This
+ * is enough to group instanceable draws in practice: a collision just means
+ * that we may miss the chance to instance some draws together.
+ */
+static constexpr uint32_t kRadixStateDigits = 16 / kRadixBits;
+static constexpr uint32_t kRadixKeyDigits   = 64 / kRadixBits;
+static constexpr uint32_t kRadixDigits      = kRadixStateDigits + kRadixKeyDigits;
+
+/**
+ * Draw call packets start with the entity data index, which is excluded when
+ * comparing draw state, see EntityDrawPacket::Header.
+ */
+static constexpr size_t kPacketStateOffset = sizeof(uint32_t);
+
+static inline size_t CountBits(uint32_t value)
+{
+    size_t count = 0;
+
+    while (value)
+    {
+        value &= value - 1;
+        count++;
+    }
+
+    return count;
+}
+
+/** Hash all state of a draw call packet other than the entity. */
+static inline size_t HashPacketState(const uint8_t* const packet,
+                                     const size_t         size)
+{
+    return HashData(packet + kPacketStateOffset, size - kPacketStateOffset);
+}
+
+/**
+ * Check whether two draw call packets have identical state other than the
+ * entity, and can therefore be drawn instanced. The size is part of the
+ * compared state, so it is safe to compare using the size of the first.
+ */
+static inline bool CanInstance(const uint8_t* const a,
+                               const uint8_t* const b,
+                               const size_t         size)
+{
+    return memcmp(a + kPacketStateOffset, b + kPacketStateOffset, size - kPacketStateOffset) == 0;
+}
 
 EntityDrawSortKey EntityDrawSortKey::GetOpaque(const GPUPipelineRef pipeline)
 {
     /*
      * Currently we have:
      *
-     *   | Unused        | PS ID         | VS ID         | Pipeline ID   |
-     *   64              48              32              16              0
-     *
-     * This groups draws using the same shaders together and then by PSO within
-     * that to minimise state changes.
+     *   | Unused    | Depth | PS ID         | VS ID         | Pipeline ID   |
+     *   64          52      48              32              16              0
      *
-     * TODO: Factor distance from camera into this, e.g. by grouping into
-     * depth buckets.
+     * Draws are sorted front to back by depth bucket first (added by
+     * WithDepth()), which gives the GPU a good chance of rejecting occluded
+     * pixels before shading them. Within each bucket, draws using the same
+     * shaders are grouped together and then by PSO within that to minimise
+     * state changes. The buckets are kept coarse so that we don't lose too
+     * much of the state grouping.
      */
     static constexpr uint64_t kPipelineIDShift     = 0;
     static constexpr uint64_t kVertexShaderIDShift = 16;
@@ -48,7 +107,230 @@ EntityDrawSortKey EntityDrawSortKey::GetOpaque(const GPUPipelineRef pipeline)
     return key;
 }
 
-EntityDrawList::EntityDrawList()
+EntityDrawSortKey EntityDrawSortKey::WithDepth(const RenderView& view,
+                                               const glm::vec3&  position) const
+{
+    /* See GetOpaque() for the layout. */
+    static constexpr uint64_t kDepthShift = 48;
+
+    static_assert(kDepthBucketCount <= 16, "Depth bucket count exceeds key field size");
+
+    EntityDrawSortKey key = *this;
+    key.mValue |= static_cast<uint64_t>(GetDepthBucket(view, position)) << kDepthShift;
+
+    return key;
+}
+
+uint32_t EntityDrawSortKey::GetDepthBucket(const RenderView& view,
+                                           const glm::vec3&  position)
+{
+    /* View space looks down the negative Z axis. */
+    const glm::mat4& viewMatrix = view.GetViewMatrix();
+    const float depth           = -(viewMatrix[0][2] * position.x +
+                                    viewMatrix[1][2] * position.y +
+                                    viewMatrix[2][2] * position.z +
+                                    viewMatrix[3][2]);
+
+    const float zNear = view.GetZNear();
+    const float zFar  = view.GetZFar();
+
+    /*
+     * For perspective views, distribute the buckets logarithmically, so that
+     * they get finer closer to the viewer. Objects near the viewer take up
+     * more of the screen so ordering them matters more. Orthographic views
+     * (e.g. directional shadow maps) are just divided linearly.
+     */
+    float bucket;
+    if (view.IsPerspective())
+    {
+        bucket = logf(std::max(depth, zNear) / zNear) / logf(zFar / zNear);
+    }
+    else
+    {
+        bucket = (depth - zNear) / (zFar - zNear);
+    }
+
+    bucket = glm::clamp(bucket, 0.0f, 1.0f) * static_cast<float>(kDepthBucketCount);
+
+    return std::min(static_cast<uint32_t>(bucket), kDepthBucketCount - 1);
+}
+
+template <typename Vector>
+size_t EntityDrawPacket::Encode(const EntityDrawCall& drawCall,
+                                Vector&               ioData)
+{
+    static_assert(sizeof(Header) == 32,
+                  "Packet header must not contain padding");
+    static_assert(sizeof(Header) % sizeof(ioData[0]) == 0,
+                  "Packet header must preserve alignment");
+    static_assert(offsetof(Header, size) == kPacketStateOffset,
+                  "Entity data index must be the only non-state part of a packet");
+    static_assert(kMaxArgumentSets * EntityDrawCall::kMaxConstantsPerArgumentSet <= 8,
+                  "Constants mask is too small");
+    static_assert(kMaxVertexAttributes <= 8,
+                  "Vertex buffer mask is too small");
+
+    /* Determine what state is used and therefore the size of the packet. */
+    Header header;
+    memset(&header, 0, sizeof(header));
+
+    header.entityDataIndex = drawCall.entityDataIndex;
+    header.pipeline        = drawCall.pipeline;
+    header.vertexCount     = drawCall.vertexCount;
+    header.vertexOffset    = drawCall.vertexOffset;
+
+    size_t pointerCount   = 0;
+    size_t constantsCount = 0;
+    size_t offsetCount    = 0;
+
+    for (size_t i = 0; i < ArraySize(drawCall.arguments); i++)
+    {
+        const EntityDrawCall::Arguments& arguments = drawCall.arguments[i];
+
+        if (arguments.argumentSet)
+        {
+            header.argumentSetMask |= 1 << i;
+            pointerCount++;
+
+            for (size_t j = 0; j < ArraySize(arguments.constants); j++)
+            {
+                if (arguments.constants[j].constants != kGPUConstants_Invalid)
+                {
+                    header.constantsMask |= 1 << ((i * EntityDrawCall::kMaxConstantsPerArgumentSet) + j);
+                    constantsCount++;
+                }
+            }
+        }
+    }
+
+    for (size_t i = 0; i < ArraySize(drawCall.vertexBuffers); i++)
+    {
+        if (drawCall.vertexBuffers[i].buffer)
+        {
+            header.vertexBufferMask |= 1 << i;
+            pointerCount++;
+            offsetCount++;
+        }
+    }
+
+    if (drawCall.indexBuffer.buffer)
+    {
+        header.indexed     = true;
+        header.indexType   = drawCall.indexType;
+        header.indexOffset = drawCall.indexOffset;
+
+        pointerCount++;
+        offsetCount++;
+    }
+
+    const size_t size = sizeof(Header) +
+                        (pointerCount * sizeof(void*)) +
+                        (constantsCount * 2 * sizeof(uint32_t)) +
+                        (offsetCount * sizeof(uint32_t));
+
+    header.size = static_cast<uint16_t>(RoundUpPow2(size, sizeof(ioData[0])));
+
+    /* Write the packet. New space is zero-initialised so padding is
+     * consistent. */
+    const size_t offset = ioData.size();
+    ioData.resize(offset + (header.size / sizeof(ioData[0])));
+
+    uint8_t* data = reinterpret_cast<uint8_t*>(&ioData[offset]);
+
+    auto Write = [&] (const auto& value)
+    {
+        memcpy(data, &value, sizeof(value));
+        data += sizeof(value);
+    };
+
+    Write(header);
+
+    for (const EntityDrawCall::Arguments& arguments : drawCall.arguments)
+    {
+        if (arguments.argumentSet)
+        {
+            Write(arguments.argumentSet);
+        }
+    }
+
+    for (const EntityDrawCall::Buffer& vertexBuffer : drawCall.vertexBuffers)
+    {
+        if (vertexBuffer.buffer)
+        {
+            Write(vertexBuffer.buffer);
+        }
+    }
+
+    if (drawCall.indexBuffer.buffer)
+    {
+        Write(drawCall.indexBuffer.buffer);
+    }
+
+    for (const EntityDrawCall::Arguments& arguments : drawCall.arguments)
+    {
+        if (arguments.argumentSet)
+        {
+            for (const EntityDrawCall::Constants& constants : arguments.constants)
+            {
+                if (constants.constants != kGPUConstants_Invalid)
+                {
+                    Write(static_cast<uint32_t>(constants.argumentIndex));
+                    Write(constants.constants);
+                }
+            }
+        }
+    }
+
+    for (const EntityDrawCall::Buffer& vertexBuffer : drawCall.vertexBuffers)
+    {
+        if (vertexBuffer.buffer)
+        {
+            Write(vertexBuffer.offset);
+        }
+    }
+
+    if (drawCall.indexBuffer.buffer)
+    {
+        Write(drawCall.indexBuffer.offset);
+    }
+
+    return offset;
+}
+
+void EntityDrawPacket::Encode(const EntityDrawCall& drawCall)
+{
+    mData.clear();
+    Encode(drawCall, mData);
+}
+
+void EntityDrawPacket::SetConstants(const uint8_t      argumentSet,
+                                    const uint8_t      slot,
+                                    const GPUConstants constants)
+{
+    Assert(!mData.empty());
+
+    const Header& header = *reinterpret_cast<const Header*>(mData.data());
+
+    const uint32_t bit = (argumentSet * EntityDrawCall::kMaxConstantsPerArgumentSet) + slot;
+    Assert(header.constantsMask & (1 << bit));
+
+    /* Constants follow the pointers, count how many of each precede this. */
+    const size_t pointerCount = CountBits(header.argumentSetMask) +
+                                CountBits(header.vertexBufferMask) +
+                                header.indexed;
+    const size_t index        = CountBits(header.constantsMask & ((1 << bit) - 1));
+
+    uint8_t* const data = reinterpret_cast<uint8_t*>(mData.data()) +
+                          sizeof(Header) +
+                          (pointerCount * sizeof(void*)) +
+                          (index * 2 * sizeof(uint32_t)) +
+                          sizeof(uint32_t);
+
+    memcpy(data, &constants, sizeof(constants));
+}
+
+EntityDrawList::EntityDrawList() :
+    mViewConstants  (kGPUConstants_Invalid)
 {
 }
 
@@ -58,96 +340,361 @@ EntityDrawList::~EntityDrawList()
 
 void EntityDrawList::Reserve(const size_t expectedCount)
 {
-    mDrawCalls.reserve(expectedCount);
+    mPackets.reserve((expectedCount * kExpectedPacketSize) / sizeof(mPackets[0]));
     mEntries.reserve(expectedCount);
+    mBatches.reserve(expectedCount);
+}
+
+void EntityDrawList::SetView(const RenderView& view)
+{
+    mViewConstants = view.GetConstants();
 }
 
-EntityDrawCall& EntityDrawList::Add(const EntityDrawSortKey sortKey)
+void EntityDrawList::Add(const EntityDrawSortKey sortKey,
+                         const EntityDrawCall&   drawCall)
 {
-    Assert(mDrawCalls.size() == mEntries.size());
+    const size_t offset = EntityDrawPacket::Encode(drawCall, mPackets);
 
     Entry& entry = mEntries.emplace_back();
-    entry.index  = mDrawCalls.size();
+    entry.packet = static_cast<uint32_t>(offset);
     entry.key    = sortKey;
+}
+
+void EntityDrawList::Add(const EntityDrawSortKey sortKey,
+                         const EntityDrawPacket& packet)
+{
+    Assert(!packet.IsEmpty());
+
+    const size_t offset = mPackets.size();
+    mPackets.insert(mPackets.end(), packet.mData.begin(), packet.mData.end());
 
-    return mDrawCalls.emplace_back();
+    Entry& entry = mEntries.emplace_back();
+    entry.packet = static_cast<uint32_t>(offset);
+    entry.key    = sortKey;
+}
+
+void EntityDrawList::SortEntries()
+{
+    /* Within entries with the same key, group by state so that draw calls
+     * which can be instanced are adjacent. */
+    if (mEntries.size() < kRadixSortThreshold)
+    {
+        std::sort(
+            mEntries.begin(),
+            mEntries.end(),
+            [] (const Entry& a, const Entry& b) -> bool
+            {
+                return (a.key < b.key) || (a.key == b.key && a.stateHash < b.stateHash);
+            });
+
+        return;
+    }
+
+    /*
+     * LSD radix sort, treating the state hash as the least significant digits
+     * and the key as the most significant. Each pass is a stable counting sort
+     * on one digit, so the end result is ordered by (key, state).
+     */
+    auto GetDigit = [] (const Entry& entry, const uint32_t digit) -> uint32_t
+    {
+        return (digit < kRadixStateDigits)
+                   ? (entry.stateHash >> (digit * kRadixBits)) & kRadixMask
+                   : (entry.key.GetValue() >> ((digit - kRadixStateDigits) * kRadixBits)) & kRadixMask;
+    };
+
+    const size_t count = mEntries.size();
+
+    /* Build histograms for all digits in one pass over the entries. */
+    uint32_t counts[kRadixDigits][kRadixSize] = {};
+
+    for (const Entry& entry : mEntries)
+    {
+        for (uint32_t digit = 0; digit < kRadixDigits; digit++)
+        {
+            counts[digit][GetDigit(entry, digit)]++;
+        }
+    }
+
+    FrameVector<Entry> temp(count);
+
+    Entry* source = mEntries.data();
+    Entry* dest   = temp.data();
+
+    for (uint32_t digit = 0; digit < kRadixDigits; digit++)
+    {
+        uint32_t* const digitCounts = counts[digit];
+
+        /* Skip digits which are the same for all entries. This is common, e.g.
+         * for unused key bits and the high bits of IDs. */
+        if (digitCounts[GetDigit(source[0], digit)] == count)
+        {
+            continue;
+        }
+
+        uint32_t offset = 0;
+        for (uint32_t i = 0; i < kRadixSize; i++)
+        {
+            const uint32_t digitCount = digitCounts[i];
+            digitCounts[i] = offset;
+            offset += digitCount;
+        }
+
+        for (size_t i = 0; i < count; i++)
+        {
+            const Entry& entry = source[i];
+            dest[digitCounts[GetDigit(entry, digit)]++] = entry;
+        }
+
+        std::swap(source, dest);
+    }
+
+    if (source != mEntries.data())
+    {
+        mEntries.swap(temp);
+    }
 }
 
 void EntityDrawList::Sort()
 {
-    std::sort(
-        mEntries.begin(),
-        mEntries.end(),
-        [] (const Entry& a, const Entry& b) -> bool
+    for (Entry& entry : mEntries)
+    {
+        const EntityDrawPacket::Header& header = GetPacket(entry.packet);
+
+        entry.stateHash = static_cast<uint32_t>(
+            HashPacketState(reinterpret_cast<const uint8_t*>(&header), header.size));
+    }
+
+    SortEntries();
+
+    mBatches.clear();
+
+    if (mEntries.empty())
+    {
+        return;
+    }
+
+    /* Add the entity indices for all draw calls, in draw order, so each batch
+     * just refers to a range of them. */
+    FrameVector<uint32_t> instances(mEntries.size());
+
+    for (size_t i = 0; i < mEntries.size(); i++)
+    {
+        instances[i] = GetPacket(mEntries[i].packet).entityDataIndex;
+    }
+
+    const uint32_t firstInstance =
+        RenderManager::Get().GetEntityDataBuffer().AddInstances(instances.data(), instances.size(), {});
+
+    for (size_t start = 0; start < mEntries.size(); )
+    {
+        const Entry& entry         = mEntries[start];
+        const EntityDrawPacket::Header& header = GetPacket(entry.packet);
+
+        size_t end = start + 1;
+        while (end < mEntries.size() &&
+               mEntries[end].stateHash == entry.stateHash &&
+               CanInstance(reinterpret_cast<const uint8_t*>(&header),
+                           reinterpret_cast<const uint8_t*>(&GetPacket(mEntries[end].packet)),
+                           header.size))
         {
-            return a.key < b.key;
-        });
+            end++;
+        }
+
+        Batch& batch = mBatches.emplace_back();
+        batch.packet        = entry.packet;
+        batch.firstInstance = firstInstance + start;
+        batch.instanceCount = end - start;
+
+        start = end;
+    }
 }
 
 void EntityDrawList::Draw(GPUGraphicsCommandList& cmdList) const
 {
-    // TODO: Implement draw parallelisation here. Partition the list into jobs
-    // and execute in parallel, combine command lists in order at the end.
-    // Would need handling for certain bits of state that we don't override
-    // from the EntityDrawCall (viewport/scissor).
-    //
-    // An additional thing that we could do is add some support in the render
-    // graph for this, so for example we can tell the graph that it needs to
-    // wait for a given set of jobs to complete and submit them into the
-    // command list for the pass, before submitting that to the context. That
-    // would let us return out of here without waiting for completion of all
-    // the jobs, and continue execution of subsequent passes on this thread.
+    Draw(cmdList, nullptr);
+}
 
-    for (const Entry& entry : mEntries)
+void EntityDrawList::Draw(GPUGraphicsCommandList& cmdList,
+                          const RenderGraphPass*  pass) const
+{
+    Assert(mBatches.empty() == mEntries.empty());
+
+    if (mBatches.size() < 2 * kMinDrawsPerChunk)
+    {
+        DrawRange(cmdList, 0, mBatches.size());
+        return;
+    }
+
+    /*
+     * Split the list into chunks and record each into a child command list
+     * from a job. Chunks are kept large enough that the cost of the job and
+     * of the extra command list is small relative to the recording work. We
+     * allow a few chunks per thread so that load is balanced if some chunks
+     * are more expensive than others.
+     */
+    const size_t maxChunkCount = JobSystem::Get().GetThreadCount() * kChunksPerThread;
+    const size_t chunkCount    = std::min(mBatches.size() / kMinDrawsPerChunk, maxChunkCount);
+    const size_t chunkSize     = (mBatches.size() + chunkCount - 1) / chunkCount;
+
+    FrameVector<GPUCommandList*> children;
+    children.reserve(chunkCount);
+
+    /* If we are in a render graph pass, we don't need to wait for the jobs
+     * here, the graph will do so before submitting the pass. */
+    JobCounter localCounter;
+    JobCounter& counter = (pass) ? pass->GetJobCounter() : localCounter;
+
+    /* Children start with default viewport/scissor state, which we don't set
+     * from the draw calls, so apply the parent's. */
+    const GPUViewport viewport = cmdList.GetViewport();
+    const IntRect scissor      = cmdList.GetScissor();
+
+    for (size_t begin = 0; begin < mBatches.size(); begin += chunkSize)
     {
-        const EntityDrawCall& drawCall = mDrawCalls[entry.index];
+        const size_t end = std::min(begin + chunkSize, mBatches.size());
+
+        GPUGraphicsCommandList* const child = cmdList.CreateChild();
+        children.emplace_back(child);
+
+        JobSystem::Get().Run(
+            [this, child, begin, end, viewport, scissor] ()
+            {
+                child->Begin();
+                child->SetViewport(viewport);
+                child->SetScissor(scissor);
+
+                DrawRange(*child, begin, end);
+
+                child->End();
+            },
+            &counter);
+    }
+
+    if (pass)
+    {
+        pass->SubmitChildren(children.data(), children.size());
+    }
+    else
+    {
+        JobSystem::Get().Wait(localCounter);
+
+        cmdList.SubmitChildren(children.data(), children.size());
+    }
+}
+
+void EntityDrawList::DrawRange(GPUGraphicsCommandList& cmdList,
+                               const size_t            begin,
+                               const size_t            end) const
+{
+    AssertMsg(mViewConstants != kGPUConstants_Invalid, "No view set for EntityDrawList");
+
+    /* View arguments are the same for all draws in the list, and the entity
+     * data set can change each frame, so these are bound here rather than
+     * being set in the draw calls. */
+    GPUArgumentSet* const viewArgumentSet       = RenderManager::Get().GetViewArgumentSet();
+    GPUArgumentSet* const entityDataArgumentSet = RenderManager::Get().GetEntityDataBuffer().GetArgumentSet();
+
+    for (size_t batchIndex = begin; batchIndex < end; batchIndex++)
+    {
+        const Batch& batch         = mBatches[batchIndex];
+        const EntityDrawPacket::Header& header = GetPacket(batch.packet);
+
+        /* Decode the packet, see EntityDrawPacket::Header for the layout. */
+        const uint8_t* data = reinterpret_cast<const uint8_t*>(&header) + sizeof(EntityDrawPacket::Header);
+
+        auto Read = [&] (auto& outValue)
+        {
+            memcpy(&outValue, data, sizeof(outValue));
+            data += sizeof(outValue);
+        };
+
+        GPUArgumentSet* argumentSets[kMaxArgumentSets];
+        GPUBuffer* vertexBuffers[kMaxVertexAttributes];
+        GPUBuffer* indexBuffer = nullptr;
+
+        for (size_t i = 0; i < kMaxArgumentSets; i++)
+        {
+            if (header.argumentSetMask & (1 << i))
+            {
+                Read(argumentSets[i]);
+            }
+        }
+
+        for (size_t i = 0; i < kMaxVertexAttributes; i++)
+        {
+            if (header.vertexBufferMask & (1 << i))
+            {
+                Read(vertexBuffers[i]);
+            }
+        }
+
+        if (header.indexed)
+        {
+            Read(indexBuffer);
+        }
 
         /*
          * The GPU layer is responsible for avoiding redundant state changes
          * so we'll just pass everything through.
          */
 
-        cmdList.SetPipeline(drawCall.pipeline);
+        cmdList.SetPipeline(header.pipeline);
 
-        for (size_t i = 0; i < ArraySize(drawCall.arguments); i++)
-        {
-            const EntityDrawCall::Arguments& arguments = drawCall.arguments[i];
+        cmdList.SetArguments(kArgumentSet_ViewEntity, viewArgumentSet);
+        cmdList.SetConstants(kArgumentSet_ViewEntity, kViewEntityArguments_ViewConstants, mViewConstants);
+        cmdList.SetArguments(kArgumentSet_EntityData, entityDataArgumentSet);
 
-            if (arguments.argumentSet)
+        for (size_t i = 0; i < kMaxArgumentSets; i++)
+        {
+            if (header.argumentSetMask & (1 << i))
             {
-                cmdList.SetArguments(i, arguments.argumentSet);
+                cmdList.SetArguments(i, argumentSets[i]);
 
-                for (auto& constants : arguments.constants)
+                for (size_t j = 0; j < EntityDrawCall::kMaxConstantsPerArgumentSet; j++)
                 {
-                    if (constants.constants != kGPUConstants_Invalid)
+                    if (header.constantsMask & (1 << ((i * EntityDrawCall::kMaxConstantsPerArgumentSet) + j)))
                     {
-                        cmdList.SetConstants(i, constants.argumentIndex, constants.constants);
+                        uint32_t argumentIndex;
+                        GPUConstants constants;
+                        Read(argumentIndex);
+                        Read(constants);
+
+                        cmdList.SetConstants(i, argumentIndex, constants);
                     }
                 }
             }
         }
 
-        for (size_t i = 0; i < ArraySize(drawCall.vertexBuffers); i++)
+        for (size_t i = 0; i < kMaxVertexAttributes; i++)
         {
-            const EntityDrawCall::Buffer& vertexBuffer = drawCall.vertexBuffers[i];
-
-            if (vertexBuffer.buffer)
+            if (header.vertexBufferMask & (1 << i))
             {
-                cmdList.SetVertexBuffer(i, vertexBuffer.buffer, vertexBuffer.offset);
+                uint32_t offset;
+                Read(offset);
+
+                cmdList.SetVertexBuffer(i, vertexBuffers[i], offset);
             }
         }
 
-        const EntityDrawCall::Buffer& indexBuffer = drawCall.indexBuffer;
-
-        if (indexBuffer.buffer)
+        if (header.indexed)
         {
-            cmdList.SetIndexBuffer(drawCall.indexType, indexBuffer.buffer, indexBuffer.offset);
+            uint32_t offset;
+            Read(offset);
+
+            cmdList.SetIndexBuffer(header.indexType, indexBuffer, offset);
 
-            cmdList.DrawIndexed(drawCall.vertexCount, drawCall.indexOffset, drawCall.vertexOffset);
+            cmdList.DrawIndexed(header.vertexCount,
+                                header.indexOffset,
+                                header.vertexOffset,
+                                batch.instanceCount,
+                                batch.firstInstance);
         }
         else
         {
-            cmdList.Draw(drawCall.vertexCount, drawCall.vertexOffset);
+            cmdList.Draw(header.vertexCount,
+                         header.vertexOffset,
+                         batch.instanceCount,
+                         batch.firstInstance);
         }
     }
 }
@@ -158,6 +705,6 @@ void EntityDrawList::Draw(RenderGraphPass& pass) const
                              const RenderGraphPass&  pass,
                              GPUGraphicsCommandList& cmdList)
     {
-        Draw(cmdList);
+        Draw(cmdList, &pass);
     });
 }
@@ -18,31 +18,35 @@
 
 #include "Render/RenderDefs.h"
 
+#include "Engine/FrameAllocator.h"
+
 #include "GPU/GPUPipeline.h"
 
 class GPUArgumentSet;
 class GPUBuffer;
 class GPUGraphicsCommandList;
 class RenderGraphPass;
+class RenderView;
 
 struct CullResults;
 
 /**
  * Structure containing all details for a draw call. This is generated from
- * an entity and stored in an EntityDrawList.
+ * an entity and added to an EntityDrawList, which encodes it into a compact
+ * packet containing only the used state.
  */
 struct EntityDrawCall
 {
     struct Buffer
     {
         GPUBuffer*                  buffer = nullptr;
-        uint32_t                    offset;
+        uint32_t                    offset = 0;
     };
 
     struct Constants
     {
-        uint8_t                     argumentIndex;
-        GPUConstants                constants = kGPUConstants_Invalid;
+        uint8_t                     argumentIndex = 0;
+        GPUConstants                constants     = kGPUConstants_Invalid;
     };
 
     static constexpr uint32_t       kMaxConstantsPerArgumentSet = 2;
@@ -72,7 +76,7 @@ struct EntityDrawCall
      * will be used.
      */
     Buffer                          indexBuffer;
-    GPUIndexType                    indexType;
+    GPUIndexType                    indexType = kGPUIndexType_16;
 
     /**
      * Draw parameters. For an indexed draw, vertexOffset gives an offset to
@@ -80,9 +84,16 @@ struct EntityDrawCall
      * offset of the first index to use. For a non-indexed draw, vertexOffset
      * gives the offset of the first vertex to use, and indexOffset is ignored.
      */
-    uint32_t                        vertexCount;
-    uint32_t                        vertexOffset;
-    uint32_t                        indexOffset;
+    uint32_t                        vertexCount  = 0;
+    uint32_t                        vertexOffset = 0;
+    uint32_t                        indexOffset  = 0;
+
+    /**
+     * Index of the entity's data in the EntityDataBuffer. EntityDrawList
+     * passes this to the shader through the instance indices buffer, which
+     * allows draw calls differing only in this to be drawn instanced.
+     */
+    uint32_t                        entityDataIndex = 0;
 };
 
 /**
@@ -98,9 +109,30 @@ class EntityDrawSortKey
 public:
     uint64_t                        GetValue() const    { return mValue; }
 
-    /** Get a sort key for a standard opaque entity. */
+    /**
+     * Get a sort key for a standard opaque entity. This only depends on the
+     * entity's state so can be cached (see RenderEntity::GetDrawPacket()),
+     * WithDepth() should be used to get the final key for a given view.
+     */
     static EntityDrawSortKey        GetOpaque(const GPUPipelineRef pipeline);
 
+    /**
+     * Add front to back depth ordering to a key from GetOpaque(). Entities
+     * are sorted roughly front to back based on their position relative to
+     * the view, to get better early depth rejection on the GPU, and then by
+     * state.
+     */
+    EntityDrawSortKey               WithDepth(const RenderView& view,
+                                              const glm::vec3&  position) const;
+
+private:
+    /** Number of depth buckets used for front to back sorting. */
+    static constexpr uint32_t       kDepthBucketCount = 16;
+
+private:
+    static uint32_t                 GetDepthBucket(const RenderView& view,
+                                                   const glm::vec3&  position);
+
 private:
     uint64_t                        mValue;
 
@@ -121,6 +153,84 @@ inline bool operator>(const EntityDrawSortKey& a, const EntityDrawSortKey& b)
     return a.GetValue() > b.GetValue();
 }
 
+/**
+ * Encoded form of an EntityDrawCall. This is a compact variable length
+ * representation which contains only the state which is actually used.
+ * EntityDrawList stores all of its draw calls in this form, and packets can
+ * also be built ahead of time and added to lists directly, which avoids the
+ * cost of rebuilding the draw call every time.
+ */
+class EntityDrawPacket
+{
+public:
+                                    EntityDrawPacket() {}
+
+    bool                            IsEmpty() const { return mData.empty(); }
+
+    void                            Clear()         { mData.clear(); }
+
+    /** Encode a draw call into the packet, replacing any previous content. */
+    void                            Encode(const EntityDrawCall& drawCall);
+
+    /**
+     * Replace the value of a set of constants. These must have been set in
+     * the draw call that the packet was encoded from. This is for updating
+     * constants which change every frame without re-encoding the packet.
+     */
+    void                            SetConstants(const uint8_t      argumentSet,
+                                                 const uint8_t      slot,
+                                                 const GPUConstants constants);
+
+private:
+    /**
+     * Header of a packet. The header is followed by only the state which is
+     * actually used, as indicated by the masks in the header:
+     *
+     *  - A GPUArgumentSet* for each set in argumentSetMask.
+     *  - A GPUBuffer* for each vertex buffer in vertexBufferMask.
+     *  - A GPUBuffer* for the index buffer, if indexed.
+     *  - A (uint32_t argumentIndex, GPUConstants) pair for each constants slot
+     *    in constantsMask (bit i * kMaxConstantsPerArgumentSet + j for
+     *    arguments[i].constants[j]).
+     *  - A uint32_t offset for each vertex buffer, and for the index buffer.
+     *
+     * Packets are padded to 8 bytes so that the pointers are aligned. All
+     * state other than entityDataIndex is compared bytewise to determine
+     * whether draws can be instanced, so there must be no uninitialised
+     * padding in a packet.
+     */
+    struct Header
+    {
+        uint32_t                    entityDataIndex;
+        uint16_t                    size;
+        uint8_t                     argumentSetMask;
+        uint8_t                     constantsMask;
+        GPUPipelineRef              pipeline;
+        uint8_t                     vertexBufferMask;
+        uint8_t                     indexed;
+        GPUIndexType                indexType;
+        uint8_t                     unused;
+        uint32_t                    vertexCount;
+        uint32_t                    vertexOffset;
+        uint32_t                    indexOffset;
+    };
+
+private:
+    /**
+     * Encode a draw call onto the end of a vector. Returns the offset of the
+     * packet in the vector.
+     */
+    template <typename Vector>
+    static size_t                   Encode(const EntityDrawCall& drawCall,
+                                           Vector&               ioData);
+
+private:
+    /** Packet data. Stored as 64-bit values for alignment. */
+    std::vector<uint64_t>           mData;
+
+    friend class EntityDrawList;
+};
+
 /**
  * List of draw calls with sorting based on key.
  */
@@ -130,46 +240,125 @@ public:
                                     EntityDrawList();
                                     ~EntityDrawList();
 
-    bool                            IsEmpty() const { return mDrawCalls.empty(); }
-    size_t                          Size() const    { return mDrawCalls.size(); }
+    bool                            IsEmpty() const { return mEntries.empty(); }
+    size_t                          Size() const    { return mEntries.size(); }
 
     /** Allocate space for an expected number of draw calls. */
     void                            Reserve(const size_t expectedCount);
 
     /**
-     * Add an entry to the list. Returns a reference to a draw call structure
-     * in the list to be populated (reference may be invalidated by future
-     * additions).
+     * Set the view that the list will be drawn for. The view's arguments are
+     * bound for all draws in the list. Must be called before drawing.
      */
-    EntityDrawCall&                 Add(const EntityDrawSortKey sortKey);
+    void                            SetView(const RenderView& view);
 
-    /** Sort all entries in the list based on their key. */
+    /**
+     * Add an entry to the list. The draw call is encoded into the list, so
+     * the structure does not need to persist after this returns.
+     */
+    void                            Add(const EntityDrawSortKey sortKey,
+                                        const EntityDrawCall&   drawCall);
+
+    /** Add an entry to the list from a pre-encoded packet. */
+    void                            Add(const EntityDrawSortKey sortKey,
+                                        const EntityDrawPacket& packet);
+
+    /**
+     * Sort all entries in the list based on their key, and then combine runs
+     * of draw calls which have identical state other than the entity into
+     * instanced draws. Must be called on the main thread after all entries
+     * have been added, and before drawing.
+     */
     void                            Sort();
 
-    /** Draw the entities to a given command list. */
+    /**
+     * Draw the entities to a given command list. Large lists are recorded in
+     * parallel into child command lists, and this waits for that to complete.
+     */
     void                            Draw(GPUGraphicsCommandList& cmdList) const;
 
     /**
      * Set the function for a render graph pass to draw the entities. Caller
      * must ensure that the EntityDrawList instance still exists during graph
-     * execution.
+     * execution. Unlike the other version, this does not wait for parallel
+     * recording to complete, the graph will do that before submitting the
+     * pass.
      */
     void                            Draw(RenderGraphPass& pass) const;
 
 private:
     /**
-     * Entry in the draw list. Stores the sort key and the index of the draw
-     * call stored in a separate array. Means sorting has to move less data
-     * around.
+     * Entry in the draw list. Stores the sort key and the offset of the draw
+     * call packet (in units of 8 bytes) in mPackets. Means sorting has to
+     * move less data around.
      */
     struct Entry
     {
         EntityDrawSortKey           key;
-        size_t                      index;
+        uint32_t                    packet;
+
+        /**
+         * Hash of the draw call state, used to group draw calls which can be
+         * instanced together within entries with the same key.
+         */
+        uint32_t                    stateHash;
+    };
+
+    /**
+     * Draw generated by Sort(). Uses the state from the draw call packet,
+     * and draws instanceCount instances starting from firstInstance in the
+     * EntityDataBuffer instance indices.
+     */
+    struct Batch
+    {
+        uint32_t                    packet;
+        uint32_t                    firstInstance;
+        uint32_t                    instanceCount;
     };
 
 private:
-    std::vector<EntityDrawCall>     mDrawCalls;
-    std::vector<Entry>              mEntries;
+    /**
+     * Minimum number of draws to record in each job when recording in
+     * parallel. Lists with less than twice this are recorded serially.
+     */
+    static constexpr size_t         kMinDrawsPerChunk = 128;
+
+    /** Maximum number of jobs to split a list into per thread. */
+    static constexpr size_t         kChunksPerThread  = 2;
+
+    /**
+     * Lists with less entries than this are sorted with std::sort rather than
+     * a radix sort, since the fixed cost of the radix sort's histograms isn't
+     * worth it for small lists.
+     */
+    static constexpr size_t         kRadixSortThreshold = 256;
+
+    /** Expected average packet size, used by Reserve(). */
+    static constexpr size_t         kExpectedPacketSize = 96;
+
+private:
+    const EntityDrawPacket::Header& GetPacket(const uint32_t packet) const
+                                        { return *reinterpret_cast<const EntityDrawPacket::Header*>(&mPackets[packet]); }
+
+    void                            SortEntries();
+
+    void                            Draw(GPUGraphicsCommandList& cmdList,
+                                         const RenderGraphPass*  pass) const;
+    void                            DrawRange(GPUGraphicsCommandList& cmdList,
+                                              const size_t            begin,
+                                              const size_t            end) const;
+
+private:
+    /** Constants for the view set by SetView(). */
+    GPUConstants                    mViewConstants;
+
+    /**
+     * Encoded draw calls (see EntityDrawPacket), stored as 64-bit values for
+     * alignment.
+     */
+    FrameVector<uint64_t>           mPackets;
+
+    FrameVector<Entry>              mEntries;
+    FrameVector<Batch>              mBatches;
 
 };
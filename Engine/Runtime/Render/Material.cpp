@@ -27,6 +27,7 @@
 Material::Material() :
     mVariants               {},
     mArgumentSet            (nullptr),
+    mArgumentSetVersion     (0),
     mGPUConstants           (kGPUConstants_Invalid),
     mGPUConstantsFrameIndex (0)
 {
@@ -427,5 +428,6 @@ void Material::UpdateArgumentSet()
         }
 
         mArgumentSet = GPUDevice::Get().CreateArgumentSet(setLayout, arguments);
+        mArgumentSetVersion++;
     }
 }
@@ -39,6 +39,13 @@ public:
     GPUArgumentSet*             GetArgumentSet() const      { return mArgumentSet; }
     bool                        HasConstants() const        { return mConstantData.GetSize() > 0; }
 
+    /**
+     * Version number of the argument set, incremented whenever it is
+     * recreated. Allows users to detect changes to cached state.
+     */
+    uint32_t                    GetArgumentSetVersion() const
+                                    { return mArgumentSetVersion; }
+
     const ShaderVariant*        GetVariant(const ShaderPassType passType) const
                                     { return mVariants[passType]; }
 
@@ -87,6 +94,7 @@ private:
     const ShaderVariant*        mVariants[kShaderPassTypeCount];
 
     GPUArgumentSet*             mArgumentSet;
+    uint32_t                    mArgumentSetVersion;
 
     /**
      * Array of resources, indexed by the parameter's argument index. This may
@@ -16,25 +16,37 @@
 
 #include "Render/RenderEntity.h"
 
-#include "GPU/GPUConstantPool.h"
+#include "Entity/Entity.h"
+
 #include "GPU/GPUDevice.h"
 #include "GPU/GPUPipeline.h"
 
+#include "Render/EntityDataBuffer.h"
 #include "Render/EntityDrawList.h"
+#include "Render/EntityRenderer.h"
 #include "Render/Material.h"
 #include "Render/RenderContext.h"
 #include "Render/RenderManager.h"
+#include "Render/RenderWorld.h"
 
 RenderEntity::RenderEntity(const EntityRenderer& renderer,
                            Material&             material) :
     mRenderer   (renderer),
     mMaterial   (material),
-    mPipelines  {}
+    mStatic     (renderer.GetEntity()->IsStaticInWorld()),
+    mPipelines  {},
+    mWorld      (nullptr)
 {
+    mEntityDataIndex = RenderManager::Get().GetEntityDataBuffer().Allocate({});
+
+    UpdateEntityData();
 }
 
 RenderEntity::~RenderEntity()
 {
+    Assert(!mWorld);
+
+    RenderManager::Get().GetEntityDataBuffer().Free(mEntityDataIndex, {});
 }
 
 void RenderEntity::CreatePipelines()
@@ -54,8 +66,9 @@ void RenderEntity::CreatePipelines()
                 pipelineDesc.shaders[stage] = variant->GetShader(static_cast<GPUShaderStage>(stage));
             }
 
-            pipelineDesc.argumentSetLayouts[kArgumentSet_ViewEntity] = RenderManager::Get().GetViewEntityArgumentSetLayout();
+            pipelineDesc.argumentSetLayouts[kArgumentSet_ViewEntity] = RenderManager::Get().GetViewArgumentSetLayout();
             pipelineDesc.argumentSetLayouts[kArgumentSet_Material]   = technique->GetArgumentSetLayout();
+            pipelineDesc.argumentSetLayouts[kArgumentSet_EntityData] = RenderManager::Get().GetEntityDataBuffer().GetArgumentSetLayout();
 
             pipelineDesc.blendState        = variant->GetBlendState();
             pipelineDesc.depthStencilState = variant->GetDepthStencilState();
@@ -65,37 +78,47 @@ void RenderEntity::CreatePipelines()
             pipelineDesc.topology          = GetPrimitiveTopology();
 
             mPipelines[passType] = GPUDevice::Get().GetPipeline(pipelineDesc);
+            mCachedDraws[passType].packet.Clear();
         }
     }
 }
 
 void RenderEntity::SetTransform(const Transform& transform)
 {
+    AssertMsg(!mStatic || !mWorld, "Cannot transform static RenderEntity in a world");
+
     mTransform        = transform;
     mWorldBoundingBox = GetLocalBoundingBox().Transform(transform);
+
+    UpdateEntityData();
+
+    if (mWorld)
+    {
+        mWorld->UpdateEntity(this, {});
+    }
+}
+
+void RenderEntity::UpdateEntityData()
+{
+    EntityConstants entityConstants = {};
+    entityConstants.transform = mTransform.GetMatrix();
+    entityConstants.position  = mTransform.GetPosition();
+
+    RenderManager::Get().GetEntityDataBuffer().Update(mEntityDataIndex, entityConstants, {});
 }
 
 void RenderEntity::GetDrawCall(const ShaderPassType passType,
-                               const RenderView&    view,
                                EntityDrawCall&      outDrawCall) const
 {
     Assert(SupportsPassType(passType));
 
     outDrawCall.pipeline = mPipelines[passType];
 
-    /* Set view/entity arguments. */
-    {
-        EntityConstants entityConstants;
-        entityConstants.transform = GetTransform().GetMatrix();
-        entityConstants.position  = GetTransform().GetPosition();
-
-        auto& arguments = outDrawCall.arguments[kArgumentSet_ViewEntity];
-        arguments.argumentSet                = RenderManager::Get().GetViewEntityArgumentSet();
-        arguments.constants[0].argumentIndex = kViewEntityArguments_ViewConstants;
-        arguments.constants[0].constants     = view.GetConstants();
-        arguments.constants[1].argumentIndex = kViewEntityArguments_EntityConstants;
-        arguments.constants[1].constants     = GPUDevice::Get().GetConstantPool().Write(&entityConstants, sizeof(entityConstants));
-    }
+    /* View arguments are the same for all entities in a list so are bound by
+     * EntityDrawList. Entity constants are in the persistent entity data
+     * buffer, we just need to pass our index. EntityDrawList binds the
+     * buffer. */
+    outDrawCall.entityDataIndex = mEntityDataIndex;
 
     /* Set material arguments. */
     {
@@ -111,3 +134,31 @@ void RenderEntity::GetDrawCall(const ShaderPassType passType,
 
     GetGeometry(outDrawCall);
 }
+
+const EntityDrawPacket& RenderEntity::GetDrawPacket(const ShaderPassType passType,
+                                                    EntityDrawSortKey&   outSortKey) const
+{
+    Assert(SupportsPassType(passType));
+
+    CachedDraw& cached = mCachedDraws[passType];
+
+    const uint32_t materialVersion = mMaterial.GetArgumentSetVersion();
+
+    if (cached.packet.IsEmpty() || cached.materialVersion != materialVersion)
+    {
+        EntityDrawCall drawCall;
+        GetDrawCall(passType, drawCall);
+
+        cached.packet.Encode(drawCall);
+        cached.sortKey         = EntityDrawSortKey::GetOpaque(mPipelines[passType]);
+        cached.materialVersion = materialVersion;
+    }
+    else if (mMaterial.GetArgumentSet() && mMaterial.HasConstants())
+    {
+        /* Material constants are written per-frame so need to be updated. */
+        cached.packet.SetConstants(kArgumentSet_Material, 0, mMaterial.GetGPUConstants());
+    }
+
+    outSortKey = cached.sortKey;
+    return cached.packet;
+}
@@ -16,20 +16,19 @@
 
 #pragma once
 
-#include "Core/IntrusiveList.h"
+#include "Core/LooseOctree.h"
 #include "Core/Math/BoundingBox.h"
 #include "Core/Math/Transform.h"
 
 #include "GPU/GPUPipeline.h"
 #include "GPU/GPUState.h"
 
+#include "Render/EntityDrawList.h"
 #include "Render/RenderDefs.h"
 
 class EntityRenderer;
 class Material;
-class RenderView;
-
-struct EntityDrawCall;
+class RenderWorld;
 
 /**
  * This class is the base for a renderable entity in the world. EntityRenderer
@@ -52,6 +51,17 @@ public:
 
     const BoundingBox&              GetWorldBoundingBox() const { return mWorldBoundingBox; }
 
+    /**
+     * Whether the entity is static (see Entity::IsStatic()). This is fixed for
+     * the lifetime of the RenderEntity, since renderers recreate their
+     * entities when reactivated. Static entities cannot have their transform
+     * changed once they have been added to a world.
+     */
+    bool                            IsStatic() const            { return mStatic; }
+
+    /** Get the index of the entity's data in the EntityDataBuffer. */
+    uint32_t                        GetEntityDataIndex() const  { return mEntityDataIndex; }
+
     /** Return whether this entity supports the specified pass type. */
     bool                            SupportsPassType(const ShaderPassType passType) const
                                         { return mPipelines[passType] != nullptr; }
@@ -65,9 +75,18 @@ public:
      * Pass type must be supported (SupportsPassType()).
      */
     void                            GetDrawCall(const ShaderPassType passType,
-                                                const RenderView&    view,
                                                 EntityDrawCall&      outDrawCall) const;
 
+    /**
+     * Get a pre-encoded draw packet for the entity in the given pass type,
+     * along with its opaque sort key (without depth, see
+     * EntityDrawSortKey::WithDepth()). These are cached, and only rebuilt
+     * when the material's arguments change. Pass type must be supported
+     * (SupportsPassType()). Must be called from the main thread.
+     */
+    const EntityDrawPacket&         GetDrawPacket(const ShaderPassType passType,
+                                                  EntityDrawSortKey&   outSortKey) const;
+
 protected:
                                     RenderEntity(const EntityRenderer& renderer,
                                                  Material&             material);
@@ -88,6 +107,17 @@ protected:
     /** Populate geometry details in a draw call. */
     virtual void                    GetGeometry(EntityDrawCall& ioDrawCall) const = 0;
 
+private:
+    struct CachedDraw
+    {
+        EntityDrawPacket            packet;
+        EntityDrawSortKey           sortKey;
+        uint32_t                    materialVersion;
+    };
+
+private:
+    void                            UpdateEntityData();
+
 private:
     const EntityRenderer&           mRenderer;
 
@@ -97,16 +127,38 @@ private:
      */
     Material&                       mMaterial;
 
+    const bool                      mStatic;
+
     Transform                       mTransform;
     BoundingBox                     mWorldBoundingBox;
 
+    /**
+     * Index of the entity's constants in the EntityDataBuffer. Allocated for
+     * the lifetime of the entity, and updated when the transform changes.
+     */
+    uint32_t                        mEntityDataIndex;
+
     /**
      * Pipelines for each pass type supported by the material's shader
      * technique.
      */
     GPUPipelineRef                  mPipelines[kShaderPassTypeCount];
 
-public:
-    IntrusiveListNode               mWorldListNode;
+    /**
+     * Cached draw packets for each pass type, built on first use. Draw
+     * packets don't depend on the transform (entity data is referenced by
+     * index), and entities are recreated for mesh/material changes, so the
+     * only thing we need to check is the material's argument set.
+     */
+    mutable CachedDraw              mCachedDraws[kShaderPassTypeCount];
+
+    /**
+     * World that the entity is in, and its location in the world's spatial
+     * tree. Maintained by RenderWorld.
+     */
+    RenderWorld*                    mWorld;
+    LooseOctreeLocation             mWorldLocation;
+
+    friend class RenderWorld;
 
 };
@@ -19,6 +19,7 @@
 #include "Engine/DebugWindow.h"
 
 #include "GPU/GPUBuffer.h"
+#include "GPU/GPUCommandList.h"
 #include "GPU/GPUContext.h"
 #include "GPU/GPUDevice.h"
 #include "GPU/GPURenderPass.h"
@@ -93,7 +94,8 @@ RenderGraphPass::RenderGraphPass(RenderGraph&              graph,
     mName       (name),
     mType       (type),
     mLayer      (layer),
-    mRequired   (false)
+    mRequired   (false),
+    mCmdList    (nullptr)
 {
 }
 
@@ -386,8 +388,18 @@ GPUResourceView* RenderGraphPass::GetView(const RenderViewHandle handle) const
     return mViews[handle.index].view;
 }
 
+void RenderGraphPass::SubmitChildren(GPUCommandList* const* const children,
+                                     const size_t                 count) const
+{
+    Assert(mGraph.mIsExecuting);
+    Assert(mCmdList);
+
+    mChildren.insert(mChildren.end(), children, children + count);
+}
+
 RenderGraph::RenderGraph() :
-    mIsExecuting    (false)
+    mIsExecuting        (false),
+    mNextPendingPass    (0)
 {
 }
 
@@ -856,7 +868,7 @@ void RenderGraph::EndResources()
     }
 }
 
-void RenderGraph::PrepareResources(RenderGraphPass& pass)
+void RenderGraph::BeginResources(RenderGraphPass& pass)
 {
     for (const RenderGraphPass::UsedResource& use : pass.mUsedResources)
     {
@@ -869,11 +881,23 @@ void RenderGraph::PrepareResources(RenderGraphPass& pass)
         {
             if (resource->beginCallback)
             {
+                /* The callback may do work on the context, which must be
+                 * ordered after everything before this pass. */
+                SubmitPendingPasses(true);
+
                 resource->beginCallback();
             }
 
             resource->begun = true;
         }
+    }
+}
+
+void RenderGraph::PrepareResources(RenderGraphPass& pass)
+{
+    for (const RenderGraphPass::UsedResource& use : pass.mUsedResources)
+    {
+        Resource* const resource = mResources[use.handle.index];
 
         TransitionResource(*resource,
                            use.range,
@@ -917,7 +941,7 @@ void RenderGraph::DestroyViews(RenderGraphPass& pass)
     }
 }
 
-void RenderGraph::ExecutePass(RenderGraphPass& pass)
+void RenderGraph::RecordPass(RenderGraphPass& pass)
 {
     /* The usual PROFILER_SCOPE macros store the token in a static local, which
      * won't work for a dynamic name string, so do this manually. */
@@ -1001,13 +1025,9 @@ void RenderGraph::ExecutePass(RenderGraphPass& pass)
             GPUGraphicsCommandList* const cmdList = context.CreateRenderPass(renderPass);
             cmdList->Begin();
 
+            pass.mCmdList = cmdList;
             pass.mRenderFunction(*this, pass, *cmdList);
 
-            cmdList->End();
-
-            GPU_MARKER_SCOPE(context, pass.mName);
-            context.SubmitRenderPass(cmdList);
-
             break;
         }
 
@@ -1021,20 +1041,71 @@ void RenderGraph::ExecutePass(RenderGraphPass& pass)
             GPUComputeCommandList* const cmdList = context.CreateComputePass();
             cmdList->Begin();
 
+            pass.mCmdList = cmdList;
             pass.mComputeFunction(*this, pass, *cmdList);
 
-            cmdList->End();
+            break;
+        }
+
+        case kRenderGraphPassType_Transfer:
+        {
+            /* These work directly on the context, so are executed when they
+             * are submitted. */
+            Assert(pass.mTransferFunction);
+            break;
+        }
+
+        default:
+        {
+            Unreachable();
+            break;
+        }
+    }
+
+    mPendingPasses.emplace_back(&pass);
+}
+
+void RenderGraph::SubmitPass(RenderGraphPass& pass)
+{
+    if (pass.mCmdList)
+    {
+        /* Complete any parallel recording started by the pass function. */
+        JobSystem::Get().Wait(pass.mJobCounter);
+
+        if (!pass.mChildren.empty())
+        {
+            pass.mCmdList->SubmitChildren(pass.mChildren.data(), pass.mChildren.size());
+        }
+
+        pass.mCmdList->End();
+    }
+
+    PrepareResources(pass);
+
+    switch (pass.mType)
+    {
+        case kRenderGraphPassType_Render:
+        {
+            GPUGraphicsContext& context = GPUGraphicsContext::Get();
 
             GPU_MARKER_SCOPE(context, pass.mName);
-            context.SubmitComputePass(cmdList);
+            context.SubmitRenderPass(static_cast<GPUGraphicsCommandList*>(pass.mCmdList));
 
             break;
         }
 
-        case kRenderGraphPassType_Transfer:
+        case kRenderGraphPassType_Compute:
         {
-            Assert(pass.mTransferFunction);
+            GPUComputeContext& context = GPUGraphicsContext::Get();
+
+            GPU_MARKER_SCOPE(context, pass.mName);
+            context.SubmitComputePass(static_cast<GPUComputeCommandList*>(pass.mCmdList));
+
+            break;
+        }
 
+        case kRenderGraphPassType_Transfer:
+        {
             /* Transfer passes are just executed on the main graphics context.
              * Not worth using a transfer queue for mid-frame transfers, it'll
              * just add synchronisation overhead.
@@ -1060,6 +1131,8 @@ void RenderGraph::ExecutePass(RenderGraphPass& pass)
         }
     }
 
+    pass.mCmdList = nullptr;
+
     if (mDebugOutput.IsValid())
     {
         /* Check if this pass produces the resource version we want as the debug
@@ -1097,6 +1170,25 @@ void RenderGraph::ExecutePass(RenderGraphPass& pass)
             }
         }
     }
+
+    DestroyViews(pass);
+}
+
+void RenderGraph::SubmitPendingPasses(const bool wait)
+{
+    while (mNextPendingPass < mPendingPasses.size())
+    {
+        RenderGraphPass& pass = *mPendingPasses[mNextPendingPass];
+
+        if (!wait && !pass.mJobCounter.IsComplete())
+        {
+            break;
+        }
+
+        SubmitPass(pass);
+
+        mNextPendingPass++;
+    }
 }
 
 void RenderGraph::Execute()
@@ -1112,15 +1204,20 @@ void RenderGraph::Execute()
     {
         if (pass->mRequired)
         {
-            PrepareResources(*pass);
+            BeginResources(*pass);
             CreateViews(*pass);
+            RecordPass(*pass);
 
-            ExecutePass(*pass);
-
-            DestroyViews(*pass);
+            /* Passes are submitted in order, but a pass may have left jobs
+             * recording its commands (see RenderGraphPass::GetJobCounter()).
+             * We don't wait for those here, we just submit whatever is ready
+             * and carry on recording subsequent passes. */
+            SubmitPendingPasses(false);
         }
     }
 
+    SubmitPendingPasses(true);
+
     EndResources();
 
     for (const Destructor& destructor : mDestructors)
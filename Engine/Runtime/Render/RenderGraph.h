@@ -16,6 +16,8 @@
 
 #pragma once
 
+#include "Core/JobSystem.h"
+
 #include "Engine/FrameAllocator.h"
 
 #include "Render/RenderDefs.h"
@@ -23,6 +25,7 @@
 #include <functional>
 
 class GPUBuffer;
+class GPUCommandList;
 class GPUComputeCommandList;
 class GPUGraphicsCommandList;
 class GPUResourceView;
@@ -293,6 +296,20 @@ public:
     /** Retrieve a view from the pass. Only valid inside the pass function. */
     GPUResourceView*                GetView(const RenderViewHandle handle) const;
 
+    /**
+     * Parallel recording support, only valid inside a render or compute pass
+     * function. Jobs which record child command lists of the pass's command
+     * list can be started against the pass's job counter, and the children
+     * given to SubmitChildren(). The pass function should return without
+     * waiting for the jobs: the graph will go on to execute the functions of
+     * subsequent passes on the main thread, and will submit the children
+     * followed by the pass itself once the jobs have completed. Passes are
+     * still submitted to the GPU in order.
+     */
+    JobCounter&                     GetJobCounter() const   { return mJobCounter; }
+    void                            SubmitChildren(GPUCommandList* const* const children,
+                                                   const size_t                 count) const;
+
 private:
     struct UsedResource
     {
@@ -341,6 +358,11 @@ private:
     Attachment                      mColour[kMaxRenderPassColourAttachments];
     Attachment                      mDepthStencil;
 
+    /** Execution state. */
+    GPUCommandList*                 mCmdList;
+    mutable JobCounter              mJobCounter;
+    mutable std::vector<GPUCommandList*> mChildren;
+
     friend class RenderGraph;
     friend class RenderGraphWindow;
 };
@@ -456,7 +478,8 @@ public:
      * Optional callback functions can be supplied which will be called (from
      * the main thread) before any passes which use the resource are executed,
      * and after all passes have executed. The begin callback will be called
-     * before any views to the resource are created.
+     * before any views to the resource are created, and after all previous
+     * passes have been submitted.
      */
     RenderResourceHandle            ImportResource(GPUResource* const        extResource,
                                                    const GPUResourceState    state,
@@ -592,10 +615,13 @@ private:
     void                            DetermineRequiredPasses();
     void                            AllocateResources();
     void                            EndResources();
+    void                            BeginResources(RenderGraphPass& pass);
     void                            PrepareResources(RenderGraphPass& pass);
     void                            CreateViews(RenderGraphPass& pass);
     void                            DestroyViews(RenderGraphPass& pass);
-    void                            ExecutePass(RenderGraphPass& pass);
+    void                            RecordPass(RenderGraphPass& pass);
+    void                            SubmitPass(RenderGraphPass& pass);
+    void                            SubmitPendingPasses(const bool wait);
 
     const RenderGraphPass*          FindPass(const PassKey& key) const;
     const Resource*                 FindResource(const ResourceKey& key) const;
@@ -609,6 +635,13 @@ private:
 
     std::vector<GPUResourceBarrier> mBarriers;
 
+    /**
+     * Render/compute passes which have been recorded but not yet submitted,
+     * in execution order. Passes before mNextPendingPass have been submitted.
+     */
+    RenderGraphPassArray            mPendingPasses;
+    size_t                          mNextPendingPass;
+
     std::vector<Destructor>         mDestructors;
 
     /** Resource to display as debug output, controlled by GUI. */
@@ -18,6 +18,8 @@
 
 #include "Engine/DebugManager.h"
 
+#include "Render/RenderWorld.h"
+
 #include "Core/Math/Cone.h"
 #include "Core/Math/Intersect.h"
 
@@ -29,17 +31,27 @@ static constexpr glm::vec3 kBaseDirection(0.0f, 0.0f, -1.0f);
 RenderLight::RenderLight() :
     /* Parent Light object should initialise everything else. */
     mPosition   (0.0f, 0.0f, 0.0f),
-    mDirection  (kBaseDirection)
+    mDirection  (kBaseDirection),
+    mWorld      (nullptr)
 {
 }
 
 RenderLight::~RenderLight()
 {
+    Assert(!mWorld);
 }
 
 void RenderLight::SetType(const LightType type)
 {
     mType = type;
+
+    /* Bounds depend on the type. Before the light is added to the world,
+     * other parameters may not be initialised yet, but bounds will be updated
+     * when they are set. */
+    if (mWorld)
+    {
+        UpdateBoundingSphere();
+    }
 }
 
 void RenderLight::SetColour(const glm::vec3& colour)
@@ -93,7 +105,7 @@ bool RenderLight::Cull(const Frustum& frustum) const
 {
     /* TODO: Improve zero range culling for spot lights, should still be
      * possible to test if the cone won't intersect the view frustum. */
-    if (mType == kLightType_Directional || mRange == 0.0f)
+    if (!IsBounded())
     {
         return true;
     }
@@ -134,6 +146,11 @@ void RenderLight::UpdateBoundingSphere()
         const Cone cone(mPosition, mDirection, mRange, mConeAngle);
         mBoundingSphere = cone.CalculateBoundingSphere();
     }
+
+    if (mWorld)
+    {
+        mWorld->UpdateLight(this, {});
+    }
 }
 
 void RenderLight::DrawDebugPrimitive() const
@@ -17,11 +17,14 @@
 #pragma once
 
 #include "Core/IntrusiveList.h"
+#include "Core/LooseOctree.h"
 #include "Core/Math/Frustum.h"
 #include "Core/Math/Sphere.h"
 
 #include "Render/RenderDefs.h"
 
+class RenderWorld;
+
 struct LightParams;
 
 /**
@@ -68,6 +71,19 @@ public:
     bool                        GetCastShadows() const { return mCastShadows; }
     void                        SetCastShadows(const bool castShadows);
 
+    /**
+     * Returns whether the light has a bounded area of effect. Directional
+     * lights and zero range lights affect everything.
+     */
+    bool                        IsBounded() const
+                                    { return mType != kLightType_Directional && mRange != 0.0f; }
+
+    /**
+     * Bounding sphere. Exact for point lights, fitted around the cone for spot
+     * lights. Only valid if IsBounded().
+     */
+    const Sphere&               GetBoundingSphere() const { return mBoundingSphere; }
+
     /** Returns whether the light's area of effect intersects with a frustum. */
     bool                        Cull(const Frustum& frustum) const;
 
@@ -97,11 +113,16 @@ private:
     glm::quat                   mOrientation;
     glm::vec3                   mDirection;
 
+    Sphere                      mBoundingSphere;
+
     /**
-     * Bounding sphere. Exact for point lights, fitted around cone for spot
-     * lights.
+     * World that the light is in, and its location in the world's spatial
+     * tree (bounded lights only). Maintained by RenderWorld.
      */
-    Sphere                      mBoundingSphere;
+    RenderWorld*                mWorld;
+    LooseOctreeLocation         mWorldLocation;
+
+    friend class RenderWorld;
 
 public:
     IntrusiveListNode           mWorldListNode;
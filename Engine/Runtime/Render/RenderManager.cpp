@@ -24,6 +24,7 @@
 
 #include "GPU/GPUDevice.h"
 
+#include "Render/EntityDataBuffer.h"
 #include "Render/RenderGraph.h"
 #include "Render/RenderLayer.h"
 #include "Render/RenderOutput.h"
@@ -49,7 +50,10 @@ RenderManager::RenderManager()
         argumentLayoutDesc.arguments[kViewEntityArguments_ViewConstants] = kGPUArgumentType_Constants;
 
         mViewArgumentSetLayout = GPUDevice::Get().GetArgumentSetLayout(std::move(argumentLayoutDesc));
+        mViewArgumentSet       = GPUDevice::Get().CreateArgumentSet(mViewArgumentSetLayout, nullptr);
     }
+
+    mEntityDataBuffer.reset(new EntityDataBuffer);
 }
 
 RenderManager::~RenderManager()
@@ -69,6 +73,7 @@ RenderManager::~RenderManager()
     FreeTransientResources(mTransientTextures);
 
     delete mViewEntityArgumentSet;
+    delete mViewArgumentSet;
 }
 
 void RenderManager::InitAssets(OnlyCalledBy<Engine>)
@@ -129,6 +134,10 @@ void RenderManager::Render(OnlyCalledBy<Engine>)
         }
     }
 
+    /* Upload entity data changes and the instance indices added by draw lists
+     * while adding passes, before anything is drawn. */
+    mEntityDataBuffer->Flush({});
+
     graph.Execute();
 }
 
@@ -27,6 +27,7 @@
 #include <list>
 
 class Engine;
+class EntityDataBuffer;
 class GPUResourceView;
 class RenderGraph;
 class RenderOutput;
@@ -60,6 +61,10 @@ public:
      * arguments are needed.
      */
     GPUArgumentSetLayoutRef     GetViewArgumentSetLayout() const        { return mViewArgumentSetLayout; }
+    GPUArgumentSet*             GetViewArgumentSet() const              { return mViewArgumentSet; }
+
+    /** Get the persistent entity data buffer. */
+    EntityDataBuffer&           GetEntityDataBuffer() const             { return *mEntityDataBuffer; }
 
     /** Dummy resources. */
     GPUResourceView*            GetDummyBlackTexture2D() const          { return mDummyBlackTexture2DView; }
@@ -122,6 +127,9 @@ private:
     GPUArgumentSetLayoutRef     mViewEntityArgumentSetLayout;
     GPUArgumentSet*             mViewEntityArgumentSet;
     GPUArgumentSetLayoutRef     mViewArgumentSetLayout;
+    GPUArgumentSet*             mViewArgumentSet;
+
+    UPtr<EntityDataBuffer>      mEntityDataBuffer;
 
     OutputList                  mOutputs;
 
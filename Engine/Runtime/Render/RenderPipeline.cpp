@@ -85,7 +85,7 @@ RenderResourceHandle RenderPipeline::CreateShadowMap(RenderGraph&    graph,
 
 void RenderPipeline::CreateShadowViews(const RenderLight&       light,
                                        const RenderView&        cameraView,
-                                       std::vector<RenderView>& outViews,
+                                       FrameVector<RenderView>& outViews,
                                        float* const             outSplitDepths) const
 {
     const glm::uvec2 targetSize = glm::uvec2(this->shadowMapResolution, this->shadowMapResolution);
@@ -16,6 +16,7 @@
 
 #pragma once
 
+#include "Engine/FrameAllocator.h"
 #include "Engine/Object.h"
 
 #include "Render/RenderGraph.h"
@@ -103,7 +104,7 @@ protected:
      */
     void                            CreateShadowViews(const RenderLight&       light,
                                                       const RenderView&        cameraView,
-                                                      std::vector<RenderView>& outViews,
+                                                      FrameVector<RenderView>& outViews,
                                                       float* const             outSplitDepths) const;
 
 private:
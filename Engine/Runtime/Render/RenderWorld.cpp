@@ -16,63 +16,277 @@
 
 #include "Render/RenderWorld.h"
 
+#include "Core/JobSystem.h"
+
 #include "Core/Math/Intersect.h"
 
-RenderWorld::RenderWorld()
+/**
+ * Size of the area covered by the spatial trees, and their depth. Things
+ * outside this area still work but are not subdivided. The smallest nodes
+ * are 64 units across.
+ */
+static constexpr float    kWorldTreeSize  = 16384.0f;
+static constexpr uint32_t kWorldTreeDepth = 8;
+
+static BoundingBox GetLightBoundingBox(const RenderLight* const light)
+{
+    const Sphere& sphere = light->GetBoundingSphere();
+
+    return BoundingBox(sphere.GetCentre() - sphere.GetRadius(),
+                       sphere.GetCentre() + sphere.GetRadius());
+}
+
+RenderWorld::RenderWorld() :
+    mEntityTree         (kWorldTreeSize, kWorldTreeDepth),
+    mStaticEntityTree   (kWorldTreeSize, kWorldTreeDepth),
+    mLightTree          (kWorldTreeSize, kWorldTreeDepth)
 {
 }
 
 RenderWorld::~RenderWorld()
 {
-    Assert(mEntities.IsEmpty());
+    Assert(mEntityTree.IsEmpty());
+    Assert(mStaticEntityTree.IsEmpty());
+    Assert(mLightTree.IsEmpty());
 }
 
 void RenderWorld::AddEntity(RenderEntity* const entity)
 {
-    mEntities.Append(entity);
+    Assert(!entity->mWorld);
+
+    entity->mWorld = this;
+
+    LooseOctree<RenderEntity>& tree = (entity->IsStatic()) ? mStaticEntityTree : mEntityTree;
+    tree.Insert(entity, entity->mWorldLocation, entity->GetWorldBoundingBox());
 }
 
 void RenderWorld::RemoveEntity(RenderEntity* const entity)
 {
-    mEntities.Remove(entity);
+    Assert(entity->mWorld == this);
+
+    LooseOctree<RenderEntity>& tree = (entity->IsStatic()) ? mStaticEntityTree : mEntityTree;
+    tree.Remove(entity->mWorldLocation);
+
+    entity->mWorld = nullptr;
+}
+
+void RenderWorld::UpdateEntity(RenderEntity* const entity,
+                               OnlyCalledBy<RenderEntity>)
+{
+    Assert(entity->mWorld == this);
+    Assert(!entity->IsStatic());
+
+    mEntityTree.Update(entity->mWorldLocation, entity->GetWorldBoundingBox());
 }
 
 void RenderWorld::AddLight(RenderLight* const light)
 {
-    mLights.Append(light);
+    Assert(!light->mWorld);
+
+    light->mWorld = this;
+
+    if (light->IsBounded())
+    {
+        mLightTree.Insert(light, light->mWorldLocation, GetLightBoundingBox(light));
+    }
+    else
+    {
+        mUnboundedLights.Append(light);
+    }
 }
 
 void RenderWorld::RemoveLight(RenderLight* const light)
 {
-    mLights.Remove(light);
+    Assert(light->mWorld == this);
+
+    if (light->mWorldLocation.IsInserted())
+    {
+        mLightTree.Remove(light->mWorldLocation);
+    }
+    else
+    {
+        mUnboundedLights.Remove(light);
+    }
+
+    light->mWorld = nullptr;
+}
+
+void RenderWorld::UpdateLight(RenderLight* const light,
+                              OnlyCalledBy<RenderLight>)
+{
+    Assert(light->mWorld == this);
+
+    const bool wasBounded = light->mWorldLocation.IsInserted();
+
+    if (light->IsBounded())
+    {
+        if (wasBounded)
+        {
+            mLightTree.Update(light->mWorldLocation, GetLightBoundingBox(light));
+        }
+        else
+        {
+            mUnboundedLights.Remove(light);
+            mLightTree.Insert(light, light->mWorldLocation, GetLightBoundingBox(light));
+        }
+    }
+    else if (wasBounded)
+    {
+        mLightTree.Remove(light->mWorldLocation);
+        mUnboundedLights.Append(light);
+    }
 }
 
 void RenderWorld::Cull(const RenderView& view,
                        const CullFlags   flags,
                        CullResults&      outResults) const
+{
+    const RenderView* const views[1] = { &view };
+    Cull(views, 1, flags, &outResults);
+}
+
+void RenderWorld::Cull(const RenderView* const* const views,
+                       const uint32_t                 viewCount,
+                       const CullFlags                flags,
+                       CullResults* const             outResults) const
 {
     RENDER_PROFILER_FUNC_SCOPE();
 
-    const Frustum& frustum = view.GetFrustum();
+    /* Per-thread results below are indexed by job thread index. */
+    Assert(JobSystem::GetCurrentThreadIndex() != JobSystem::kInvalidThreadIndex);
+
+    const uint32_t threadCount = JobSystem::Get().GetThreadCount();
 
-    for (const RenderEntity* entity : mEntities)
+    for (uint32_t batchStart = 0; batchStart < viewCount; batchStart += LooseOctreeBase::kMaxQueryFrustums)
     {
-        if (Math::Intersect(frustum, entity->GetWorldBoundingBox()))
+        const uint32_t batchCount = std::min(viewCount - batchStart, LooseOctreeBase::kMaxQueryFrustums);
+
+        Frustum frustums[LooseOctreeBase::kMaxQueryFrustums];
+        for (uint32_t i = 0; i < batchCount; i++)
+        {
+            frustums[i] = views[batchStart + i]->GetFrustum();
+        }
+
+        /* Each thread collects entities into its own lists to avoid needing
+         * any synchronisation, these are merged afterwards. */
+        FrameVector<FrameVector<const RenderEntity*>> threadEntities(threadCount * batchCount);
+
+        auto AddEntity = [&] (const uint32_t viewIndex, const RenderEntity* const entity)
         {
-            // TODO: Allocation overhead, this reallocates every insertion.
-            outResults.entities.emplace_back(entity);
+            const uint32_t threadIndex = JobSystem::GetCurrentThreadIndex();
+            threadEntities[(threadIndex * batchCount) + viewIndex].emplace_back(entity);
+        };
+
+        mStaticEntityTree.ParallelQuery(frustums, batchCount, AddEntity);
+        mEntityTree.ParallelQuery(frustums, batchCount, AddEntity);
+
+        for (uint32_t viewIndex = 0; viewIndex < batchCount; viewIndex++)
+        {
+            CullResults& results = outResults[batchStart + viewIndex];
+
+            size_t entityCount = results.entities.size();
+            for (uint32_t threadIndex = 0; threadIndex < threadCount; threadIndex++)
+            {
+                entityCount += threadEntities[(threadIndex * batchCount) + viewIndex].size();
+            }
+
+            results.entities.reserve(entityCount);
+
+            for (uint32_t threadIndex = 0; threadIndex < threadCount; threadIndex++)
+            {
+                const auto& entities = threadEntities[(threadIndex * batchCount) + viewIndex];
+                results.entities.insert(results.entities.end(), entities.begin(), entities.end());
+            }
+
+            /* There are relatively few lights, so these are just culled
+             * serially for each view. */
+            if (!(flags & kCullFlags_NoLights))
+            {
+                const Frustum& frustum = frustums[viewIndex];
+
+                for (const RenderLight* light : mUnboundedLights)
+                {
+                    results.lights.emplace_back(light);
+                }
+
+                /* The tree tests against the light's bounding box, do a more
+                 * precise test on the sphere for anything it finds. */
+                mLightTree.Query(
+                    frustum,
+                    [&] (const RenderLight* const light)
+                    {
+                        if (light->Cull(frustum))
+                        {
+                            results.lights.emplace_back(light);
+                        }
+                    });
+            }
         }
     }
+}
+
+void RenderWorld::FindEntities(const BoundingBox&                box,
+                               FrameVector<const RenderEntity*>& outEntities) const
+{
+    auto AddEntity = [&] (const RenderEntity* const entity)
+    {
+        outEntities.emplace_back(entity);
+    };
+
+    mStaticEntityTree.Query(box, AddEntity);
+    mEntityTree.Query(box, AddEntity);
+}
 
-    if (!(flags & kCullFlags_NoLights))
+void RenderWorld::FindEntities(const Sphere&                     sphere,
+                               FrameVector<const RenderEntity*>& outEntities) const
+{
+    auto AddEntity = [&] (const RenderEntity* const entity)
     {
-        for (const RenderLight* light : mLights)
+        outEntities.emplace_back(entity);
+    };
+
+    mStaticEntityTree.Query(sphere, AddEntity);
+    mEntityTree.Query(sphere, AddEntity);
+}
+
+void RenderWorld::FindLights(const BoundingBox&               box,
+                             FrameVector<const RenderLight*>& outLights) const
+{
+    for (const RenderLight* light : mUnboundedLights)
+    {
+        outLights.emplace_back(light);
+    }
+
+    mLightTree.Query(
+        box,
+        [&] (const RenderLight* const light)
         {
-            if (light->Cull(frustum))
+            if (Math::Intersect(light->GetBoundingSphere(), box))
             {
-                // TODO: Allocation overhead, this reallocates every insertion.
-                outResults.lights.emplace_back(light);
+                outLights.emplace_back(light);
             }
-        }
+        });
+}
+
+void RenderWorld::FindLights(const Sphere&                    sphere,
+                             FrameVector<const RenderLight*>& outLights) const
+{
+    for (const RenderLight* light : mUnboundedLights)
+    {
+        outLights.emplace_back(light);
     }
+
+    mLightTree.Query(
+        sphere,
+        [&] (const RenderLight* const light)
+        {
+            const Sphere& lightSphere = light->GetBoundingSphere();
+            const glm::vec3 offset    = lightSphere.GetCentre() - sphere.GetCentre();
+            const float radius        = lightSphere.GetRadius() + sphere.GetRadius();
+
+            if (glm::dot(offset, offset) <= radius * radius)
+            {
+                outLights.emplace_back(light);
+            }
+        });
 }
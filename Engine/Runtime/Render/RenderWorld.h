@@ -16,14 +16,19 @@
 
 #pragma once
 
+#include "Core/LooseOctree.h"
+
+#include "Engine/FrameAllocator.h"
+
 #include "Render/RenderEntity.h"
 #include "Render/RenderLight.h"
 #include "Render/RenderView.h"
 
+/** Results of culling. Only valid for the frame they were produced in. */
 struct CullResults
 {
-    std::vector<const RenderEntity*>    entities;
-    std::vector<const RenderLight*>     lights;
+    FrameVector<const RenderEntity*>    entities;
+    FrameVector<const RenderLight*>     lights;
 };
 
 enum CullFlags : uint32_t
@@ -42,9 +47,18 @@ enum CullFlags : uint32_t
  * world's entities, but this is not necessarily a good representation for
  * determining what's visible from a view.
  *
- * Currently, the implementation of this is dumb and just maintains lists of
- * objects that we iterate over and test against the view, but it is intended
- * that in future it will be replaced with something like an octree.
+ * Entities and bounded lights are stored in loose octrees, which allow whole
+ * regions of the world to be accepted or rejected at once, and are cheap to
+ * update as things move. Lights with unbounded area of effect (directional
+ * lights) are kept in a separate list and are always visible.
+ *
+ * Static entities (RenderEntity::IsStatic()) are kept in a separate tree to
+ * dynamic entities. The static tree is never updated once an entity is
+ * inserted, and keeping static entities (the majority in a typical level)
+ * out of the dynamic tree keeps that small and cheap to update.
+ *
+ * Culling and queries only read the world, so can be performed concurrently
+ * from multiple threads, as long as nothing is modifying the world.
  */
 class RenderWorld
 {
@@ -55,19 +69,63 @@ public:
     void                                AddEntity(RenderEntity* const entity);
     void                                RemoveEntity(RenderEntity* const entity);
 
+    /**
+     * Update the tree after an entity's bounding box has changed. Not valid
+     * for static entities.
+     */
+    void                                UpdateEntity(RenderEntity* const entity,
+                                                     OnlyCalledBy<RenderEntity>);
+
     void                                AddLight(RenderLight* const light);
     void                                RemoveLight(RenderLight* const light);
 
+    /** Update the tree after a light's bounds or type has changed. */
+    void                                UpdateLight(RenderLight* const light,
+                                                    OnlyCalledBy<RenderLight>);
+
     void                                Cull(const RenderView& view,
                                              const CullFlags   flags,
                                              CullResults&      outResults) const;
 
+    /**
+     * Cull multiple views at once. The world is traversed once for all of the
+     * views, and the work is distributed across the JobSystem, so this is
+     * more efficient than calling Cull() for each view. outResults must point
+     * to an array with an entry per view.
+     */
+    void                                Cull(const RenderView* const* const views,
+                                             const uint32_t                 viewCount,
+                                             const CullFlags                flags,
+                                             CullResults* const             outResults) const;
+
+    /**
+     * Find entities whose bounding box intersects a box or sphere. Results
+     * are appended to the output list.
+     */
+    void                                FindEntities(const BoundingBox&                box,
+                                                     FrameVector<const RenderEntity*>& outEntities) const;
+    void                                FindEntities(const Sphere&                     sphere,
+                                                     FrameVector<const RenderEntity*>& outEntities) const;
+
+    /**
+     * Find lights whose area of effect may intersect a box or sphere. This
+     * always includes unbounded lights. Results are appended to the output
+     * list.
+     */
+    void                                FindLights(const BoundingBox&               box,
+                                                   FrameVector<const RenderLight*>& outLights) const;
+    void                                FindLights(const Sphere&                    sphere,
+                                                   FrameVector<const RenderLight*>& outLights) const;
+
 private:
-    using RenderEntityList            = IntrusiveList<RenderEntity, &RenderEntity::mWorldListNode>;
     using RenderLightList             = IntrusiveList<RenderLight, &RenderLight::mWorldListNode>;
 
 private:
-    RenderEntityList                    mEntities;
-    RenderLightList                     mLights;
+    LooseOctree<RenderEntity>           mEntityTree;
+    LooseOctree<RenderEntity>           mStaticEntityTree;
+    LooseOctree<RenderLight>            mLightTree;
+
+    /** Lights not in the tree (!RenderLight::IsBounded()). */
+    RenderLightList                     mUnboundedLights;
 
 };
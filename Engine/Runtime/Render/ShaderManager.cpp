@@ -131,14 +131,16 @@ GPUShaderPtr ShaderManager::GetShader(const Path&                  path,
 
             std::unique_lock lock(mLock);
 
-            auto ret = mShaders.emplace(std::move(key), shader.Get());
+            auto ret = mShaders.emplace(key, shader.Get());
 
             if (ret.second)
             {
+                /* Keep a copy of the key rather than referring to the one in
+                 * the map, as map elements can move on insertion. */
                 shader->SetDestroyCallback(
-                    [this, shaderPtr = shader.Get(), mapKey = &ret.first->first] ()
+                    [this, shaderPtr = shader.Get(), mapKey = std::move(key)] ()
                     {
-                        return RemoveShader(shaderPtr, *mapKey);
+                        return RemoveShader(shaderPtr, mapKey);
                     });
             }
             else
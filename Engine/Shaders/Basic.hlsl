@@ -19,6 +19,7 @@
 struct VSInput
 {
     float3      position    : POSITION;
+    uint        instanceID  : SV_InstanceID;
 };
 
 struct PSInput
@@ -28,6 +29,8 @@ struct PSInput
 
 PSInput VSMain(VSInput input)
 {
+    EntityLoad(input.instanceID);
+
     PSInput output;
     output.position = EntityPositionToClip(input.position);
     return output;
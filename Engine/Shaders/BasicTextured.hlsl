@@ -20,6 +20,7 @@ struct VSInput
 {
     float3      position    : POSITION;
     float2      uv          : TEXCOORD;
+    uint        instanceID  : SV_InstanceID;
 };
 
 struct PSInput
@@ -30,6 +31,8 @@ struct PSInput
 
 PSInput VSMain(VSInput input)
 {
+    EntityLoad(input.instanceID);
+
     PSInput output;
     output.position = EntityPositionToClip(input.position);
     output.uv       = input.uv;
@@ -141,6 +141,7 @@ float4 PSDirectional(float4 position : SV_Position) : SV_Target0
 
 float4 VSSpot(float3 position : POSITION) : SV_Position
 {
+    EntityLoadConstants();
     return EntityPositionToClip(position);
 }
 
@@ -29,6 +29,7 @@ struct VSInput
     float3      position        : POSITION;
     float3      normal          : NORMAL;
     float2      uv              : TEXCOORD;
+    uint        instanceID      : SV_InstanceID;
 };
 
 struct PSInput
@@ -46,6 +47,8 @@ struct VSShadowMapInput
     #if ALPHA_TEST
     float2      uv              : TEXCOORD;
     #endif
+
+    uint        instanceID      : SV_InstanceID;
 };
 
 struct PSShadowMapInput
@@ -59,6 +62,8 @@ struct PSShadowMapInput
 
 PSInput VSMain(VSInput input)
 {
+    EntityLoad(input.instanceID);
+
     PSInput output;
     output.clipPosition = EntityPositionToClip(input.position);
     output.position     = EntityPositionToWorld(input.position);
@@ -69,6 +74,8 @@ PSInput VSMain(VSInput input)
 
 PSShadowMapInput VSShadowMap(VSShadowMapInput input)
 {
+    EntityLoad(input.instanceID);
+
     PSShadowMapInput output;
     output.shadowPosition = ShadowMapPosition(input.position);
 
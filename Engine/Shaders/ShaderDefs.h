@@ -75,6 +75,7 @@
 /** Standard argument set indices. */
 #define kArgumentSet_ViewEntity     0   /**< View/entity arguments. */
 #define kArgumentSet_Material       1   /**< Material arguments. */
+#define kArgumentSet_EntityData     2   /**< Persistent entity data. */
 
 /**
  * Macros for HLSL register specifiers.
@@ -154,16 +155,55 @@ struct EntityConstants
 {
     shader_float4x4     transform;
     shader_float3       position;
+    shader_float        _pad0;
 };
 
-CBUFFER(EntityConstants, entity, ViewEntity, EntityConstants);
+/**
+ * Entity constants for draws not made through RenderEntity (e.g. light
+ * volumes), which supply them per-draw.
+ */
+CBUFFER(EntityConstants, entityConstants, ViewEntity, EntityConstants);
+
+/**
+ * Entity data argument definitions. This set contains a persistent buffer of
+ * EntityConstants for all RenderEntity instances, and a per-frame buffer of
+ * entity indices which is indexed by the instance ID of the draw. Instanced
+ * draws have an index for each instance (see EntityDataBuffer).
+ */
+
+#define kEntityDataArguments_Data               0
+#define kEntityDataArguments_Instances          1
+#define kEntityDataArgumentCount                2
 
 #if __HLSL__
 
+StructuredBuffer<EntityConstants> entityData      : SRV(EntityData, Data);
+StructuredBuffer<uint>            entityInstances : SRV(EntityData, Instances);
+
+/**
+ * Entity constants for the current draw. Must be initialised at the start of
+ * the vertex shader, with EntityLoad() for RenderEntity draws, or
+ * EntityLoadConstants() for draws which use the entityConstants buffer.
+ */
+static EntityConstants entity;
+
 /**
  * Entity helper functions/definitions.
  */
 
+void EntityLoad(uint instanceID)
+{
+    /* Vulkan's InstanceIndex (which SV_InstanceID maps to) includes the base
+     * instance of the draw, which is where the draw's first index is. */
+    entity = entityData[entityInstances[instanceID]];
+}
+
+void EntityLoadConstants()
+{
+    entity.transform = entityConstants.transform;
+    entity.position  = entityConstants.position;
+}
+
 float4 EntityPositionToClip(float4 position)
 {
     return mul(view.viewProjection, mul(entity.transform, position));
@@ -0,0 +1,682 @@
+/*
+ * Copyright (C) 2018-2020 Alex Smith
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+/**
+ * Tool to cook assets for shipping. This walks the engine and game asset
+ * directories and writes a cooked version of each asset to the output
+ * directory (AssetManager::kCookedDirectory by default), which AssetManager
+ * will then use in place of the source assets.
+ *
+ * Serialised objects and loaders are converted to the binary format, and
+ * loaders are given the chance to cook their source data (see
+ * AssetLoader::Cook()), such that no parsing or decoding of source data
+ * should be required at runtime.
+ *
+ * A manifest is written to the output directory recording the hashes of the
+ * source files of each asset, so that unchanged assets are skipped when
+ * cooking again. This must be run from the root of the source tree.
+ */
+
+#include "Core/Filesystem.h"
+#include "Core/Hash.h"
+#include "Core/String.h"
+
+#include "Engine/AssetLoader.h"
+#include "Engine/AssetManager.h"
+#include "Engine/BinarySerialiser.h"
+
+#include <rapidjson/document.h>
+#include <rapidjson/error/en.h>
+#include <rapidjson/prettywriter.h>
+#include <rapidjson/stringbuffer.h>
+
+#include <cstring>
+#include <filesystem>
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+#include <getopt.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+/**
+ * Version of the cooked output. This must be incremented whenever a change is
+ * made that affects the cooked data, to force everything to be re-cooked.
+ */
+static constexpr uint32_t kCookVersion = 1;
+
+static constexpr char kManifestFileName[]    = "Manifest.json";
+static constexpr char kObjectFileExtension[] = "object";
+static constexpr char kLoaderFileExtension[] = "loader";
+
+/** Source files for an asset, i.e. all files with the same base name. */
+struct SourceAsset
+{
+    Path                        directory;
+    std::string                 name;
+    std::set<std::string>       extensions;
+};
+
+struct ManifestEntry
+{
+    /** Hash of each source file, keyed by file name. */
+    std::map<std::string, std::string> sources;
+
+    /** Output files, relative to the output directory. */
+    std::vector<std::string>    outputs;
+
+    /** Paths of other assets referred to by the asset. */
+    std::set<std::string>       dependencies;
+};
+
+/** Map of source asset path (without extension) to manifest entry. */
+using Manifest = std::map<std::string, ManifestEntry>;
+
+static bool ReadFile(const Path& path,
+                     ByteArray&  outData)
+{
+    UPtr<File> file(Filesystem::OpenFile(path));
+    if (!file)
+    {
+        LogError("Failed to open '%s'", path.GetCString());
+        return false;
+    }
+
+    outData = ByteArray(file->GetSize());
+    if (!file->Read(outData.Get(), outData.GetSize()))
+    {
+        LogError("Failed to read '%s'", path.GetCString());
+        return false;
+    }
+
+    return true;
+}
+
+static bool WriteFile(const Path&      path,
+                      const ByteArray& data)
+{
+    std::error_code error;
+    std::filesystem::create_directories(path.GetDirectoryName().GetString(), error);
+    if (error)
+    {
+        LogError("Failed to create directory for '%s': %s", path.GetCString(), error.message().c_str());
+        return false;
+    }
+
+    UPtr<File> file(Filesystem::OpenFile(path, kFileMode_Write | kFileMode_Create | kFileMode_Truncate));
+    if (!file)
+    {
+        LogError("Failed to open '%s' for writing", path.GetCString());
+        return false;
+    }
+
+    if (!file->Write(data.Get(), data.GetSize()))
+    {
+        LogError("Failed to write '%s'", path.GetCString());
+        return false;
+    }
+
+    return true;
+}
+
+static bool ParseJSON(const Path&          path,
+                      const ByteArray&     data,
+                      rapidjson::Document& outDocument)
+{
+    outDocument.Parse(reinterpret_cast<const char*>(data.Get()), data.GetSize());
+    if (outDocument.HasParseError())
+    {
+        LogError("%s: Parse error at offset %zu: %s",
+                 path.GetCString(),
+                 outDocument.GetErrorOffset(),
+                 rapidjson::GetParseError_En(outDocument.GetParseError()));
+
+        return false;
+    }
+
+    return true;
+}
+
+/** Find all asset references (see JSONSerialiser) within a JSON value. */
+static void FindDependencies(const rapidjson::Value& value,
+                             std::set<std::string>&  ioDependencies)
+{
+    if (value.IsObject())
+    {
+        for (auto it = value.MemberBegin(); it != value.MemberEnd(); ++it)
+        {
+            if (it->value.IsString() && std::strcmp(it->name.GetString(), "asset") == 0)
+            {
+                ioDependencies.emplace(it->value.GetString());
+            }
+            else
+            {
+                FindDependencies(it->value, ioDependencies);
+            }
+        }
+    }
+    else if (value.IsArray())
+    {
+        for (const rapidjson::Value& element : value.GetArray())
+        {
+            FindDependencies(element, ioDependencies);
+        }
+    }
+}
+
+/**
+ * Convert serialised data to the binary format, recording any asset
+ * references as dependencies.
+ */
+static bool ConvertSerialised(const Path&      path,
+                              const ByteArray& data,
+                              ManifestEntry&   ioEntry,
+                              ByteArray&       outData)
+{
+    rapidjson::Document document;
+    if (!ParseJSON(path, data, document))
+    {
+        return false;
+    }
+
+    FindDependencies(document, ioEntry.dependencies);
+
+    BinarySerialiser serialiser;
+    outData = serialiser.ConvertJSON(data);
+    if (!outData)
+    {
+        LogError("%s: Failed to convert to binary", path.GetCString());
+        return false;
+    }
+
+    return true;
+}
+
+static void FindAssets(const Path&                         directoryPath,
+                       std::map<std::string, SourceAsset>& ioAssets)
+{
+    UPtr<Directory> directory(Filesystem::OpenDirectory(directoryPath));
+    if (!directory)
+    {
+        return;
+    }
+
+    Directory::Entry entry;
+    while (directory->Next(entry))
+    {
+        const Path entryPath = directoryPath / entry.name;
+
+        if (entry.type == kFileType_Directory)
+        {
+            FindAssets(entryPath, ioAssets);
+        }
+        else if (entry.type == kFileType_File)
+        {
+            const std::string name = entry.name.GetBaseFileName();
+            const std::string ext  = entry.name.GetExtension();
+
+            if (name.empty() || ext.empty())
+            {
+                continue;
+            }
+
+            SourceAsset& asset = ioAssets[(directoryPath / name).GetString()];
+            asset.directory    = directoryPath;
+            asset.name         = name;
+
+            asset.extensions.emplace(ext);
+        }
+    }
+}
+
+static bool HashSources(const SourceAsset& asset,
+                        ManifestEntry&     outEntry)
+{
+    for (const std::string& ext : asset.extensions)
+    {
+        const std::string fileName = asset.name + "." + ext;
+
+        ByteArray data;
+        if (!ReadFile(asset.directory / fileName, data))
+        {
+            return false;
+        }
+
+        const size_t hash = HashData(data.Get(), data.GetSize());
+        outEntry.sources.emplace(fileName, StringUtils::Format("%016zx", hash));
+    }
+
+    return true;
+}
+
+static bool CookAsset(const SourceAsset& asset,
+                      const Path&        outputPath,
+                      ManifestEntry&     ioEntry)
+{
+    const Path sourceBase = asset.directory / asset.name;
+    const Path outputBase = asset.directory / asset.name;
+
+    const bool hasLoader = asset.extensions.count(kLoaderFileExtension) != 0;
+    const size_t dataCount = asset.extensions.size() - ((hasLoader) ? 1 : 0);
+
+    if (dataCount > 1)
+    {
+        LogError("%s: Asset has multiple data streams", sourceBase.GetCString());
+        return false;
+    }
+
+    std::string dataExt;
+    for (const std::string& ext : asset.extensions)
+    {
+        if (ext != kLoaderFileExtension)
+        {
+            dataExt = ext;
+        }
+    }
+
+    auto Output = [&] (const std::string& ext, const ByteArray& data)
+    {
+        const Path path = outputBase + "." + ext;
+        ioEntry.outputs.emplace_back(path.GetString());
+        return WriteFile(outputPath / path, data);
+    };
+
+    ByteArray cookedData;
+
+    if (dataExt == kObjectFileExtension)
+    {
+        if (hasLoader)
+        {
+            LogError("%s: Serialised object cannot have a loader", sourceBase.GetCString());
+            return false;
+        }
+
+        const Path path = sourceBase + "." + dataExt;
+
+        ByteArray data;
+        if (!ReadFile(path, data) || !ConvertSerialised(path, data, ioEntry, cookedData))
+        {
+            return false;
+        }
+
+        return Output(dataExt, cookedData);
+    }
+
+    /* Convert the loader to binary. This is used as is if the loader doesn't
+     * cook the asset. */
+    const Path loaderPath = sourceBase + "." + kLoaderFileExtension;
+
+    ByteArray loaderData;
+    ByteArray convertedLoaderData;
+    if (hasLoader)
+    {
+        if (!ReadFile(loaderPath, loaderData) ||
+            !ConvertSerialised(loaderPath, loaderData, ioEntry, convertedLoaderData))
+        {
+            return false;
+        }
+    }
+
+    if (dataExt.empty())
+    {
+        return Output(kLoaderFileExtension, convertedLoaderData);
+    }
+
+    /* Get the loader. If it refers to other assets, we can't deserialise it
+     * since that would require loading them, so we leave it uncooked. */
+    ObjPtr<AssetLoader> loader;
+    if (hasLoader)
+    {
+        if (ioEntry.dependencies.empty())
+        {
+            UPtr<Serialiser> serialiser = Serialiser::Create(loaderData);
+            loader = serialiser->Deserialise<AssetLoader>(loaderData);
+            if (!loader)
+            {
+                LogError("%s: Error during loader deserialisation", loaderPath.GetCString());
+                return false;
+            }
+        }
+    }
+    else
+    {
+        loader = AssetLoader::Create(dataExt);
+        if (!loader)
+        {
+            LogWarning("%s: Unknown file type '%s', copying as is", sourceBase.GetCString(), dataExt.c_str());
+        }
+    }
+
+    const Path dataPath = sourceBase + "." + dataExt;
+
+    ObjPtr<AssetLoader> cookedLoader;
+    if (loader)
+    {
+        UPtr<File> data(Filesystem::OpenFile(dataPath));
+        if (!data)
+        {
+            LogError("Failed to open '%s'", dataPath.GetCString());
+            return false;
+        }
+
+        /* The loader should log an error if it fails. */
+        if (!loader->Cook(data.get(), sourceBase.GetCString(), cookedLoader))
+        {
+            return false;
+        }
+    }
+
+    if (cookedLoader)
+    {
+        /* The cooked loader contains everything needed to load the asset. */
+        BinarySerialiser serialiser;
+        cookedData = serialiser.Serialise(cookedLoader.Get());
+
+        return Output(kLoaderFileExtension, cookedData);
+    }
+    else
+    {
+        ByteArray data;
+        if (!ReadFile(dataPath, data) || !Output(dataExt, data))
+        {
+            return false;
+        }
+
+        return !hasLoader || Output(kLoaderFileExtension, convertedLoaderData);
+    }
+}
+
+static bool LoadManifest(const Path& path,
+                         Manifest&   outManifest)
+{
+    if (!Filesystem::Exists(path))
+    {
+        return true;
+    }
+
+    ByteArray data;
+    rapidjson::Document document;
+    if (!ReadFile(path, data) || !ParseJSON(path, data, document))
+    {
+        return false;
+    }
+
+    if (!document.IsObject() ||
+        !document.HasMember("version") || !document["version"].IsUint() ||
+        !document.HasMember("assets")  || !document["assets"].IsObject())
+    {
+        LogError("%s: Manifest is invalid", path.GetCString());
+        return false;
+    }
+
+    /* Leave the manifest empty to cook everything again if the version is
+     * different. */
+    if (document["version"].GetUint() != kCookVersion)
+    {
+        LogInfo("Cooked data version has changed, cooking all assets");
+        return true;
+    }
+
+    const rapidjson::Value& assets = document["assets"];
+
+    for (auto it = assets.MemberBegin(); it != assets.MemberEnd(); ++it)
+    {
+        const rapidjson::Value& value = it->value;
+        ManifestEntry& entry          = outManifest[it->name.GetString()];
+
+        for (auto source = value["sources"].MemberBegin(); source != value["sources"].MemberEnd(); ++source)
+        {
+            entry.sources.emplace(source->name.GetString(), source->value.GetString());
+        }
+
+        for (const rapidjson::Value& output : value["outputs"].GetArray())
+        {
+            entry.outputs.emplace_back(output.GetString());
+        }
+
+        for (const rapidjson::Value& dependency : value["dependencies"].GetArray())
+        {
+            entry.dependencies.emplace(dependency.GetString());
+        }
+    }
+
+    return true;
+}
+
+static bool SaveManifest(const Path&     path,
+                         const Manifest& manifest)
+{
+    rapidjson::StringBuffer buffer;
+    rapidjson::PrettyWriter<rapidjson::StringBuffer> writer(buffer);
+    writer.SetIndent(' ', 4);
+
+    writer.StartObject();
+
+    writer.Key("version");
+    writer.Uint(kCookVersion);
+
+    writer.Key("assets");
+    writer.StartObject();
+
+    for (const auto& it : manifest)
+    {
+        const ManifestEntry& entry = it.second;
+
+        writer.Key(it.first.c_str());
+        writer.StartObject();
+
+        writer.Key("sources");
+        writer.StartObject();
+
+        for (const auto& source : entry.sources)
+        {
+            writer.Key(source.first.c_str());
+            writer.String(source.second.c_str());
+        }
+
+        writer.EndObject();
+
+        writer.Key("outputs");
+        writer.StartArray();
+
+        for (const std::string& output : entry.outputs)
+        {
+            writer.String(output.c_str());
+        }
+
+        writer.EndArray();
+
+        writer.Key("dependencies");
+        writer.StartArray();
+
+        for (const std::string& dependency : entry.dependencies)
+        {
+            writer.String(dependency.c_str());
+        }
+
+        writer.EndArray();
+
+        writer.EndObject();
+    }
+
+    writer.EndObject();
+    writer.EndObject();
+
+    ByteArray data(buffer.GetSize());
+    memcpy(data.Get(), buffer.GetString(), buffer.GetSize());
+
+    return WriteFile(path, data);
+}
+
+static void Usage(const char* programName)
+{
+    printf("Usage: %s [options...]\n", programName);
+    printf("\n");
+    printf("Options:\n");
+    printf("  -h            Display this help\n");
+    printf("  -f            Cook all assets, even if unchanged\n");
+    printf("  -o <path>     Output directory (defaults to '%s')\n", AssetManager::kCookedDirectory);
+}
+
+int main(const int          argc,
+         char* const* const argv)
+{
+    Path outputPath(AssetManager::kCookedDirectory);
+    bool force = false;
+
+    /* Parse arguments. */
+    int opt;
+    while ((opt = getopt(argc, argv, "hfo:")) != -1)
+    {
+        switch (opt)
+        {
+            case 'h':
+                Usage(argv[0]);
+                return EXIT_SUCCESS;
+
+            case 'f':
+                force = true;
+                break;
+
+            case 'o':
+                outputPath = Path(optarg, Path::kUnnormalizedPlatform);
+                break;
+
+            default:
+                return EXIT_FAILURE;
+
+        }
+    }
+
+    if (argc != optind)
+    {
+        Usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    /* Find all source assets. */
+    std::map<std::string, SourceAsset> assets;
+
+    FindAssets("Engine/Assets", assets);
+
+    UPtr<Directory> games(Filesystem::OpenDirectory("Games"));
+    if (games)
+    {
+        Directory::Entry entry;
+        while (games->Next(entry))
+        {
+            if (entry.type == kFileType_Directory)
+            {
+                FindAssets(Path("Games") / entry.name / "Assets", assets);
+            }
+        }
+    }
+
+    if (assets.empty())
+    {
+        LogError("No assets found, must be run from the root of the source tree");
+        return EXIT_FAILURE;
+    }
+
+    const Path manifestPath = outputPath / kManifestFileName;
+
+    Manifest oldManifest;
+    if (!force && !LoadManifest(manifestPath, oldManifest))
+    {
+        return EXIT_FAILURE;
+    }
+
+    Manifest manifest;
+    size_t cookedCount  = 0;
+    size_t skippedCount = 0;
+    size_t failedCount  = 0;
+
+    for (const auto& it : assets)
+    {
+        const SourceAsset& asset = it.second;
+
+        ManifestEntry entry;
+        if (!HashSources(asset, entry))
+        {
+            failedCount++;
+            continue;
+        }
+
+        /* Skip the asset if it is unchanged and its outputs still exist. */
+        auto oldEntry = oldManifest.find(it.first);
+        if (oldEntry != oldManifest.end() && oldEntry->second.sources == entry.sources)
+        {
+            bool exists = true;
+            for (const std::string& output : oldEntry->second.outputs)
+            {
+                exists &= Filesystem::Exists(outputPath / output);
+            }
+
+            if (exists)
+            {
+                manifest.emplace(it.first, std::move(oldEntry->second));
+                oldManifest.erase(oldEntry);
+
+                skippedCount++;
+                continue;
+            }
+        }
+
+        if (CookAsset(asset, outputPath, entry))
+        {
+            LogInfo("Cooked '%s'", it.first.c_str());
+
+            manifest.emplace(it.first, std::move(entry));
+            cookedCount++;
+        }
+        else
+        {
+            LogError("Failed to cook '%s'", it.first.c_str());
+            failedCount++;
+        }
+    }
+
+    /* Remove outputs which are no longer produced, either because the source
+     * asset was removed or because its outputs have changed. */
+    std::set<std::string> outputs;
+    for (const auto& it : manifest)
+    {
+        outputs.insert(it.second.outputs.begin(), it.second.outputs.end());
+    }
+
+    for (const auto& it : oldManifest)
+    {
+        for (const std::string& output : it.second.outputs)
+        {
+            if (outputs.count(output) == 0)
+            {
+                std::error_code error;
+                std::filesystem::remove((outputPath / output).GetString(), error);
+            }
+        }
+    }
+
+    if (!SaveManifest(manifestPath, manifest))
+    {
+        return EXIT_FAILURE;
+    }
+
+    LogInfo("Cooked %zu assets, %zu unchanged, %zu failed", cookedCount, skippedCount, failedCount);
+
+    return (failedCount == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
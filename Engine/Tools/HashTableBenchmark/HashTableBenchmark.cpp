@@ -0,0 +1,201 @@
+/*
+ * Copyright (C) 2018-2020 Alex Smith
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+/**
+ * Microbenchmark comparing HashMap (open addressing) against std::unordered_map
+ * using our Hash class (which is what HashMap used to be an alias for). Key
+ * types are chosen to match the engine's main uses: size_t keys which are
+ * themselves hashes (GPUDevice caches), small integer IDs, and short strings
+ * (MetaClass property maps, search paths).
+ */
+
+#include "Core/HashTable.h"
+#include "Core/Platform.h"
+#include "Core/Time.h"
+
+#include <limits>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <stdio.h>
+#include <stdlib.h>
+
+/** Number of times to repeat each test, the minimum time is reported. */
+static constexpr uint32_t kIterations = 10;
+
+/** Number of lookups done in each lookup test. */
+static constexpr size_t kLookupCount = 1000000;
+
+/** Sink for results so that the compiler doesn't optimise the work away. */
+static volatile size_t gSink;
+
+struct Result
+{
+    double                      insert;
+    double                      lookupHit;
+    double                      lookupMiss;
+    double                      erase;
+};
+
+static double ToNanosecondsPerOp(const uint64_t time,
+                                 const size_t   count)
+{
+    return static_cast<double>(time) / static_cast<double>(count);
+}
+
+template <typename Map, typename Key>
+static Result RunTests(const std::vector<Key>& keys,
+                       const std::vector<Key>& missKeys)
+{
+    Result result;
+    result.insert     = std::numeric_limits<double>::max();
+    result.lookupHit  = std::numeric_limits<double>::max();
+    result.lookupMiss = std::numeric_limits<double>::max();
+    result.erase      = std::numeric_limits<double>::max();
+
+    for (uint32_t iteration = 0; iteration < kIterations; iteration++)
+    {
+        Map map;
+        size_t sum = 0;
+
+        uint64_t startTime = Platform::GetPerformanceCounter();
+
+        for (size_t i = 0; i < keys.size(); i++)
+        {
+            map.emplace(keys[i], i);
+        }
+
+        uint64_t time = Platform::GetPerformanceCounter() - startTime;
+        result.insert = std::min(result.insert, ToNanosecondsPerOp(time, keys.size()));
+
+        startTime = Platform::GetPerformanceCounter();
+
+        for (size_t i = 0; i < kLookupCount; i++)
+        {
+            auto it = map.find(keys[i % keys.size()]);
+            sum += it->second;
+        }
+
+        time = Platform::GetPerformanceCounter() - startTime;
+        result.lookupHit = std::min(result.lookupHit, ToNanosecondsPerOp(time, kLookupCount));
+
+        startTime = Platform::GetPerformanceCounter();
+
+        for (size_t i = 0; i < kLookupCount; i++)
+        {
+            auto it = map.find(missKeys[i % missKeys.size()]);
+            sum += (it != map.end());
+        }
+
+        time = Platform::GetPerformanceCounter() - startTime;
+        result.lookupMiss = std::min(result.lookupMiss, ToNanosecondsPerOp(time, kLookupCount));
+
+        startTime = Platform::GetPerformanceCounter();
+
+        for (const Key& key : keys)
+        {
+            sum += map.erase(key);
+        }
+
+        time = Platform::GetPerformanceCounter() - startTime;
+        result.erase = std::min(result.erase, ToNanosecondsPerOp(time, keys.size()));
+
+        gSink = sum;
+    }
+
+    return result;
+}
+
+template <typename Key>
+static void RunBenchmark(const char* const       name,
+                         const std::vector<Key>& keys,
+                         const std::vector<Key>& missKeys)
+{
+    const Result oldResult = RunTests<std::unordered_map<Key, size_t, Hash<Key>>>(keys, missKeys);
+    const Result newResult = RunTests<HashMap<Key, size_t>>(keys, missKeys);
+
+    auto Print = [] (const char* const test, const double oldTime, const double newTime)
+    {
+        printf("    %-12s %10.2f %10.2f %9.2fx\n", test, oldTime, newTime, oldTime / newTime);
+    };
+
+    printf("%s, %zu elements:\n", name, keys.size());
+    printf("    %-12s %10s %10s %10s\n", "(ns/op)", "unordered", "HashMap", "speedup");
+
+    Print("insert",      oldResult.insert,     newResult.insert);
+    Print("lookup hit",  oldResult.lookupHit,  newResult.lookupHit);
+    Print("lookup miss", oldResult.lookupMiss, newResult.lookupMiss);
+    Print("erase",       oldResult.erase,      newResult.erase);
+
+    printf("\n");
+}
+
+int main(const int          argc,
+         char* const* const argv)
+{
+    static const size_t kCounts[] = { 16, 256, 4096, 65536 };
+
+    std::mt19937_64 random(0);
+
+    for (const size_t count : kCounts)
+    {
+        /* Random 64-bit values, like the hashes used as cache keys. */
+        {
+            std::vector<size_t> keys(count);
+            std::vector<size_t> missKeys(count);
+
+            for (size_t i = 0; i < count; i++)
+            {
+                keys[i]     = random();
+                missKeys[i] = random();
+            }
+
+            RunBenchmark("size_t (random)", keys, missKeys);
+        }
+
+        /* Sequential integers, like serialised object IDs. These hash poorly
+         * without HashValue() mixing. */
+        {
+            std::vector<uint32_t> keys(count);
+            std::vector<uint32_t> missKeys(count);
+
+            for (size_t i = 0; i < count; i++)
+            {
+                keys[i]     = i;
+                missKeys[i] = count + i;
+            }
+
+            RunBenchmark("uint32_t (sequential)", keys, missKeys);
+        }
+
+        /* Short strings, like property names. */
+        {
+            std::vector<std::string> keys(count);
+            std::vector<std::string> missKeys(count);
+
+            for (size_t i = 0; i < count; i++)
+            {
+                keys[i]     = "property" + std::to_string(i);
+                missKeys[i] = "missing" + std::to_string(i);
+            }
+
+            RunBenchmark("std::string", keys, missKeys);
+        }
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -17,6 +17,7 @@
 #include "MTRenderTestGame.h"
 
 #include "Core/Filesystem.h"
+#include "Core/JobSystem.h"
 
 #include "Engine/Engine.h"
 #include "Engine/JSONSerialiser.h"
@@ -32,12 +33,10 @@
 #include "Render/RenderLayer.h"
 #include "Render/ShaderManager.h"
 
-#include <thread>
-
 static const uint32_t kNumColumns  = 100;
 static const uint32_t kNumRows     = 50;
 static const uint32_t kRepeat      = 10;
-static const uint32_t kThreadCount = 4;
+static const uint32_t kJobCount    = 4;
 
 /* Leave spacing between them. */
 static const uint32_t kTotalNumColumns = (kNumColumns * 2) + 1;
@@ -58,17 +57,15 @@ protected:
                                           RenderResourceHandle&      outNewTexture) override;
 
 private:
-    struct Worker
+    struct Job
     {
-        std::thread             thread;
-        std::atomic<bool>       ready       {false};
         uint32_t                rowOffset;
         uint32_t                rowCount;
         GPUGraphicsCommandList* cmdList;
     };
 
 private:
-    void                        WorkerThread(const uint32_t index);
+    void                        RecordJob(const uint32_t index);
 
 private:
     GPUShaderPtr                mVertexShader;
@@ -77,8 +74,7 @@ private:
     GPUBuffer*                  mVertexBuffer;
     GPUVertexInputStateRef      mVertexInputState;
 
-    Worker                      mWorkers[kThreadCount];
-    std::atomic<uint32_t>       mThreadsActive;
+    Job                         mJobs[kJobCount];
 };
 
 struct Vertex
@@ -142,83 +138,66 @@ void MTRenderTestLayer::Initialise()
     graphicsContext.UploadBuffer(mVertexBuffer, stagingBuffer, sizeof(kVertices));
 
     graphicsContext.ResourceBarrier(mVertexBuffer, kGPUResourceState_TransferWrite, kGPUResourceState_AllShaderRead);
-
-    for (uint32_t i = 0; i < kThreadCount; i++)
-    {
-        mWorkers[i].thread = std::thread(&MTRenderTestLayer::WorkerThread, this, i);
-    }
 }
 
-void MTRenderTestLayer::WorkerThread(const uint32_t index)
+void MTRenderTestLayer::RecordJob(const uint32_t index)
 {
-    Worker& worker = mWorkers[index];
-
-    while (true)
+    Job& job = mJobs[index];
+
+    GPUGraphicsCommandList* cmdList = job.cmdList;
+    cmdList->Begin();
+
+    GPUDepthStencilStateDesc depthDesc;
+    depthDesc.depthTestEnable  = true;
+    depthDesc.depthWriteEnable = true;
+    depthDesc.depthCompareOp   = kGPUCompareOp_Less;
+
+    // TODO: Change to pre-created, measure perf.
+    GPUPipelineDesc pipelineDesc;
+    pipelineDesc.shaders[kGPUShaderStage_Vertex] = mVertexShader;
+    pipelineDesc.shaders[kGPUShaderStage_Pixel]  = mPixelShader;
+    pipelineDesc.argumentSetLayouts[0]           = mArgumentLayout;
+    pipelineDesc.blendState                      = GPUBlendState::GetDefault();
+    pipelineDesc.depthStencilState               = GPUDepthStencilState::Get(depthDesc);
+    pipelineDesc.rasterizerState                 = GPURasterizerState::GetDefault();
+    pipelineDesc.renderTargetState               = cmdList->GetRenderTargetState();
+    pipelineDesc.vertexInputState                = mVertexInputState;
+    pipelineDesc.topology                        = kGPUPrimitiveTopology_TriangleList;
+
+    cmdList->SetPipeline(pipelineDesc);
+    cmdList->SetVertexBuffer(0, mVertexBuffer);
+
+    const GPUTexture* texture = GetLayerOutput()->GetTexture();
+    const float textureWidth  = static_cast<float>(texture->GetWidth());
+    const float textureHeight = static_cast<float>(texture->GetHeight());
+    const float cellWidth     = 2.0f * ((textureWidth / static_cast<float>(kTotalNumColumns)) / textureWidth);
+    const float cellHeight    = 2.0f * ((textureHeight / static_cast<float>(kTotalNumRows)) / textureHeight);
+
+    Transform transform;
+    transform.SetScale(glm::vec3(cellWidth / 2.0f, cellHeight / 2.0f, 1.0f));
+
+    for (uint32_t y = job.rowOffset; y < job.rowOffset + job.rowCount; y++)
     {
-        while (!worker.ready.load(std::memory_order_acquire))
-        {
-            std::this_thread::yield();
-        }
+        if (!(y & 1)) continue;
 
-        worker.ready.store(false, std::memory_order_release);
-
-        GPUGraphicsCommandList* cmdList = worker.cmdList;
-        cmdList->Begin();
-
-        GPUDepthStencilStateDesc depthDesc;
-        depthDesc.depthTestEnable  = true;
-        depthDesc.depthWriteEnable = true;
-        depthDesc.depthCompareOp   = kGPUCompareOp_Less;
-
-        // TODO: Change to pre-created, measure perf.
-        GPUPipelineDesc pipelineDesc;
-        pipelineDesc.shaders[kGPUShaderStage_Vertex] = mVertexShader;
-        pipelineDesc.shaders[kGPUShaderStage_Pixel]  = mPixelShader;
-        pipelineDesc.argumentSetLayouts[0]           = mArgumentLayout;
-        pipelineDesc.blendState                      = GPUBlendState::GetDefault();
-        pipelineDesc.depthStencilState               = GPUDepthStencilState::Get(depthDesc);
-        pipelineDesc.rasterizerState                 = GPURasterizerState::GetDefault();
-        pipelineDesc.renderTargetState               = cmdList->GetRenderTargetState();
-        pipelineDesc.vertexInputState                = mVertexInputState;
-        pipelineDesc.topology                        = kGPUPrimitiveTopology_TriangleList;
-
-        cmdList->SetPipeline(pipelineDesc);
-        cmdList->SetVertexBuffer(0, mVertexBuffer);
-
-        const GPUTexture* texture = GetLayerOutput()->GetTexture();
-        const float textureWidth  = static_cast<float>(texture->GetWidth());
-        const float textureHeight = static_cast<float>(texture->GetHeight());
-        const float cellWidth     = 2.0f * ((textureWidth / static_cast<float>(kTotalNumColumns)) / textureWidth);
-        const float cellHeight    = 2.0f * ((textureHeight / static_cast<float>(kTotalNumRows)) / textureHeight);
-
-        Transform transform;
-        transform.SetScale(glm::vec3(cellWidth / 2.0f, cellHeight / 2.0f, 1.0f));
-
-        for (uint32_t y = worker.rowOffset; y < worker.rowOffset + worker.rowCount; y++)
+        for (uint32_t x = 0; x < kTotalNumColumns; x++)
         {
-            if (!(y & 1)) continue;
+            if (!(x & 1)) continue;
 
-            for (uint32_t x = 0; x < kTotalNumColumns; x++)
-            {
-                if (!(x & 1)) continue;
+            transform.SetPosition(glm::vec3((cellWidth * (0.5f + x)) - 1.0f,
+                                            (cellHeight * (0.5f + y)) - 1.0f,
+                                            0.0f));
 
-                transform.SetPosition(glm::vec3((cellWidth * (0.5f + x)) - 1.0f,
-                                                (cellHeight * (0.5f + y)) - 1.0f,
-                                                0.0f));
+            cmdList->WriteConstants(0, 0, &transform.GetMatrix(), sizeof(transform.GetMatrix()));
 
-                cmdList->WriteConstants(0, 0, &transform.GetMatrix(), sizeof(transform.GetMatrix()));
-
-                for (uint32_t i = 0; i < kRepeat; i++)
-                {
-                    cmdList->Draw(3);
-                }
+            for (uint32_t i = 0; i < kRepeat; i++)
+            {
+                cmdList->Draw(3);
             }
         }
-
-        cmdList->End();
-
-        mThreadsActive.fetch_sub(1, std::memory_order_release);
     }
+
+    cmdList->End();
 }
 
 void MTRenderTestLayer::AddPasses(RenderGraph&               graph,
@@ -242,32 +221,29 @@ void MTRenderTestLayer::AddPasses(RenderGraph&               graph,
                              const RenderGraphPass&  pass,
                              GPUGraphicsCommandList& cmdList)
     {
-        const uint32_t numRowsRounded = RoundUp(kTotalNumRows, kThreadCount);
-        const uint32_t rowsPerThread  = numRowsRounded / kThreadCount;
+        const uint32_t numRowsRounded = RoundUp(kTotalNumRows, kJobCount);
+        const uint32_t rowsPerJob     = numRowsRounded / kJobCount;
 
-        GPUCommandList* children[kThreadCount];
+        GPUCommandList* children[kJobCount];
 
-        mThreadsActive.store(kThreadCount);
+        JobCounter counter;
 
-        for (uint32_t i = 0; i < kThreadCount; i++)
+        for (uint32_t i = 0; i < kJobCount; i++)
         {
-            Worker& worker = mWorkers[i];
+            Job& job = mJobs[i];
 
-            worker.rowOffset = i * rowsPerThread;
-            worker.rowCount  = std::min(worker.rowOffset + rowsPerThread, kTotalNumRows) - worker.rowOffset;
-            worker.cmdList   = cmdList.CreateChild();
+            job.rowOffset = i * rowsPerJob;
+            job.rowCount  = std::min(job.rowOffset + rowsPerJob, kTotalNumRows) - job.rowOffset;
+            job.cmdList   = cmdList.CreateChild();
 
-            children[i] = worker.cmdList;
+            children[i] = job.cmdList;
 
-            worker.ready.store(true, std::memory_order_release);
+            JobSystem::Get().Run([this, i] { RecordJob(i); }, &counter);
         }
 
-        while (mThreadsActive.load(std::memory_order_acquire) > 0)
-        {
-            std::this_thread::yield();
-        }
+        JobSystem::Get().Wait(counter);
 
-        cmdList.SubmitChildren(children, kThreadCount);
+        cmdList.SubmitChildren(children, kJobCount);
     });
 }
 
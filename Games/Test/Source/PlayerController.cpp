@@ -25,6 +25,7 @@ PlayerController::PlayerController() :
     mDirection      (0.0f),
     mIsRotating     (false)
 {
+    SetTickGroup(kTickGroup_PostPhysics);
 }
 
 PlayerController::~PlayerController()